@@ -0,0 +1,85 @@
+#include "../src/engine/utils/transform/transform.hpp"
+#include "../src/engine/utils/transform/transform_batch.hpp"
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace nugiEngine;
+
+// Compare the batched transform kernel with the per component getters used before.
+// Usage: transform_benchmark.out [transform count] [iteration count]
+int main(int argc, char **argv) {
+  size_t transformCount = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 100000;
+  int iterationCount = argc > 2 ? std::atoi(argv[2]) : 10;
+
+  std::mt19937 random{42};
+  std::uniform_real_distribution<float> position{-1000.0f, 1000.0f};
+  std::uniform_real_distribution<float> scale{0.1f, 10.0f};
+  std::uniform_real_distribution<float> angle{-glm::pi<float>() * 2.0f, glm::pi<float>() * 2.0f};
+
+  std::vector<TransformComponent> components(transformCount);
+  for (auto &&component : components) {
+    component.translation = glm::vec3{ position(random), position(random), position(random) };
+    component.scale = glm::vec3{ scale(random), scale(random), scale(random) };
+    component.rotation = glm::vec3{ angle(random), angle(random), angle(random) };
+    component.objectMinimum = glm::vec3{ position(random), position(random), position(random) };
+    component.objectMaximum = component.objectMinimum + glm::vec3{ scale(random), scale(random), scale(random) };
+  }
+
+  std::vector<Transformation> reference(transformCount), batched(transformCount);
+  double referenceTime = 1e30, batchedTime = 1e30, soaTime = 1e30;
+
+  for (int iteration = 0; iteration < iterationCount; iteration++) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    for (size_t i = 0; i < transformCount; i++) {
+      reference[i] = Transformation::fromMatrix(components[i].getPointMatrix(), components[i].getPointInverseMatrix());
+    }
+
+    auto middle = std::chrono::high_resolution_clock::now();
+    auto batch = createTransformBatch(components);
+
+    auto kernelStart = std::chrono::high_resolution_clock::now();
+    evaluateTransforms(batch, batched);
+    auto end = std::chrono::high_resolution_clock::now();
+
+    referenceTime = std::min(referenceTime, std::chrono::duration<double, std::milli>(middle - start).count());
+    soaTime = std::min(soaTime, std::chrono::duration<double, std::milli>(kernelStart - middle).count());
+    batchedTime = std::min(batchedTime, std::chrono::duration<double, std::milli>(end - kernelStart).count());
+  }
+
+  // Relative to the largest element of the matrix, inverses of small scales get big absolute values
+  float maxError = 0.0f;
+  for (size_t i = 0; i < transformCount; i++) {
+    const glm::mat3x4 *referenceMatrices = &reference[i].pointMatrix;
+    const glm::mat3x4 *batchedMatrices = &batched[i].pointMatrix;
+
+    for (int m = 0; m < 2; m++) {
+      float magnitude = 1.0f, difference = 0.0f;
+
+      for (int col = 0; col < 3; col++) {
+        for (int row = 0; row < 4; row++) {
+          magnitude = std::max(magnitude, std::abs(referenceMatrices[m][col][row]));
+          difference = std::max(difference, std::abs(referenceMatrices[m][col][row] - batchedMatrices[m][col][row]));
+        }
+      }
+
+      maxError = std::max(maxError, difference / magnitude);
+    }
+  }
+
+  std::cout << "transforms        : " << transformCount << '\n';
+  std::cout << "getters           : " << referenceTime << " ms (" << transformCount / referenceTime << " per ms)" << '\n';
+  std::cout << "SoA conversion    : " << soaTime << " ms" << '\n';
+  std::cout << "batched kernel    : " << batchedTime << " ms (" << transformCount / batchedTime << " per ms)" << '\n';
+  std::cout << "speedup           : " << referenceTime / batchedTime << "x" << '\n';
+  std::cout << "max relative error: " << maxError << '\n';
+
+  return maxError < 1e-3f ? 0 : 1;
+}
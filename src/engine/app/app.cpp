@@ -13,33 +13,63 @@
 #include <iostream>
 #include <cstdlib>
 
+#include <mutex>
 #include <thread>
+#include <algorithm>
 
 namespace nugiEngine {
 	EngineApp::EngineApp() {
 		this->renderer = std::make_unique<EngineHybridRenderer>(this->window, this->device);
+		this->parallelRecorder = std::make_unique<EngineParallelRecorder>(this->renderer->getCommandAllocator());
+		this->assetPipeline = std::make_unique<EngineAssetPipeline>(this->device);
+		this->setMemoryBudgets();
+
+		// Assets stream in from the worker pool, the first frames are rendered without them
+		this->sceneAsset = this->assetPipeline->load(std::make_shared<EngineSceneAsset>(this->device, &EngineApp::loadObjects));
+		this->colorTextureAssets.emplace_back(this->assetPipeline->load(std::make_shared<EngineTextureAsset>(this->device, "textures/viking_room.png", 
+			VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_REPEAT, VK_TRUE, VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK, VK_COMPARE_OP_NEVER, 
+			VK_SAMPLER_MIPMAP_MODE_LINEAR)));
 
-		this->loadObjects();
 		this->recreateSubRendererAndSubsystem();
+
+		// Storage buffers of the scene can be moved by the defragmenter, their descriptors follow per frame
+		this->device.getDefragmenter().addMoveListener([this](uint32_t frameIndex) {
+			if (this->forwardPassDescSet == nullptr) {
+				return;
+			}
+
+			VkDescriptorBufferInfo forwardPassbuffersInfo[2] {
+				this->transformationModel->getTransformationInfo(),
+				this->materialModel->getMaterialInfo()
+			};
+
+			this->forwardPassDescSet->overwrite(frameIndex, this->rasterUniform->getBufferInfo(), forwardPassbuffersInfo);
+		});
 	}
 
 	EngineApp::~EngineApp() {}
 
 	void EngineApp::renderLoop() {
 		while (this->isRendering) {
+			this->assetPipeline->processUploads();
+			this->publishAssets();
+
 			if (this->renderer->acquireFrame()) {
 				uint32_t frameIndex = this->renderer->getFrameIndex();
 				uint32_t imageIndex = this->renderer->getImageIndex();
 
-				auto descSets = std::make_shared<std::vector<VkDescriptorSet>>();
-				descSets->emplace_back(this->forwardPassDescSet->getDescriptorSets(frameIndex));
-
 				this->rasterUniform->writeGlobalData(frameIndex, this->rasterUbo);
+
+				bool isSceneVisible = this->forwardPassRender != nullptr;
+				if (isSceneVisible) {
+					this->updateScene(std::chrono::duration<float, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - this->startTime).count());
+					this->meshletModels->cull(frameIndex, this->cameraFrustum, this->cameraPosition, this->cameraProjectionScale, this->transformationModel->getTransformations());
+				}
+
 				auto commandBuffer = this->renderer->beginCommand();
-				
-				this->swapChainSubRenderer->beginRenderPass(commandBuffer, imageIndex);
-				this->forwardPassRender->render(commandBuffer, this->forwardPassDescSet->getDescriptorSets(frameIndex), this->vertexModels);
-				this->swapChainSubRenderer->endRenderPass(commandBuffer);
+
+				this->renderGraph->setImportedImage(this->swapChainImageResource, this->renderer->getSwapChain()->getswapChainImages()[imageIndex]->getImage());
+				this->renderGraph->execute(commandBuffer);
 
 				this->renderer->endCommand(commandBuffer);
 				this->renderer->submitRenderCommand(commandBuffer);
@@ -51,7 +81,7 @@ namespace nugiEngine {
 					continue;
 				}				
 
-				if (frameIndex + 1 == EngineDevice::MAX_FRAMES_IN_FLIGHT) {
+				if (frameIndex + 1 == this->device.getFramesInFlight()) {
 					this->randomSeed++;
 				}				
 			}
@@ -86,10 +116,123 @@ namespace nugiEngine {
 		this->isRendering = false;
 		renderThread.join();
 
-		vkDeviceWaitIdle(this->device.getLogicalDevice());
+		{
+			// The transfer uploader keeps submitting from its own thread until the device stops it
+			std::lock_guard<std::mutex> lock{this->device.getScheduler().getQueueMutex()};
+			vkDeviceWaitIdle(this->device.getLogicalDevice());
+		}
+	}
+
+	void EngineApp::setMemoryBudgets() {
+		auto &memoryTracker = this->device.getMemoryTracker();
+		VkDeviceSize deviceLocalBudget = 0;
+
+		for (auto &&heap : memoryTracker.getReport().heaps) {
+			if (heap.isDeviceLocal) {
+				deviceLocalBudget = std::max(deviceLocalBudget, heap.budget);
+			}
+		}
+
+		// Textures stream in without limit, so they get at most half of the device local memory. Geometry and render targets
+		// are needed to draw anything at all and stay unlimited, VMA still keeps them within the heap budget.
+		memoryTracker.setBudget(MemoryCategory::Texture, deviceLocalBudget / 2);
+
+		memoryTracker.addEvictionHandler([this](MemoryCategory category, VkDeviceSize requiredSize) {
+			return this->evictTextures(category, requiredSize);
+		});
+	}
+
+	VkDeviceSize EngineApp::evictTextures(MemoryCategory category, VkDeviceSize requiredSize) {
+		// Textures are only created by the upload stage, which runs on the render thread like every other use of colorTextures
+		if (category != MemoryCategory::Texture) {
+			return 0;
+		}
+
+		// Oldest first. No descriptor binds them yet, so no frame in flight can still read them.
+		VkDeviceSize freedSize = 0;
+		size_t evictedCount = 0;
+
+		while (evictedCount < this->colorTextures.size() && freedSize < requiredSize) {
+			freedSize += this->colorTextures[evictedCount]->getTextureImage()->getMemorySize();
+			evictedCount++;
+		}
+
+		this->colorTextures.erase(this->colorTextures.begin(), this->colorTextures.begin() + evictedCount);
+		return freedSize;
+	}
+
+	void EngineApp::publishAssets() {
+		if (this->sceneAsset->hasFailed()) {
+			throw std::runtime_error(this->sceneAsset->getError());
+		}
+
+		if (this->forwardPassRender == nullptr && this->sceneAsset->isReady()) {
+			this->materialModel = this->sceneAsset->getMaterialModel();
+			this->transformationModel = this->sceneAsset->getTransformationModel();
+			this->vertexModels = this->sceneAsset->getVertexModel();
+			this->meshletModels = this->sceneAsset->getMeshletModel();
+			this->transformComponents = this->sceneAsset->getTransformComponents();
+			this->animation = this->sceneAsset->getAnimation();
+
+			// Updated on the render thread while the recorder threads idle, so it uses as many threads as they do
+			auto sceneNodes = this->sceneAsset->getSceneNodes();
+			this->sceneGraph = std::make_unique<SceneGraph>(*sceneNodes, this->parallelRecorder->getThreadCount());
+
+			this->transformNodes.assign(this->transformComponents->size(), noParentNode);
+			for (uint32_t i = 0; i < static_cast<uint32_t>(sceneNodes->size()); i++) {
+				if ((*sceneNodes)[i].transformIndex != noTransformIndex) {
+					this->transformNodes[(*sceneNodes)[i].transformIndex] = i;
+				}
+			}
+
+			this->recreateSceneSubsystem();
+		}
+
+		for (auto &&textureAsset : this->colorTextureAssets) {
+			if (textureAsset->hasFailed()) {
+				throw std::runtime_error(textureAsset->getError());
+			}
+
+			if (textureAsset->isReady() && textureAsset->getTexture() != nullptr) {
+				this->colorTextures.emplace_back(textureAsset->getTexture());
+			}
+		}
+
+		this->colorTextureAssets.erase(std::remove_if(this->colorTextureAssets.begin(), this->colorTextureAssets.end(), 
+			[](const std::shared_ptr<EngineTextureAsset> &textureAsset) { return textureAsset->isReady(); }), this->colorTextureAssets.end());
+	}
+
+	void EngineApp::updateScene(float time) {
+		if (this->animation != nullptr) {
+			auto animatedTransformIndices = evaluateAnimation(*this->animation, this->animationState, time, true, *this->transformComponents);
+
+			for (auto &&transformIndex : animatedTransformIndices) {
+				this->sceneGraph->setLocal(this->transformNodes[transformIndex], (*this->transformComponents)[transformIndex]);
+			}
+		}
+
+		// Written before the culling, which bounds the meshlets with the new transforms already
+		auto changedTransformIndices = this->sceneGraph->update(*this->transformationModel->getTransformations());
+		this->dirtyTransformIndices.insert(this->dirtyTransformIndices.end(), changedTransformIndices.begin(), changedTransformIndices.end());
+	}
+
+	std::shared_ptr<AnimationClip> EngineApp::createBlockAnimation(uint32_t transformIndex) {
+		// One turn around the vertical axis every 8 seconds, a key every quarter turn
+		std::vector<float> times;
+		std::vector<glm::vec4> rotations;
+
+		for (uint32_t i = 0; i <= 4; i++) {
+			times.emplace_back(2.0f * static_cast<float>(i));
+			rotations.emplace_back(eulerToQuaternion(glm::vec3(0.0f, glm::half_pi<float>() * static_cast<float>(i), 0.0f)));
+		}
+
+		auto animation = std::make_shared<AnimationClip>();
+		animation->addChannel(transformIndex, AnimationPath::Rotation, Interpolation::Linear, times, rotations);
+
+		return animation;
 	}
 
-	void EngineApp::loadObjects() {
+	SceneData EngineApp::loadObjects() {
 		auto materials = std::make_shared<std::vector<Material>>();
 		auto vertices = std::make_shared<std::vector<Vertex>>();
 		auto indices = std::make_shared<std::vector<uint32_t>>();
@@ -187,6 +330,40 @@ namespace nugiEngine {
 
 		// ----------------------------------------------------------------------------
 
+		// balok, animated around the center of its bounds
+		glm::vec3 blockMinimum{130.0f, 0.0f, 65.0f};
+		glm::vec3 blockMaximum{295.0f, 165.0f, 230.0f};
+
+		transforms->emplace_back(TransformComponent{ glm::vec3(0.0f), glm::vec3(1.0f), glm::vec3(0.0f), blockMinimum, blockMaximum });
+		transformIndex = static_cast<uint32_t>(transforms->size() - 1);
+
+		auto animation = createBlockAnimation(transformIndex);
+
+		std::vector<std::array<glm::vec3, 4>> blockFaces {
+			{ glm::vec3{blockMinimum.x, blockMaximum.y, blockMinimum.z}, glm::vec3{blockMaximum.x, blockMaximum.y, blockMinimum.z}, glm::vec3{blockMaximum.x, blockMaximum.y, blockMaximum.z}, glm::vec3{blockMinimum.x, blockMaximum.y, blockMaximum.z} },
+			{ glm::vec3{blockMinimum.x, blockMinimum.y, blockMinimum.z}, glm::vec3{blockMinimum.x, blockMaximum.y, blockMinimum.z}, glm::vec3{blockMaximum.x, blockMaximum.y, blockMinimum.z}, glm::vec3{blockMaximum.x, blockMinimum.y, blockMinimum.z} },
+			{ glm::vec3{blockMinimum.x, blockMinimum.y, blockMaximum.z}, glm::vec3{blockMinimum.x, blockMaximum.y, blockMaximum.z}, glm::vec3{blockMaximum.x, blockMaximum.y, blockMaximum.z}, glm::vec3{blockMaximum.x, blockMinimum.y, blockMaximum.z} },
+			{ glm::vec3{blockMinimum.x, blockMinimum.y, blockMinimum.z}, glm::vec3{blockMinimum.x, blockMaximum.y, blockMinimum.z}, glm::vec3{blockMinimum.x, blockMaximum.y, blockMaximum.z}, glm::vec3{blockMinimum.x, blockMinimum.y, blockMaximum.z} },
+			{ glm::vec3{blockMaximum.x, blockMinimum.y, blockMinimum.z}, glm::vec3{blockMaximum.x, blockMaximum.y, blockMinimum.z}, glm::vec3{blockMaximum.x, blockMaximum.y, blockMaximum.z}, glm::vec3{blockMaximum.x, blockMinimum.y, blockMaximum.z} }
+		};
+
+		for (auto &&blockFace : blockFaces) {
+			auto firstVertex = static_cast<uint32_t>(vertices->size());
+
+			for (auto &&position : blockFace) {
+				vertices->emplace_back(Vertex{ glm::vec4{position, 1.0f}, 0u, transformIndex });
+			}
+
+			indices->emplace_back(firstVertex);
+			indices->emplace_back(firstVertex + 1u);
+			indices->emplace_back(firstVertex + 2u);
+			indices->emplace_back(firstVertex + 2u);
+			indices->emplace_back(firstVertex + 3u);
+			indices->emplace_back(firstVertex);
+		}
+
+		// ----------------------------------------------------------------------------
+
 		materials->emplace_back(Material{ glm::vec3(0.73f, 0.73f, 0.73f), glm::vec3(0.0f), 0.0f, 0.1f, 0.5f, 0u, 0u });
 		materials->emplace_back(Material{ glm::vec3(0.12f, 0.45f, 0.15f), glm::vec3(0.0f), 0.0f, 0.1f, 0.5f, 0u, 0u });
 		materials->emplace_back(Material{ glm::vec3(0.65f, 0.05f, 0.05f), glm::vec3(0.0f), 0.0f, 0.1f, 0.5f, 0u, 0u });
@@ -194,13 +371,17 @@ namespace nugiEngine {
 
 		// ----------------------------------------------------------------------------
 
-		this->materialModel = std::make_unique<EngineMaterialModel>(this->device, materials);
-		this->transformationModel = std::make_unique<EngineTransformationModel>(this->device, transforms);
-		this->vertexModels = std::make_unique<EngineVertexModel>(this->device, vertices, indices);
+		// Every object hangs below the room, moving the room moves the whole box
+		auto nodes = std::make_shared<std::vector<SceneNode>>();
+		nodes->emplace_back(SceneNode{ noParentNode, noTransformIndex, TransformComponent{} });
 
-		this->colorTextures.emplace_back(std::make_unique<EngineTexture>(this->device, "textures/viking_room.png", VK_FILTER_LINEAR, 
-			VK_SAMPLER_ADDRESS_MODE_REPEAT, VK_TRUE, VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK, VK_COMPARE_OP_NEVER, 
-			VK_SAMPLER_MIPMAP_MODE_LINEAR));
+		for (uint32_t i = 0; i < static_cast<uint32_t>(transforms->size()); i++) {
+			nodes->emplace_back(SceneNode{ 0u, i, (*transforms)[i] });
+		}
+
+		// ----------------------------------------------------------------------------
+
+		return SceneData{ materials, transforms, vertices, indices, nodes, animation };
 	}
 
 	void EngineApp::updateCamera(uint32_t width, uint32_t height) {
@@ -241,6 +422,10 @@ namespace nugiEngine {
     projection[3][2] = -(far * near) / (far - near);
 
 		this->rasterUbo.viewProjection = projection * view;
+
+		this->cameraPosition = position;
+		this->cameraFrustum = extractFrustum(this->rasterUbo.viewProjection);
+		this->cameraProjectionScale = projection[1][1] * static_cast<float>(height) / 2.0f;
 	}
 
 	void EngineApp::recreateSubRendererAndSubsystem() {
@@ -250,16 +435,77 @@ namespace nugiEngine {
 		this->rasterUniform = std::make_unique<EngineRasterUniform>(this->device);
 		this->updateCamera(width, height);
 
-		this->swapChainSubRenderer = std::make_unique<EngineSwapChainSubRenderer>(this->device, this->renderer->getSwapChain()->getswapChainImages(), 
+		// The sub renderer declares its attachments in the graph, they are allocated once the graph knows their lifetimes
+		this->renderGraph = std::make_unique<EngineRenderGraph>();
+		this->swapChainSubRenderer = std::make_unique<EngineSwapChainSubRenderer>(this->device, *this->renderGraph, this->renderer->getSwapChain()->getswapChainImages(), 
 			this->renderer->getSwapChain()->getSwapChainImageFormat(), static_cast<int>(this->renderer->getSwapChain()->imageCount()), 
 			width, height);
 
+		this->buildRenderGraph();
+		this->swapChainSubRenderer->createRenderTargets(*this->renderGraph);
+
+		if (this->sceneAsset->isReady()) {
+			this->recreateSceneSubsystem();
+		}
+	}
+
+	void EngineApp::recreateSceneSubsystem() {
 		VkDescriptorBufferInfo forwardPassbuffersInfo[2] {
 			this->transformationModel->getTransformationInfo(),
 			this->materialModel->getMaterialInfo()
 		};
 
-		this->forwardPassDescSet = std::make_unique<EngineForwardPassDescSet>(this->device, this->renderer->getDescriptorPool(), this->rasterUniform->getBuffersInfo(), forwardPassbuffersInfo);
+		this->forwardPassDescSet = std::make_unique<EngineForwardPassDescSet>(this->device, this->renderer->getDescriptorPool(), this->rasterUniform->getBufferInfo(), forwardPassbuffersInfo);
 		this->forwardPassRender = std::make_unique<EngineForwardPassRenderSystem>(this->device, this->swapChainSubRenderer->getRenderPass(), this->forwardPassDescSet->getDescSetLayout());
 	}
+
+	void EngineApp::buildRenderGraph() {
+		// Its copies are recorded with barriers of their own, and only change memory the graph does not track
+		this->renderGraph->addPass("defragment", [this](std::shared_ptr<EngineCommandBuffer> commandBuffer) {
+			this->device.getDefragmenter().update(commandBuffer, this->renderer->getFrameIndex());
+		}).setSideEffect();
+
+		// Uploads the transforms changed this frame, the copy is fenced by barriers of its own against the shaders reading them
+		this->renderGraph->addPass("transform", [this](std::shared_ptr<EngineCommandBuffer> commandBuffer) {
+			if (this->transformationModel == nullptr) {
+				return;
+			}
+
+			this->transformationModel->update(commandBuffer, this->renderer->getFrameIndex(), this->dirtyTransformIndices);
+			this->dirtyTransformIndices.clear();
+		}).setSideEffect();
+
+		// Acquiring the image is synchronized by the render pass dependency on the semaphore wait, which is why there is no initial access
+		this->swapChainImageResource = this->renderGraph->importImage("swapChainImage", VK_NULL_HANDLE, VK_IMAGE_ASPECT_COLOR_BIT);
+
+		this->renderGraph->addPass("forward", [this](std::shared_ptr<EngineCommandBuffer> commandBuffer) {
+			uint32_t frameIndex = this->renderer->getFrameIndex();
+			uint32_t imageIndex = this->renderer->getImageIndex();
+
+			if (this->forwardPassRender == nullptr) {
+				this->swapChainSubRenderer->beginRenderPass(commandBuffer, imageIndex);
+				this->swapChainSubRenderer->endRenderPass(commandBuffer);
+
+				return;
+			}
+
+			// The draws are recorded into secondary command buffers across the recorder threads
+			this->swapChainSubRenderer->beginRenderPass(commandBuffer, imageIndex, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+			auto drawCommandBuffers = this->forwardPassRender->render(*this->parallelRecorder, this->swapChainSubRenderer->getInheritanceInfo(imageIndex), 
+				this->swapChainSubRenderer->getExtent(), this->forwardPassDescSet->getDescriptorSets(frameIndex), this->rasterUniform->getDynamicOffset(frameIndex), 
+				this->vertexModels, this->meshletModels, frameIndex);
+
+			commandBuffer->executeCommands(drawCommandBuffers);
+			this->swapChainSubRenderer->endRenderPass(commandBuffer);
+		})
+		.write(this->swapChainSubRenderer->getColorResource(), RenderGraphAccess{ VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT }, 
+			VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL)
+		.write(this->swapChainSubRenderer->getDepthResource(), RenderGraphAccess{ VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, 
+			VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT }, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)
+		.write(this->swapChainImageResource, RenderGraphAccess{ VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT }, 
+			VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+
+		this->renderGraph->compile();
+	}
 }
\ No newline at end of file
@@ -4,17 +4,28 @@
 #include "../../vulkan/device/device.hpp"
 #include "../../vulkan/texture/texture.hpp"
 #include "../../vulkan/buffer/buffer.hpp"
+#include "../../vulkan/memory/defragmenter.hpp"
+#include "../../vulkan/command/parallel_recorder.hpp"
+#include "../../vulkan/render_graph/render_graph.hpp"
 #include "../utils/camera/camera.hpp"
 #include "../data/model/material_model.hpp"
 #include "../data/model/transformation_model.hpp"
 #include "../data/model/vertex_model.hpp"
+#include "../data/model/meshlet_model.hpp"
 #include "../data/buffer/raster_uniform.hpp"
 #include "../data/descSet/forward_pass_desc_set.hpp"
 #include "../renderer/hybrid_renderer.hpp"
 #include "../renderer_sub/swapchain_sub_renderer.hpp"
 #include "../renderer_system/forward_pass_render_system.hpp"
 #include "../utils/load_model/load_model.hpp"
-
+#include "../utils/vertex_packing/vertex_packing.hpp"
+#include "../utils/scene_graph/scene_graph.hpp"
+#include "../utils/animation/animation.hpp"
+#include "../asset/asset_pipeline.hpp"
+#include "../asset/scene_asset.hpp"
+#include "../asset/texture_asset.hpp"
+
+#include <chrono>
 #include <memory>
 #include <vector>
 
@@ -37,32 +48,65 @@ namespace nugiEngine {
 			void renderLoop();
 
 		private:
-			void loadObjects();
+			static SceneData loadObjects();
+			void publishAssets();
+
+			void setMemoryBudgets();
+			VkDeviceSize evictTextures(MemoryCategory category, VkDeviceSize requiredSize);
 
+			void updateScene(float time);
+			static std::shared_ptr<AnimationClip> createBlockAnimation(uint32_t transformIndex);
 			void updateCamera(uint32_t width, uint32_t height);
 			void recreateSubRendererAndSubsystem();
+			void recreateSceneSubsystem();
+			void buildRenderGraph();
 
 			EngineWindow window{WIDTH, HEIGHT, APP_TITLE};
 			EngineDevice device{window};
 			
 			std::unique_ptr<EngineHybridRenderer> renderer{};
+			std::unique_ptr<EngineParallelRecorder> parallelRecorder{};
 
 			std::unique_ptr<EngineSwapChainSubRenderer> swapChainSubRenderer{};
 			std::unique_ptr<EngineForwardPassRenderSystem> forwardPassRender{};
 
+			std::unique_ptr<EngineRenderGraph> renderGraph{};
+			RenderGraphResource swapChainImageResource = 0;
+
 			std::unique_ptr<EngineRasterUniform> rasterUniform{};
 
-			std::unique_ptr<EngineMaterialModel> materialModel{};
-			std::unique_ptr<EngineTransformationModel> transformationModel{};
+			std::unique_ptr<EngineAssetPipeline> assetPipeline{};
+			std::shared_ptr<EngineSceneAsset> sceneAsset{};
+			std::vector<std::shared_ptr<EngineTextureAsset>> colorTextureAssets{};
+
+			std::shared_ptr<EngineMaterialModel> materialModel{};
+			std::shared_ptr<EngineTransformationModel> transformationModel{};
 			std::shared_ptr<EngineVertexModel> vertexModels{};
+			std::shared_ptr<EngineMeshletModel> meshletModels{};
+
+			// Local transforms, changed on the render thread. The scene graph turns them into the world transforms
+			// of the frame, the changed ones are uploaded by the transform pass.
+			std::shared_ptr<std::vector<TransformComponent>> transformComponents{};
+			std::unique_ptr<SceneGraph> sceneGraph{};
+			std::vector<uint32_t> transformNodes{};
+			std::vector<uint32_t> dirtyTransformIndices{};
+
+			std::shared_ptr<AnimationClip> animation{};
+			AnimationState animationState{};
 
 			std::unique_ptr<EngineForwardPassDescSet> forwardPassDescSet{};
 
-			std::vector<std::unique_ptr<EngineTexture>> colorTextures{};
+			std::vector<std::shared_ptr<EngineTexture>> colorTextures{};
 
 			uint32_t randomSeed = 0;
 			bool isRendering = true;
 
 			RasterUbo rasterUbo;
+
+			glm::vec3 cameraPosition{0.0f};
+			Frustum cameraFrustum{};
+			float cameraProjectionScale = 1.0f;
+
+			std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
 	};
 }
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "../../vulkan/upload/upload_batch.hpp"
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+namespace nugiEngine {
+	enum class AssetState {
+		Queued,
+		Loading,
+		Uploading,
+		Ready,
+		Failed
+	};
+
+	// Base of everything loaded by EngineAssetPipeline. parse, decode and preprocess run on worker threads
+	// and must only touch CPU data, upload runs on the thread calling EngineAssetPipeline::processUploads
+	// and records its GPU work into a batch of its own, which is discarded when upload throws.
+	// The asset itself is the completion handle: the renderer polls isReady before using its resources.
+	class EngineAsset {
+		public:
+			virtual ~EngineAsset() = default;
+
+			AssetState getState() const { return this->state.load(std::memory_order_acquire); }
+			bool isReady() const { return this->getState() == AssetState::Ready; }
+			bool hasFailed() const { return this->getState() == AssetState::Failed; }
+
+			// Only valid once hasFailed returns true
+			const std::string& getError() const { return this->error; }
+
+			virtual void parse() {}
+			virtual void decode() {}
+			virtual void preprocess() {}
+			virtual void upload(std::shared_ptr<EngineUploadBatch> uploadBatch) = 0;
+
+		private:
+			std::atomic<AssetState> state{AssetState::Queued};
+			std::string error;
+
+			void setState(AssetState state) { this->state.store(state, std::memory_order_release); }
+			void fail(const std::string &error) { this->error = error; this->setState(AssetState::Failed); }
+
+			friend class EngineAssetPipeline;
+	};
+} // namespace nugiEngine
@@ -0,0 +1,121 @@
+#include "asset_pipeline.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+
+namespace nugiEngine {
+	EngineAssetPipeline::EngineAssetPipeline(EngineDevice &device, uint32_t workerCount, size_t queueCapacity) 
+		: engineDevice{device}, parseQueue{SIZE_MAX}, decodeQueue{queueCapacity}, preprocessQueue{queueCapacity}, uploadQueue{queueCapacity}
+	{
+		// Parsing is mostly waiting on the disk, decode and preprocess are the CPU heavy stages
+		uint32_t stageWorkerCount = std::max(1u, workerCount / 2u);
+
+		this->workers.emplace_back(&EngineAssetPipeline::runStage, this, std::ref(this->parseQueue), std::ref(this->decodeQueue), 
+			[](EngineAsset &asset) { asset.parse(); });
+
+		for (uint32_t i = 0; i < stageWorkerCount; i++) {
+			this->workers.emplace_back(&EngineAssetPipeline::runStage, this, std::ref(this->decodeQueue), std::ref(this->preprocessQueue), 
+				[](EngineAsset &asset) { asset.decode(); });
+
+			this->workers.emplace_back(&EngineAssetPipeline::runStage, this, std::ref(this->preprocessQueue), std::ref(this->uploadQueue), 
+				[](EngineAsset &asset) { asset.preprocess(); });
+		}
+	}
+
+	EngineAssetPipeline::~EngineAssetPipeline() {
+		// Pending assets are dropped, they stay in Loading state
+		this->parseQueue.close();
+		this->decodeQueue.close();
+		this->preprocessQueue.close();
+		this->uploadQueue.close();
+
+		for (auto &&worker : this->workers) {
+			worker.join();
+		}
+
+		// The GPU may still write into resources of these assets
+		for (auto &&uploadSubmission : this->uploadSubmissions) {
+			uploadSubmission.uploadBatch->wait();
+		}
+	}
+
+	uint32_t EngineAssetPipeline::defaultWorkerCount() {
+		uint32_t hardwareCount = std::thread::hardware_concurrency();
+
+		// Keep one core for the render thread and one for the window thread
+		return hardwareCount > 2u ? hardwareCount - 2u : 1u;
+	}
+
+	void EngineAssetPipeline::runStage(BoundedQueue<std::shared_ptr<EngineAsset>> &input, BoundedQueue<std::shared_ptr<EngineAsset>> &output, 
+		std::function<void(EngineAsset&)> stage) 
+	{
+		std::shared_ptr<EngineAsset> asset;
+
+		while (input.pop(asset)) {
+			asset->setState(AssetState::Loading);
+
+			try {
+				stage(*asset);
+			} catch (const std::exception &e) {
+				asset->fail(e.what());
+				continue;
+			}
+
+			if (!output.push(asset)) {
+				return;
+			}
+		}
+	}
+
+	uint32_t EngineAssetPipeline::processUploads(uint32_t maxUploadCount) {
+		this->completeUploads();
+
+		uint32_t uploadCount = 0;
+		std::shared_ptr<EngineAsset> asset;
+
+		while (uploadCount < maxUploadCount && this->uploadQueue.tryPop(asset)) {
+			asset->setState(AssetState::Uploading);
+			uploadCount++;
+
+			// Buffer uploads stream through the transfer queue, rendering never waits for them. One batch per asset,
+			// so the work of an asset that throws partway can be dropped before it writes into the resources it freed.
+			UploadSubmission uploadSubmission{ std::make_shared<EngineUploadBatch>(this->engineDevice, true), { asset } };
+
+			try {
+				asset->upload(uploadSubmission.uploadBatch);
+			} catch (const std::exception &e) {
+				uploadSubmission.uploadBatch->discard();
+				asset->fail(e.what());
+
+				continue;
+			}
+
+			uploadSubmission.uploadBatch->submit();
+			this->uploadSubmissions.emplace_back(uploadSubmission);
+		}
+
+		return uploadCount;
+	}
+
+	void EngineAssetPipeline::completeUploads() {
+		for (auto &&uploadSubmission : this->uploadSubmissions) {
+			if (!uploadSubmission.uploadBatch->isComplete()) {
+				continue;
+			}
+
+			for (auto &&asset : uploadSubmission.assets) {
+				if (uploadSubmission.uploadBatch->hasFailed()) {
+					asset->fail(uploadSubmission.uploadBatch->getError());
+				} else {
+					asset->setState(AssetState::Ready);
+				}
+			}
+
+			uploadSubmission.assets.clear();
+		}
+
+		this->uploadSubmissions.erase(std::remove_if(this->uploadSubmissions.begin(), this->uploadSubmissions.end(), 
+			[](const UploadSubmission &uploadSubmission) { return uploadSubmission.assets.empty(); }), this->uploadSubmissions.end());
+	}
+} // namespace nugiEngine
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "asset.hpp"
+#include "../utils/bounded_queue/bounded_queue.hpp"
+#include "../../vulkan/device/device.hpp"
+#include "../../vulkan/upload/upload_batch.hpp"
+
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace nugiEngine {
+	class EngineAssetPipeline {
+		public:
+			EngineAssetPipeline(EngineDevice &device, uint32_t workerCount = defaultWorkerCount(), size_t queueCapacity = 8);
+			~EngineAssetPipeline();
+
+			EngineAssetPipeline(const EngineAssetPipeline&) = delete;
+			EngineAssetPipeline& operator = (const EngineAssetPipeline&) = delete;
+
+			// Never blocks, requests wait unbounded in front of the parse stage. Only the queues between stages are bounded,
+			// otherwise the render thread could block here while the upload queue waits for it. The returned asset is the completion handle.
+			template <typename T>
+			std::shared_ptr<T> load(std::shared_ptr<T> asset) {
+				this->parseQueue.push(asset);
+				return asset;
+			}
+
+			// Run the upload stage of at most maxUploadCount assets, each recorded into an upload batch of its own.
+			// Assets turn Ready once a later call sees their batch finished. Must be called from the thread that owns
+			// the command pool and queues (the render thread), never blocks on the worker stages. It only waits for the GPU
+			// when an asset that threw had already submitted part of its upload.
+			uint32_t processUploads(uint32_t maxUploadCount = 8);
+
+			static uint32_t defaultWorkerCount();
+
+		private:
+			struct UploadSubmission {
+				std::shared_ptr<EngineUploadBatch> uploadBatch;
+				std::vector<std::shared_ptr<EngineAsset>> assets;
+			};
+
+			EngineDevice &engineDevice;
+
+			BoundedQueue<std::shared_ptr<EngineAsset>> parseQueue;
+			BoundedQueue<std::shared_ptr<EngineAsset>> decodeQueue;
+			BoundedQueue<std::shared_ptr<EngineAsset>> preprocessQueue;
+			BoundedQueue<std::shared_ptr<EngineAsset>> uploadQueue;
+
+			std::vector<std::thread> workers;
+			std::vector<UploadSubmission> uploadSubmissions;
+
+			void completeUploads();
+
+			void runStage(BoundedQueue<std::shared_ptr<EngineAsset>> &input, BoundedQueue<std::shared_ptr<EngineAsset>> &output, 
+				std::function<void(EngineAsset&)> stage);
+	};
+} // namespace nugiEngine
@@ -0,0 +1,40 @@
+#include "scene_asset.hpp"
+
+namespace nugiEngine {
+	EngineSceneAsset::EngineSceneAsset(EngineDevice &device, std::function<SceneData()> parser) : engineDevice{device}, parser{parser} {}
+
+	void EngineSceneAsset::parse() {
+		this->sceneData = this->parser();
+
+		if (this->sceneData.nodes == nullptr) {
+			this->sceneData.nodes = std::make_shared<std::vector<SceneNode>>();
+
+			for (uint32_t i = 0; i < static_cast<uint32_t>(this->sceneData.transforms->size()); i++) {
+				this->sceneData.nodes->emplace_back(SceneNode{ noParentNode, i, (*this->sceneData.transforms)[i] });
+			}
+		}
+	}
+
+	void EngineSceneAsset::preprocess() {
+		this->meshletData = createLodMeshlets(this->sceneData.vertices, this->sceneData.indices);
+
+		// Normals come from the full resolution triangles only, the coarser levels would weight them twice
+		this->packedModel = packVertices(*this->sceneData.vertices, *this->sceneData.indices, *this->meshletData.meshlets);
+		this->meshletIndices = splitIndexWidth(*this->meshletData.indices, *this->meshletData.meshlets);
+	}
+
+	void EngineSceneAsset::upload(std::shared_ptr<EngineUploadBatch> uploadBatch) {
+		this->materialModel = std::make_shared<EngineMaterialModel>(this->engineDevice, this->sceneData.materials, uploadBatch);
+		this->transformationModel = std::make_shared<EngineTransformationModel>(this->engineDevice, this->sceneData.transforms, uploadBatch);
+		this->vertexModel = std::make_shared<EngineVertexModel>(this->engineDevice, this->packedModel.vertices, this->packedModel.drawDatas, this->meshletIndices, uploadBatch);
+		this->meshletModel = std::make_shared<EngineMeshletModel>(this->engineDevice, this->meshletData.meshlets, this->meshletData.lodGroups);
+		this->transformComponents = this->sceneData.transforms;
+		this->sceneNodes = this->sceneData.nodes;
+		this->animation = this->sceneData.animation;
+
+		// The batch copied everything into staging memory, the CPU copies are not needed anymore except for the transforms
+		this->sceneData = SceneData{};
+		this->packedModel = PackedModel{};
+		this->meshletIndices = MeshletIndices{};
+	}
+} // namespace nugiEngine
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "asset.hpp"
+#include "../../vulkan/device/device.hpp"
+#include "../general_struct.hpp"
+#include "../utils/transform/transform.hpp"
+#include "../utils/meshlet/meshlet.hpp"
+#include "../utils/scene_graph/scene_graph.hpp"
+#include "../utils/animation/animation.hpp"
+#include "../utils/vertex_packing/vertex_packing.hpp"
+#include "../data/model/material_model.hpp"
+#include "../data/model/transformation_model.hpp"
+#include "../data/model/vertex_model.hpp"
+#include "../data/model/meshlet_model.hpp"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace nugiEngine {
+	struct SceneData {
+		std::shared_ptr<std::vector<Material>> materials;
+		std::shared_ptr<std::vector<TransformComponent>> transforms;
+		std::shared_ptr<std::vector<Vertex>> vertices;
+		std::shared_ptr<std::vector<uint32_t>> indices;
+
+		// Hierarchy of the transforms, without it every transform is a root node of its own
+		std::shared_ptr<std::vector<SceneNode>> nodes;
+
+		// Optional, its channels target the local transforms
+		std::shared_ptr<AnimationClip> animation;
+	};
+
+	// Geometry, materials and transforms of a scene. The parser produces the raw scene on a worker thread,
+	// preprocess builds the LOD chains, their meshlets and the packed vertex layout, upload creates the GPU models.
+	class EngineSceneAsset : public EngineAsset {
+		public:
+			EngineSceneAsset(EngineDevice &device, std::function<SceneData()> parser);
+
+			std::shared_ptr<EngineMaterialModel> getMaterialModel() const { return this->materialModel; }
+			std::shared_ptr<EngineTransformationModel> getTransformationModel() const { return this->transformationModel; }
+			std::shared_ptr<EngineVertexModel> getVertexModel() const { return this->vertexModel; }
+			std::shared_ptr<EngineMeshletModel> getMeshletModel() const { return this->meshletModel; }
+
+			// Kept after the upload, the transforms are changed at runtime and evaluated again from these
+			std::shared_ptr<std::vector<TransformComponent>> getTransformComponents() const { return this->transformComponents; }
+			std::shared_ptr<std::vector<SceneNode>> getSceneNodes() const { return this->sceneNodes; }
+			std::shared_ptr<AnimationClip> getAnimation() const { return this->animation; }
+
+			void parse() override;
+			void preprocess() override;
+			void upload(std::shared_ptr<EngineUploadBatch> uploadBatch) override;
+
+		private:
+			EngineDevice &engineDevice;
+			std::function<SceneData()> parser;
+
+			SceneData sceneData;
+			MeshletData meshletData;
+			PackedModel packedModel;
+			MeshletIndices meshletIndices;
+
+			std::shared_ptr<EngineMaterialModel> materialModel;
+			std::shared_ptr<EngineTransformationModel> transformationModel;
+			std::shared_ptr<EngineVertexModel> vertexModel;
+			std::shared_ptr<EngineMeshletModel> meshletModel;
+			std::shared_ptr<std::vector<TransformComponent>> transformComponents;
+			std::shared_ptr<std::vector<SceneNode>> sceneNodes;
+			std::shared_ptr<AnimationClip> animation;
+	};
+} // namespace nugiEngine
@@ -0,0 +1,36 @@
+#include "texture_asset.hpp"
+
+#include <stdexcept>
+
+namespace nugiEngine {
+	EngineTextureAsset::EngineTextureAsset(EngineDevice &device, const std::string &textureFileName, VkFilter filterMode, VkSamplerAddressMode addressMode, 
+		VkBool32 anistropyEnable, VkBorderColor borderColor, VkCompareOp compareOp, VkSamplerMipmapMode mipmapMode) 
+		: engineDevice{device}, textureFileName{textureFileName}, filterMode{filterMode}, addressMode{addressMode}, anistropyEnable{anistropyEnable}, 
+			borderColor{borderColor}, compareOp{compareOp}, mipmapMode{mipmapMode}
+	{
+
+	}
+
+	EngineTextureAsset::~EngineTextureAsset() {
+		if (this->pixels != nullptr) {
+			stbi_image_free(this->pixels);
+		}
+	}
+
+	void EngineTextureAsset::decode() {
+		int channels;
+		this->pixels = stbi_load(this->textureFileName.c_str(), &this->width, &this->height, &channels, STBI_rgb_alpha);
+
+		if (!this->pixels) {
+			throw std::runtime_error("failed to load texture image!");
+		}
+	}
+
+	void EngineTextureAsset::upload(std::shared_ptr<EngineUploadBatch> uploadBatch) {
+		this->texture = std::make_shared<EngineTexture>(this->engineDevice, this->pixels, static_cast<uint32_t>(this->width), static_cast<uint32_t>(this->height), 
+			this->filterMode, this->addressMode, this->anistropyEnable, this->borderColor, this->compareOp, this->mipmapMode, uploadBatch);
+
+		stbi_image_free(this->pixels);
+		this->pixels = nullptr;
+	}
+} // namespace nugiEngine
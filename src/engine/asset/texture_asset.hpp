@@ -0,0 +1,39 @@
+#pragma once
+
+#include "asset.hpp"
+#include "../../vulkan/device/device.hpp"
+#include "../../vulkan/texture/texture.hpp"
+
+#include <memory>
+#include <string>
+
+namespace nugiEngine {
+	// Image file decoded on a worker thread, the texture is created from the decoded pixels on upload.
+	class EngineTextureAsset : public EngineAsset {
+		public:
+			EngineTextureAsset(EngineDevice &device, const std::string &textureFileName, VkFilter filterMode, VkSamplerAddressMode addressMode, 
+				VkBool32 anistropyEnable, VkBorderColor borderColor, VkCompareOp compareOp, VkSamplerMipmapMode mipmapMode);
+			~EngineTextureAsset();
+
+			std::shared_ptr<EngineTexture> getTexture() const { return this->texture; }
+
+			void decode() override;
+			void upload(std::shared_ptr<EngineUploadBatch> uploadBatch) override;
+
+		private:
+			EngineDevice &engineDevice;
+			std::string textureFileName;
+
+			VkFilter filterMode;
+			VkSamplerAddressMode addressMode;
+			VkBool32 anistropyEnable;
+			VkBorderColor borderColor;
+			VkCompareOp compareOp;
+			VkSamplerMipmapMode mipmapMode;
+
+			stbi_uc* pixels = nullptr;
+			int width = 0, height = 0;
+
+			std::shared_ptr<EngineTexture> texture;
+	};
+} // namespace nugiEngine
@@ -11,39 +11,14 @@
 
 namespace nugiEngine {
 	EngineRasterUniform::EngineRasterUniform(EngineDevice& device) : appDevice{device} {
-		this->createUniformBuffer();
+		this->dynamicOffsets.resize(device.getFramesInFlight(), 0);
 	}
 
-	std::vector<VkDescriptorBufferInfo> EngineRasterUniform::getBuffersInfo() const {
-		std::vector<VkDescriptorBufferInfo> buffersInfo{};
-		
-		for (int i = 0; i < this->uniformBuffers.size(); i++) {
-			buffersInfo.emplace_back(uniformBuffers[i]->descriptorInfo());
-		}
-
-		return buffersInfo;
-	}
-
-	void EngineRasterUniform::createUniformBuffer() {
-		this->uniformBuffers.clear();
-
-		for (uint32_t i = 0; i < EngineDevice::MAX_FRAMES_IN_FLIGHT; i++) {
-			auto uniformBuffer = std::make_shared<EngineBuffer>(
-				this->appDevice,
-				sizeof(RasterUbo),
-				1,
-				VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-				VMA_MEMORY_USAGE_AUTO_PREFER_HOST,
-				VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT
-			);
-
-			uniformBuffer->map();
-			this->uniformBuffers.emplace_back(uniformBuffer);
-		}
+	VkDescriptorBufferInfo EngineRasterUniform::getBufferInfo() const {
+		return this->appDevice.getUniformRing().descriptorInfo(sizeof(RasterUbo));
 	}
 
 	void EngineRasterUniform::writeGlobalData(uint32_t frameIndex, RasterUbo ubo) {
-		this->uniformBuffers[frameIndex]->writeToBuffer(&ubo);
-		this->uniformBuffers[frameIndex]->flush();
+		this->dynamicOffsets[frameIndex] = this->appDevice.getUniformRing().push(&ubo, sizeof(RasterUbo));
 	}
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "../../../vulkan/device/device.hpp"
 #include "../../../vulkan/pipeline/compute_pipeline.hpp"
 #include "../../../vulkan/buffer/buffer.hpp"
+#include "../../../vulkan/buffer/uniform_ring.hpp"
 #include "../../../vulkan/descriptor/descriptor.hpp"
 #include "../../general_struct.hpp"
 
@@ -15,14 +16,14 @@ namespace nugiEngine {
 		public:
 			EngineRasterUniform(EngineDevice& device);
 
-			std::vector<VkDescriptorBufferInfo> getBuffersInfo() const;
+			// For a UNIFORM_BUFFER_DYNAMIC binding, bound with getDynamicOffset of the frame
+			VkDescriptorBufferInfo getBufferInfo() const;
+			uint32_t getDynamicOffset(uint32_t frameIndex) const { return this->dynamicOffsets[frameIndex]; }
 
 			void writeGlobalData(uint32_t frameIndex, RasterUbo ubo);
 
 		private:
       EngineDevice& appDevice;
-			std::vector<std::shared_ptr<EngineBuffer>> uniformBuffers;
-
-			void createUniformBuffer();
+			std::vector<uint32_t> dynamicOffsets;
 	};
-}
\ No newline at end of file
+}
@@ -2,27 +2,36 @@
 
 namespace nugiEngine {
   EngineForwardPassDescSet::EngineForwardPassDescSet(EngineDevice& device, std::shared_ptr<EngineDescriptorPool> descriptorPool, 
-    std::vector<VkDescriptorBufferInfo> uniformBufferInfo, VkDescriptorBufferInfo buffersInfo[2]) 
+    VkDescriptorBufferInfo uniformBufferInfo, VkDescriptorBufferInfo buffersInfo[2]) 
 	{
+		this->descriptorPool = descriptorPool;
 		this->createDescriptor(device, descriptorPool, uniformBufferInfo, buffersInfo);
   }
 
+	void EngineForwardPassDescSet::overwrite(uint32_t frameIndex, VkDescriptorBufferInfo uniformBufferInfo, VkDescriptorBufferInfo buffersInfo[2]) {
+		EngineDescriptorWriter(*this->descSetLayout, *this->descriptorPool)
+			.writeBuffer(0, &uniformBufferInfo)
+			.writeBuffer(1, &buffersInfo[0])
+			.writeBuffer(2, &buffersInfo[1])
+			.overwrite(&this->descriptorSets[frameIndex]);
+	}
+
   void EngineForwardPassDescSet::createDescriptor(EngineDevice& device, std::shared_ptr<EngineDescriptorPool> descriptorPool, 
-    std::vector<VkDescriptorBufferInfo> uniformBufferInfo, VkDescriptorBufferInfo buffersInfo[2]) 
+    VkDescriptorBufferInfo uniformBufferInfo, VkDescriptorBufferInfo buffersInfo[2]) 
 	{
     this->descSetLayout = 
 			EngineDescriptorSetLayout::Builder(device)
-				.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT)
+				.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, VK_SHADER_STAGE_VERTEX_BIT)
 				.addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT)
 				.addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT)
 				.build();
 		
 		this->descriptorSets.clear();
-		for (int i = 0; i < EngineDevice::MAX_FRAMES_IN_FLIGHT; i++) {
+		for (uint32_t i = 0; i < device.getFramesInFlight(); i++) {
 			VkDescriptorSet descSet{};
 
 			EngineDescriptorWriter(*this->descSetLayout, *descriptorPool)
-				.writeBuffer(0, &uniformBufferInfo[i])
+				.writeBuffer(0, &uniformBufferInfo)
 				.writeBuffer(1, &buffersInfo[0])
 				.writeBuffer(2, &buffersInfo[1])
 				.build(&descSet);
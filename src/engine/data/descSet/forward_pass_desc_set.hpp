@@ -10,16 +10,20 @@ namespace nugiEngine {
 	class EngineForwardPassDescSet {
 		public:
 			EngineForwardPassDescSet(EngineDevice& device, std::shared_ptr<EngineDescriptorPool> descriptorPool, 
-        std::vector<VkDescriptorBufferInfo> uniformBufferInfo, VkDescriptorBufferInfo buffersInfo[2]);
+        VkDescriptorBufferInfo uniformBufferInfo, VkDescriptorBufferInfo buffersInfo[2]);
 
 			VkDescriptorSet getDescriptorSets(int frameIndex) { return this->descriptorSets[frameIndex]; }
+
+			// Rewrite the set of one frame after its buffers were moved, the frame must not be in flight
+			void overwrite(uint32_t frameIndex, VkDescriptorBufferInfo uniformBufferInfo, VkDescriptorBufferInfo buffersInfo[2]);
 			std::shared_ptr<EngineDescriptorSetLayout> getDescSetLayout() const { return this->descSetLayout; }
 
 		private:
       std::shared_ptr<EngineDescriptorSetLayout> descSetLayout;
+			std::shared_ptr<EngineDescriptorPool> descriptorPool;
 			std::vector<VkDescriptorSet> descriptorSets;
 
 			void createDescriptor(EngineDevice& device, std::shared_ptr<EngineDescriptorPool> descriptorPool, 
-        std::vector<VkDescriptorBufferInfo> uniformBufferInfo, VkDescriptorBufferInfo buffersInfo[2]);
+        VkDescriptorBufferInfo uniformBufferInfo, VkDescriptorBufferInfo buffersInfo[2]);
 	};
 }
\ No newline at end of file
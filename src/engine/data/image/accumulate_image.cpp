@@ -24,7 +24,7 @@ namespace nugiEngine {
 				1, VK_SAMPLE_COUNT_1_BIT, VK_FORMAT_R32G32B32A32_SFLOAT, 
 				VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_STORAGE_BIT, 
 				VMA_MEMORY_USAGE_AUTO, VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT, 
-				VK_IMAGE_ASPECT_COLOR_BIT
+				VK_IMAGE_ASPECT_COLOR_BIT, MemoryCategory::RenderTarget
 			);
 
 			this->accumulateImages.emplace_back(accumulateImage);
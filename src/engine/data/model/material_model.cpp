@@ -8,36 +8,29 @@
 #include <glm/gtx/hash.hpp>
 
 namespace nugiEngine {
-	EngineMaterialModel::EngineMaterialModel(EngineDevice &device, std::shared_ptr<std::vector<Material>> materials, std::shared_ptr<EngineCommandBuffer> commandBuffer) : engineDevice{device} {
-		this->createBuffers(materials, commandBuffer);
+	EngineMaterialModel::EngineMaterialModel(EngineDevice &device, std::shared_ptr<std::vector<Material>> materials, std::shared_ptr<EngineUploadBatch> uploadBatch) : engineDevice{device} {
+		this->createBuffers(materials, uploadBatch);
 	}
 
-	void EngineMaterialModel::createBuffers(std::shared_ptr<std::vector<Material>> materials, std::shared_ptr<EngineCommandBuffer> commandBuffer) {
+	void EngineMaterialModel::createBuffers(std::shared_ptr<std::vector<Material>> materials, std::shared_ptr<EngineUploadBatch> uploadBatch) {
+		bool isUploadBatchCreatedHere = false;
+
+		if (uploadBatch == nullptr) {
+			uploadBatch = std::make_shared<EngineUploadBatch>(this->engineDevice);
+			isUploadBatchCreatedHere = true;
+		}
+
 		auto materialCount = static_cast<uint32_t>(materials->size());
-		auto materialSize = static_cast<uint32_t>(sizeof(Transformation));
-
-		EngineBuffer materialStagingBuffer {
-			this->engineDevice,
-			static_cast<VkDeviceSize>(materialSize),
-			materialCount,
-			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VMA_MEMORY_USAGE_AUTO,
-			VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT
-		};
-
-		materialStagingBuffer.map();
-		materialStagingBuffer.writeToBuffer(materials->data());
-
-		this->materialBuffer = std::make_shared<EngineBuffer>(
-			this->engineDevice,
-			static_cast<VkDeviceSize>(materialSize),
-			materialCount,
-			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-			VMA_MEMORY_USAGE_AUTO,
-			VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT
-		);
-
-		this->materialBuffer->copyBuffer(materialStagingBuffer.getBuffer(), static_cast<VkDeviceSize>(materialSize * materialCount), commandBuffer);
+		auto materialSize = static_cast<uint32_t>(sizeof(Material));
+
+		VkDeviceSize bufferSize = static_cast<VkDeviceSize>(materialSize * materialCount);
+
+		this->materialBuffer = this->engineDevice.getBufferPool(BufferPoolUsage::Storage).allocate(bufferSize);
+		uploadBatch->uploadBuffer(this->materialBuffer->getBuffer(), materials->data(), bufferSize, this->materialBuffer->getOffset());
+
+		if (isUploadBatchCreatedHere) {
+			uploadBatch->wait();
+		}
 	} 
 } // namespace nugiEngine
 
@@ -2,7 +2,9 @@
 
 #include "../../../vulkan/device/device.hpp"
 #include "../../../vulkan/buffer/buffer.hpp"
+#include "../../../vulkan/buffer/buffer_pool.hpp"
 #include "../../../vulkan/command/command_buffer.hpp"
+#include "../../../vulkan/upload/upload_batch.hpp"
 #include "../../general_struct.hpp"
 
 #define GLM_FORCE_RADIANS
@@ -15,7 +17,7 @@
 namespace nugiEngine {
 	class EngineMaterialModel {
 		public:
-			EngineMaterialModel(EngineDevice &device, std::shared_ptr<std::vector<Material>> materials, std::shared_ptr<EngineCommandBuffer> commandBuffer = nullptr);
+			EngineMaterialModel(EngineDevice &device, std::shared_ptr<std::vector<Material>> materials, std::shared_ptr<EngineUploadBatch> uploadBatch = nullptr);
 
 			EngineMaterialModel(const EngineMaterialModel&) = delete;
 			EngineMaterialModel& operator = (const EngineMaterialModel&) = delete;
@@ -24,8 +26,8 @@ namespace nugiEngine {
 			
 		private:
 			EngineDevice &engineDevice;
-			std::shared_ptr<EngineBuffer> materialBuffer;
+			std::unique_ptr<EngineBufferSlice> materialBuffer;
 
-			void createBuffers(std::shared_ptr<std::vector<Material>> materials, std::shared_ptr<EngineCommandBuffer> commandBuffer = nullptr);
+			void createBuffers(std::shared_ptr<std::vector<Material>> materials, std::shared_ptr<EngineUploadBatch> uploadBatch);
 	};
 } // namespace nugiEngine
@@ -0,0 +1,104 @@
+#include "meshlet_model.hpp"
+
+namespace nugiEngine {
+	EngineMeshletModel::EngineMeshletModel(EngineDevice &device, std::shared_ptr<std::vector<Meshlet>> meshlets, std::shared_ptr<std::vector<MeshletLodGroup>> lodGroups, 
+		bool isConeCullingEnabled) : engineDevice{device}, meshlets{meshlets}, lodGroups{lodGroups}, isConeCullingEnabled{isConeCullingEnabled} 
+	{
+		this->createIndirectBuffers();
+	}
+
+	void EngineMeshletModel::createIndirectBuffers() {
+		this->indirectBuffers.clear();
+		this->drawCounts.clear();
+		this->drawCommands.clear();
+
+		// Worst case every meshlet ends up as its own draw, so size the buffer for all of them
+		auto commandCount = static_cast<uint32_t>(this->meshlets->size());
+
+		for (uint32_t i = 0; i < this->engineDevice.getFramesInFlight(); i++) {
+			auto indirectBuffer = std::make_shared<EngineBuffer>(
+				this->engineDevice,
+				static_cast<VkDeviceSize>(sizeof(VkDrawIndexedIndirectCommand)),
+				commandCount,
+				VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+				VMA_MEMORY_USAGE_AUTO_PREFER_HOST,
+				VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
+				1,
+				MemoryCategory::Geometry
+			);
+
+			indirectBuffer->map();
+
+			this->indirectBuffers.emplace_back(indirectBuffer);
+			this->drawCounts.emplace_back(0u);
+			this->drawCommands.emplace_back();
+		}
+	}
+
+	const std::vector<VkDrawIndexedIndirectCommand>& EngineMeshletModel::getCommands(uint32_t frameIndex, VkIndexType indexType) const {
+		return indexType == VK_INDEX_TYPE_UINT16 ? this->drawCommands[frameIndex].commands16 : this->drawCommands[frameIndex].commands32;
+	}
+
+	void EngineMeshletModel::cull(uint32_t frameIndex, const Frustum &frustum, glm::vec3 cameraPosition, float projectionScale, std::shared_ptr<std::vector<Transformation>> transformations) {
+		std::vector<uint32_t> lodLevels;
+		if (this->lodGroups != nullptr) {
+			lodLevels = selectMeshletLodLevels(*this->lodGroups, *transformations, cameraPosition, projectionScale);
+		}
+
+		auto &drawCommands = this->drawCommands[frameIndex];
+		drawCommands = cullMeshlets(*this->meshlets, *transformations, lodLevels, frustum, cameraPosition, this->isConeCullingEnabled);
+		this->drawCounts[frameIndex] = static_cast<uint32_t>(drawCommands.commands16.size() + drawCommands.commands32.size());
+
+		// 16 bit commands first, then the 32 bit ones right after them
+		VkDeviceSize commandSize = static_cast<VkDeviceSize>(sizeof(VkDrawIndexedIndirectCommand));
+		VkDeviceSize commands16Size = commandSize * drawCommands.commands16.size();
+		VkDeviceSize commands32Size = commandSize * drawCommands.commands32.size();
+
+		if (commands16Size > 0) {
+			this->indirectBuffers[frameIndex]->writeToBuffer(drawCommands.commands16.data(), commands16Size);
+		}
+
+		if (commands32Size > 0) {
+			this->indirectBuffers[frameIndex]->writeToBuffer(drawCommands.commands32.data(), commands32Size, commands16Size);
+		}
+
+		if (commands16Size + commands32Size > 0) {
+			this->indirectBuffers[frameIndex]->flush(commands16Size + commands32Size);
+		}
+	}
+
+	void EngineMeshletModel::draw(std::shared_ptr<EngineCommandBuffer> commandBuffer, uint32_t frameIndex, VkIndexType indexType) {
+		this->draw(commandBuffer, frameIndex, indexType, 0, this->getDrawCount(frameIndex, indexType));
+	}
+
+	void EngineMeshletModel::draw(std::shared_ptr<EngineCommandBuffer> commandBuffer, uint32_t frameIndex, VkIndexType indexType, uint32_t firstDraw, uint32_t drawCount) {
+		auto &commands = this->getCommands(frameIndex, indexType);
+		uint32_t stride = static_cast<uint32_t>(sizeof(VkDrawIndexedIndirectCommand));
+
+		if (drawCount == 0) {
+			return;
+		}
+
+		// firstInstance selects the DrawData, indirect draws may only use it with drawIndirectFirstInstance
+		if (!this->engineDevice.getEnabledFeatures().drawIndirectFirstInstance) {
+			for (uint32_t i = firstDraw; i < firstDraw + drawCount; i++) {
+				auto &command = commands[i];
+				vkCmdDrawIndexed(commandBuffer->getCommandBuffer(), command.indexCount, command.instanceCount, command.firstIndex, command.vertexOffset, command.firstInstance);
+			}
+
+			return;
+		}
+
+		uint32_t commandIndex = indexType == VK_INDEX_TYPE_UINT16 ? firstDraw : static_cast<uint32_t>(this->drawCommands[frameIndex].commands16.size()) + firstDraw;
+		VkDeviceSize offset = static_cast<VkDeviceSize>(commandIndex) * stride;
+
+		if (this->engineDevice.getEnabledFeatures().multiDrawIndirect) {
+			vkCmdDrawIndexedIndirect(commandBuffer->getCommandBuffer(), this->indirectBuffers[frameIndex]->getBuffer(), offset, drawCount, stride);
+			return;
+		}
+
+		for (uint32_t i = 0; i < drawCount; i++) {
+			vkCmdDrawIndexedIndirect(commandBuffer->getCommandBuffer(), this->indirectBuffers[frameIndex]->getBuffer(), offset + i * stride, 1, stride);
+		}
+	}
+} // namespace nugiEngine
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "../../../vulkan/device/device.hpp"
+#include "../../../vulkan/buffer/buffer.hpp"
+#include "../../../vulkan/command/command_buffer.hpp"
+#include "../../general_struct.hpp"
+#include "../../utils/meshlet/meshlet.hpp"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <memory>
+
+namespace nugiEngine {
+	class EngineMeshletModel {
+		public:
+			EngineMeshletModel(EngineDevice &device, std::shared_ptr<std::vector<Meshlet>> meshlets, std::shared_ptr<std::vector<MeshletLodGroup>> lodGroups = nullptr, 
+				bool isConeCullingEnabled = false);
+
+			EngineMeshletModel(const EngineMeshletModel&) = delete;
+			EngineMeshletModel& operator = (const EngineMeshletModel&) = delete;
+
+			uint32_t getMeshletCount() const { return static_cast<uint32_t>(this->meshlets->size()); }
+			uint32_t getDrawCount(uint32_t frameIndex) const { return this->drawCounts[frameIndex]; }
+			uint32_t getDrawCount(uint32_t frameIndex, VkIndexType indexType) const { return static_cast<uint32_t>(this->getCommands(frameIndex, indexType).size()); }
+
+			// projectionScale is projection[1][1] * viewport height / 2, it picks the LOD level of every mesh
+			void cull(uint32_t frameIndex, const Frustum &frustum, glm::vec3 cameraPosition, float projectionScale, std::shared_ptr<std::vector<Transformation>> transformations);
+			void draw(std::shared_ptr<EngineCommandBuffer> commandBuffer, uint32_t frameIndex, VkIndexType indexType);
+
+			// Only the draws [firstDraw, firstDraw + drawCount) of one index width, for recording a draw list in slices
+			void draw(std::shared_ptr<EngineCommandBuffer> commandBuffer, uint32_t frameIndex, VkIndexType indexType, uint32_t firstDraw, uint32_t drawCount);
+			
+		private:
+			EngineDevice &engineDevice;
+
+			std::shared_ptr<std::vector<Meshlet>> meshlets;
+			std::shared_ptr<std::vector<MeshletLodGroup>> lodGroups;
+			std::vector<std::shared_ptr<EngineBuffer>> indirectBuffers;
+			std::vector<uint32_t> drawCounts;
+			std::vector<MeshletDrawCommands> drawCommands;
+
+			bool isConeCullingEnabled = false;
+
+			void createIndirectBuffers();
+			const std::vector<VkDrawIndexedIndirectCommand>& getCommands(uint32_t frameIndex, VkIndexType indexType) const;
+	};
+} // namespace nugiEngine
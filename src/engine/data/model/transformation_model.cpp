@@ -1,5 +1,6 @@
 #include "transformation_model.hpp"
 
+#include <algorithm>
 #include <cstring>
 #include <iostream>
 #include <unordered_map>
@@ -8,55 +9,157 @@
 #include <glm/gtx/hash.hpp>
 
 namespace nugiEngine {
-	EngineTransformationModel::EngineTransformationModel(EngineDevice &device, std::shared_ptr<std::vector<Transformation>> transformations, std::shared_ptr<EngineCommandBuffer> commandBuffer) : engineDevice{device} {
-		this->createBuffers(transformations, commandBuffer);
+	EngineTransformationModel::EngineTransformationModel(EngineDevice &device, std::shared_ptr<std::vector<Transformation>> transformations, std::shared_ptr<EngineUploadBatch> uploadBatch) : engineDevice{device} {
+		this->createBuffers(transformations, uploadBatch);
 	}
 
-	EngineTransformationModel::EngineTransformationModel(EngineDevice& device, std::shared_ptr<std::vector<TransformComponent>> transformationComponents, std::shared_ptr<EngineCommandBuffer> commandBuffer) : engineDevice{device} {
-		this->createBuffers(this->convertToMatrix(transformationComponents), commandBuffer);
+	EngineTransformationModel::EngineTransformationModel(EngineDevice& device, std::shared_ptr<std::vector<TransformComponent>> transformationComponents, std::shared_ptr<EngineUploadBatch> uploadBatch) : engineDevice{device} {
+		this->createBuffers(this->convertToMatrix(transformationComponents), uploadBatch);
 	}
 
 	std::shared_ptr<std::vector<Transformation>> EngineTransformationModel::convertToMatrix(std::shared_ptr<std::vector<TransformComponent>> transformationComponents) {
 		auto transforms = std::make_shared<std::vector<Transformation>>();
-		for (uint32_t i = 0; i < transformationComponents->size(); i++) {
-			transforms->emplace_back(Transformation{ 
-				(*transformationComponents)[i].getPointMatrix(),
-				(*transformationComponents)[i].getDirMatrix(), 
-				(*transformationComponents)[i].getPointInverseMatrix(), 
-				(*transformationComponents)[i].getDirInverseMatrix(), 
-				(*transformationComponents)[i].getNormalMatrix() 
-			});
-		}
+		evaluateTransforms(createTransformBatch(*transformationComponents), *transforms);
 
 		return transforms;
 	}
 
-	void EngineTransformationModel::createBuffers(std::shared_ptr<std::vector<Transformation>> transformations, std::shared_ptr<EngineCommandBuffer> commandBuffer) {
+	void EngineTransformationModel::createBuffers(std::shared_ptr<std::vector<Transformation>> transformations, std::shared_ptr<EngineUploadBatch> uploadBatch) {
+		bool isUploadBatchCreatedHere = false;
+
+		if (uploadBatch == nullptr) {
+			uploadBatch = std::make_shared<EngineUploadBatch>(this->engineDevice);
+			isUploadBatchCreatedHere = true;
+		}
+
+		this->transformations = transformations;
+
 		auto transformsCount = static_cast<uint32_t>(transformations->size());
 		auto transformsSize = static_cast<uint32_t>(sizeof(Transformation));
 
-		EngineBuffer transformationStagingBuffer {
-			this->engineDevice,
-			static_cast<VkDeviceSize>(transformsSize),
-			transformsCount,
-			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VMA_MEMORY_USAGE_AUTO,
-			VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT
-		};
+		VkDeviceSize bufferSize = static_cast<VkDeviceSize>(transformsSize * transformsCount);
+
+		this->transformationBuffer = this->engineDevice.getBufferPool(BufferPoolUsage::Storage).allocate(bufferSize);
+		uploadBatch->uploadBuffer(this->transformationBuffer->getBuffer(), transformations->data(), bufferSize, this->transformationBuffer->getOffset());
 
-		transformationStagingBuffer.map();
-		transformationStagingBuffer.writeToBuffer(transformations->data());
+		if (isUploadBatchCreatedHere) {
+			uploadBatch->wait();
+		}
+	} 
 
-		this->transformationBuffer = std::make_shared<EngineBuffer>(
+	void EngineTransformationModel::createUpdateRing() {
+		this->updateRing = std::make_shared<EngineBuffer>(
 			this->engineDevice,
-			static_cast<VkDeviceSize>(transformsSize),
-			transformsCount,
-			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-			VMA_MEMORY_USAGE_AUTO,
-			VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT
+			static_cast<VkDeviceSize>(sizeof(Transformation)),
+			updateRingCapacity * this->engineDevice.getFramesInFlight(),
+			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VMA_MEMORY_USAGE_AUTO_PREFER_HOST,
+			VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
+			1,
+			MemoryCategory::Staging
 		);
 
-		this->transformationBuffer->copyBuffer(transformationStagingBuffer.getBuffer(), static_cast<VkDeviceSize>(transformsSize * transformsCount), commandBuffer);
-	} 
+		this->updateRing->map();
+	}
+
+	void EngineTransformationModel::evaluate(std::vector<uint32_t> dirtyIndices, const std::vector<TransformComponent> &transformationComponents) {
+		std::sort(dirtyIndices.begin(), dirtyIndices.end());
+		dirtyIndices.erase(std::unique(dirtyIndices.begin(), dirtyIndices.end()), dirtyIndices.end());
+
+		TransformBatch batch;
+		batch.resize(dirtyIndices.size());
+
+		for (size_t i = 0; i < dirtyIndices.size(); i++) {
+			batch.set(i, transformationComponents[dirtyIndices[i]]);
+		}
+
+		std::vector<Transformation> dirtyTransformations;
+		evaluateTransforms(batch, dirtyTransformations);
+
+		for (size_t i = 0; i < dirtyIndices.size(); i++) {
+			(*this->transformations)[dirtyIndices[i]] = dirtyTransformations[i];
+		}
+	}
+
+	void EngineTransformationModel::update(std::shared_ptr<EngineCommandBuffer> commandBuffer, uint32_t frameIndex, std::vector<uint32_t> dirtyIndices, const std::vector<TransformComponent> &transformationComponents) {
+		this->evaluate(dirtyIndices, transformationComponents);
+		this->update(commandBuffer, frameIndex, dirtyIndices);
+	}
+
+	void EngineTransformationModel::update(std::shared_ptr<EngineCommandBuffer> commandBuffer, uint32_t frameIndex, std::vector<uint32_t> dirtyIndices) {
+		dirtyIndices.insert(dirtyIndices.end(), this->pendingIndices.begin(), this->pendingIndices.end());
+		this->pendingIndices.clear();
+
+		std::sort(dirtyIndices.begin(), dirtyIndices.end());
+		dirtyIndices.erase(std::unique(dirtyIndices.begin(), dirtyIndices.end()), dirtyIndices.end());
+
+		if (dirtyIndices.empty()) {
+			return;
+		}
+
+		if (dirtyIndices.size() > updateRingCapacity) {
+			this->pendingIndices.assign(dirtyIndices.begin() + updateRingCapacity, dirtyIndices.end());
+			dirtyIndices.resize(updateRingCapacity);
+		}
+
+		if (this->updateRing == nullptr) {
+			this->createUpdateRing();
+		}
+
+		// The region of this frame was last read by the copies of the same frame index, which acquireFrame already waited for
+		VkDeviceSize transformSize = static_cast<VkDeviceSize>(sizeof(Transformation));
+		VkDeviceSize regionOffset = static_cast<VkDeviceSize>(frameIndex) * updateRingCapacity * transformSize;
+		VkDeviceSize writtenSize = 0;
+
+		// Sorted indices, so each run of consecutive ones is contiguous on both sides and becomes a single copy region
+		std::vector<VkBufferCopy> copyRegions;
+
+		for (size_t runStart = 0; runStart < dirtyIndices.size();) {
+			size_t runEnd = runStart + 1;
+			while (runEnd < dirtyIndices.size() && dirtyIndices[runEnd] == dirtyIndices[runEnd - 1] + 1) {
+				runEnd++;
+			}
+
+			VkDeviceSize runSize = static_cast<VkDeviceSize>(runEnd - runStart) * transformSize;
+			this->updateRing->writeToBuffer(&(*this->transformations)[dirtyIndices[runStart]], runSize, regionOffset + writtenSize);
+
+			VkBufferCopy copyRegion{};
+			copyRegion.srcOffset = regionOffset + writtenSize;
+			copyRegion.dstOffset = this->transformationBuffer->getOffset() + static_cast<VkDeviceSize>(dirtyIndices[runStart]) * transformSize;
+			copyRegion.size = runSize;
+
+			copyRegions.emplace_back(copyRegion);
+
+			writtenSize += runSize;
+			runStart = runEnd;
+		}
+
+		this->updateRing->flush(writtenSize, regionOffset);
+
+		// Previous frame shaders may still read the old values, the copy has to wait for them
+		VkBufferMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.buffer = this->transformationBuffer->getBuffer();
+		barrier.offset = this->transformationBuffer->getOffset();
+		barrier.size = this->transformationBuffer->getSize();
+		barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+		VkPipelineStageFlags shaderStages = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+		vkCmdPipelineBarrier(commandBuffer->getCommandBuffer(), shaderStages, VK_PIPELINE_STAGE_TRANSFER_BIT, 
+			0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+		vkCmdCopyBuffer(commandBuffer->getCommandBuffer(), this->updateRing->getBuffer(), this->transformationBuffer->getBuffer(), 
+			static_cast<uint32_t>(copyRegions.size()), copyRegions.data());
+
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+		vkCmdPipelineBarrier(commandBuffer->getCommandBuffer(), VK_PIPELINE_STAGE_TRANSFER_BIT, shaderStages, 
+			0, 0, nullptr, 1, &barrier, 0, nullptr);
+	}
 } // namespace nugiEngine
 
@@ -2,9 +2,12 @@
 
 #include "../../../vulkan/device/device.hpp"
 #include "../../../vulkan/buffer/buffer.hpp"
+#include "../../../vulkan/buffer/buffer_pool.hpp"
 #include "../../../vulkan/command/command_buffer.hpp"
+#include "../../../vulkan/upload/upload_batch.hpp"
 #include "../../general_struct.hpp"
 #include "../../utils/transform/transform.hpp"
+#include "../../utils/transform/transform_batch.hpp"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -16,19 +19,42 @@
 namespace nugiEngine {
 	class EngineTransformationModel {
 		public:
-			EngineTransformationModel(EngineDevice &device, std::shared_ptr<std::vector<Transformation>> transformations, std::shared_ptr<EngineCommandBuffer> commandBuffer = nullptr);
-			EngineTransformationModel(EngineDevice &device, std::shared_ptr<std::vector<TransformComponent>> transformationComponents, std::shared_ptr<EngineCommandBuffer> commandBuffer = nullptr);
+			EngineTransformationModel(EngineDevice &device, std::shared_ptr<std::vector<Transformation>> transformations, std::shared_ptr<EngineUploadBatch> uploadBatch = nullptr);
+			EngineTransformationModel(EngineDevice &device, std::shared_ptr<std::vector<TransformComponent>> transformationComponents, std::shared_ptr<EngineUploadBatch> uploadBatch = nullptr);
 
 			EngineTransformationModel(const EngineTransformationModel&) = delete;
 			EngineTransformationModel& operator = (const EngineTransformationModel&) = delete;
 
 			VkDescriptorBufferInfo getTransformationInfo() { return this->transformationBuffer->descriptorInfo();  }
+			std::shared_ptr<std::vector<Transformation>> getTransformations() const { return this->transformations; }
+
+			// Upload only the listed entries of getTransformations(), after the caller changed them in place.
+			// Must be recorded outside of a render pass, before the passes reading the transformation buffer.
+			// At most once per frame, every call reuses the whole ring region of frameIndex.
+			void update(std::shared_ptr<EngineCommandBuffer> commandBuffer, uint32_t frameIndex, std::vector<uint32_t> dirtyIndices);
+
+			// Re-evaluate the listed entries of getTransformations() from the full component array, on the CPU only.
+			// Lets the culling of the frame see the new transforms before update uploads them.
+			void evaluate(std::vector<uint32_t> dirtyIndices, const std::vector<TransformComponent> &transformationComponents);
+
+			// Re-evaluate the listed transforms from the full component array, then upload them like above
+			void update(std::shared_ptr<EngineCommandBuffer> commandBuffer, uint32_t frameIndex, std::vector<uint32_t> dirtyIndices, const std::vector<TransformComponent> &transformationComponents);
+
+			static constexpr uint32_t updateRingCapacity = 4096;
 			
 		private:
 			EngineDevice &engineDevice;
-			std::shared_ptr<EngineBuffer> transformationBuffer;
+			std::unique_ptr<EngineBufferSlice> transformationBuffer;
+			std::shared_ptr<std::vector<Transformation>> transformations;
+
+			// Persistently mapped, one region of updateRingCapacity transforms per frame in flight
+			std::shared_ptr<EngineBuffer> updateRing;
+
+			// Dirty indices that did not fit in the ring region of their frame, they go out with the next update
+			std::vector<uint32_t> pendingIndices;
 
 			std::shared_ptr<std::vector<Transformation>> convertToMatrix(std::shared_ptr<std::vector<TransformComponent>> transformationComponents);
-			void createBuffers(std::shared_ptr<std::vector<Transformation>> transformations, std::shared_ptr<EngineCommandBuffer> commandBuffer = nullptr);
+			void createBuffers(std::shared_ptr<std::vector<Transformation>> transformations, std::shared_ptr<EngineUploadBatch> uploadBatch);
+			void createUpdateRing();
 	};
 } // namespace nugiEngine
@@ -10,90 +10,138 @@
 #include <glm/gtx/hash.hpp>
 
 namespace nugiEngine {
-	EngineVertexModel::EngineVertexModel(EngineDevice &device, std::shared_ptr<std::vector<Vertex>> vertices, std::shared_ptr<std::vector<uint32_t>> indices, std::shared_ptr<EngineCommandBuffer> commandBuffer) : engineDevice{device} {
-		this->createVertexBuffers(vertices, commandBuffer);
-		this->createIndexBuffer(indices, commandBuffer);
+	EngineVertexModel::EngineVertexModel(EngineDevice &device, std::shared_ptr<std::vector<Vertex>> vertices, std::shared_ptr<std::vector<uint32_t>> indices, std::shared_ptr<EngineUploadBatch> uploadBatch) : engineDevice{device} {
+		bool isUploadBatchCreatedHere = false;
+
+		if (uploadBatch == nullptr) {
+			uploadBatch = std::make_shared<EngineUploadBatch>(this->engineDevice);
+			isUploadBatchCreatedHere = true;
+		}
+
+		this->createVertexBuffers(vertices->data(), static_cast<uint32_t>(sizeof(Vertex)), static_cast<uint32_t>(vertices->size()), uploadBatch);
+
+		// Whole mesh is addressable with 16 bit, so no need to pay for the wide indices
+		if (this->vertextCount <= static_cast<uint32_t>(UINT16_MAX) + 1u) {
+			this->createIndexBuffer(std::make_shared<std::vector<uint16_t>>(indices->begin(), indices->end()), uploadBatch);
+		} else {
+			this->createIndexBuffer(indices, uploadBatch);
+		}
+
+		if (isUploadBatchCreatedHere) {
+			uploadBatch->wait();
+		}
 	}
 
-	void EngineVertexModel::createVertexBuffers(std::shared_ptr<std::vector<Vertex>> vertices, std::shared_ptr<EngineCommandBuffer> commandBuffer) {
-		this->vertextCount = static_cast<uint32_t>(vertices->size());
+	EngineVertexModel::EngineVertexModel(EngineDevice &device, std::shared_ptr<std::vector<PackedVertex>> vertices, std::shared_ptr<std::vector<DrawData>> drawDatas, 
+		MeshletIndices indices, std::shared_ptr<EngineUploadBatch> uploadBatch) : engineDevice{device} 
+	{
+		bool isUploadBatchCreatedHere = false;
+
+		if (uploadBatch == nullptr) {
+			uploadBatch = std::make_shared<EngineUploadBatch>(this->engineDevice);
+			isUploadBatchCreatedHere = true;
+		}
+
+		this->createVertexBuffers(vertices->data(), static_cast<uint32_t>(sizeof(PackedVertex)), static_cast<uint32_t>(vertices->size()), uploadBatch);
+		this->createDrawDataBuffer(drawDatas, uploadBatch);
+
+		// Both widths may be in use at once, the meshlets know which one they were written to
+		this->createIndexBuffer(indices.indices16, uploadBatch);
+		this->createIndexBuffer(indices.indices32, uploadBatch);
+
+		if (isUploadBatchCreatedHere) {
+			uploadBatch->wait();
+		}
+	}
+
+	void EngineVertexModel::createVertexBuffers(void* vertices, uint32_t vertexSize, uint32_t vertexCount, std::shared_ptr<EngineUploadBatch> uploadBatch) {
+		this->vertextCount = vertexCount;
 		assert(vertextCount >= 3 && "Vertex count must be at least 3");
 
-		uint32_t vertexSize = static_cast<uint32_t>(sizeof(Vertex));
 		VkDeviceSize bufferSize = vertexSize * vertextCount;
 
-		EngineBuffer stagingBuffer {
-			this->engineDevice,
-			vertexSize,
-			this->vertextCount,
-			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VMA_MEMORY_USAGE_AUTO,
-			VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT
-		};
-
-		stagingBuffer.map();
-		stagingBuffer.writeToBuffer((void *) vertices->data());
-
-		this->vertexBuffer = std::make_unique<EngineBuffer>(
-			this->engineDevice,
-			vertexSize,
-			this->vertextCount,
-			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-			VMA_MEMORY_USAGE_AUTO,
-			VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT
-		);
-
-		this->vertexBuffer->copyBuffer(stagingBuffer.getBuffer(), bufferSize, commandBuffer);
+		this->vertexBuffer = this->engineDevice.getBufferPool(BufferPoolUsage::Vertex).allocate(bufferSize);
+		uploadBatch->uploadBuffer(this->vertexBuffer->getBuffer(), vertices, bufferSize, this->vertexBuffer->getOffset());
 	}
 
-	void EngineVertexModel::createIndexBuffer(std::shared_ptr<std::vector<uint32_t>> indices, std::shared_ptr<EngineCommandBuffer> commandBuffer) { 
-		this->indexCount = static_cast<uint32_t>(indices->size());
-		this->hasIndexBuffer = this->indexCount > 0;
+	void EngineVertexModel::createDrawDataBuffer(std::shared_ptr<std::vector<DrawData>> drawDatas, std::shared_ptr<EngineUploadBatch> uploadBatch) {
+		auto drawDataCount = static_cast<uint32_t>(drawDatas->size());
+		this->hasDrawDataBuffer = drawDataCount > 0;
 
-		if (!this->hasIndexBuffer) {
+		if (!this->hasDrawDataBuffer) {
 			return;
 		}
 
-		uint32_t indexSize = static_cast<uint32_t>(sizeof(uint32_t));
-		VkDeviceSize bufferSize = indexSize * this->indexCount;
-
-		EngineBuffer stagingBuffer {
-			this->engineDevice,
-			indexSize,
-			this->indexCount,
-			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VMA_MEMORY_USAGE_AUTO,
-			VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT
-		};
-
-		stagingBuffer.map();
-		stagingBuffer.writeToBuffer((void *) indices->data());
-
-		this->indexBuffer = std::make_unique<EngineBuffer>(
-			this->engineDevice,
-			indexSize,
-			this->indexCount,
-			VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-			VMA_MEMORY_USAGE_AUTO,
-			VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT
-		);
-
-		this->indexBuffer->copyBuffer(stagingBuffer.getBuffer(), bufferSize, commandBuffer);
+		uint32_t drawDataSize = static_cast<uint32_t>(sizeof(DrawData));
+		VkDeviceSize bufferSize = drawDataSize * drawDataCount;
+
+		this->drawDataBuffer = this->engineDevice.getBufferPool(BufferPoolUsage::Vertex).allocate(bufferSize);
+		uploadBatch->uploadBuffer(this->drawDataBuffer->getBuffer(), drawDatas->data(), bufferSize, this->drawDataBuffer->getOffset());
+	}
+
+	void EngineVertexModel::createIndexBuffer(std::shared_ptr<std::vector<uint32_t>> indices, std::shared_ptr<EngineUploadBatch> uploadBatch) { 
+		this->indexCount = static_cast<uint32_t>(indices->size());
+		this->hasIndexBuffer = this->hasIndexBuffer || this->indexCount > 0;
+
+		if (this->indexCount > 0) {
+			this->indexBuffer = this->createIndexBuffer(indices->data(), static_cast<uint32_t>(sizeof(uint32_t)), this->indexCount, uploadBatch);
+		}
+	}
+
+	void EngineVertexModel::createIndexBuffer(std::shared_ptr<std::vector<uint16_t>> indices, std::shared_ptr<EngineUploadBatch> uploadBatch) { 
+		this->index16Count = static_cast<uint32_t>(indices->size());
+		this->hasIndexBuffer = this->hasIndexBuffer || this->index16Count > 0;
+
+		if (this->index16Count > 0) {
+			this->index16Buffer = this->createIndexBuffer(indices->data(), static_cast<uint32_t>(sizeof(uint16_t)), this->index16Count, uploadBatch);
+		}
+	}
+
+	std::unique_ptr<EngineBufferSlice> EngineVertexModel::createIndexBuffer(void* indices, uint32_t indexSize, uint32_t indexCount, std::shared_ptr<EngineUploadBatch> uploadBatch) { 
+		VkDeviceSize bufferSize = indexSize * indexCount;
+
+		auto indexBuffer = this->engineDevice.getBufferPool(BufferPoolUsage::Index).allocate(bufferSize, indexSize);
+		uploadBatch->uploadBuffer(indexBuffer->getBuffer(), indices, bufferSize, indexBuffer->getOffset());
+
+		return indexBuffer;
 	}
 
 	void EngineVertexModel::bind(std::shared_ptr<EngineCommandBuffer> commandBuffer) {
+		// The pooled buffers are shared with other models, so every binding starts at the offset of its slice
 		VkBuffer buffers[] = {this->vertexBuffer->getBuffer()};
-		VkDeviceSize offsets[] = {0};
+		VkDeviceSize offsets[] = {this->vertexBuffer->getOffset()};
 		vkCmdBindVertexBuffers(commandBuffer->getCommandBuffer(), 0, 1, buffers, offsets);
 
+		// Instance rate binding, the draw picks its DrawData with firstInstance
+		if (this->hasDrawDataBuffer) {
+			VkBuffer drawDataBuffers[] = {this->drawDataBuffer->getBuffer()};
+			VkDeviceSize drawDataOffsets[] = {this->drawDataBuffer->getOffset()};
+			vkCmdBindVertexBuffers(commandBuffer->getCommandBuffer(), 1, 1, drawDataBuffers, drawDataOffsets);
+		}
+
 		if (this->hasIndexBuffer) {
-			vkCmdBindIndexBuffer(commandBuffer->getCommandBuffer(), this->indexBuffer->getBuffer(), 0, VK_INDEX_TYPE_UINT32);
+			this->bindIndexBuffer(commandBuffer, this->index16Count > 0 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32);
+		}
+	}
+
+	void EngineVertexModel::bindIndexBuffer(std::shared_ptr<EngineCommandBuffer> commandBuffer, VkIndexType indexType) {
+		if (indexType == VK_INDEX_TYPE_UINT16) {
+			vkCmdBindIndexBuffer(commandBuffer->getCommandBuffer(), this->index16Buffer->getBuffer(), this->index16Buffer->getOffset(), VK_INDEX_TYPE_UINT16);
+		} else {
+			vkCmdBindIndexBuffer(commandBuffer->getCommandBuffer(), this->indexBuffer->getBuffer(), this->indexBuffer->getOffset(), VK_INDEX_TYPE_UINT32);
 		}
 	}
 
 	void EngineVertexModel::draw(std::shared_ptr<EngineCommandBuffer> commandBuffer) {
 		if (this->hasIndexBuffer) {
-			vkCmdDrawIndexed(commandBuffer->getCommandBuffer(), this->indexCount, 1, 0, 0, 0);
+			if (this->index16Count > 0) {
+				vkCmdDrawIndexed(commandBuffer->getCommandBuffer(), this->index16Count, 1, 0, 0, 0);
+			}
+
+			if (this->indexCount > 0) {
+				this->bindIndexBuffer(commandBuffer, VK_INDEX_TYPE_UINT32);
+				vkCmdDrawIndexed(commandBuffer->getCommandBuffer(), this->indexCount, 1, 0, 0, 0);
+			}
 		} else {
 			vkCmdDraw(commandBuffer->getCommandBuffer(), this->vertextCount, 1, 0, 0);
 		}
@@ -2,8 +2,11 @@
 
 #include "../../../vulkan/device/device.hpp"
 #include "../../../vulkan/buffer/buffer.hpp"
+#include "../../../vulkan/buffer/buffer_pool.hpp"
 #include "../../../vulkan/command/command_buffer.hpp"
+#include "../../../vulkan/upload/upload_batch.hpp"
 #include "../../general_struct.hpp"
+#include "../../utils/meshlet/meshlet.hpp"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -15,29 +18,43 @@
 namespace nugiEngine {
 	class EngineVertexModel {
 		public:
-			EngineVertexModel(EngineDevice &device, std::shared_ptr<std::vector<Vertex>> vertices, std::shared_ptr<std::vector<uint32_t>> indices, std::shared_ptr<EngineCommandBuffer> commandBuffer = nullptr);
+			EngineVertexModel(EngineDevice &device, std::shared_ptr<std::vector<Vertex>> vertices, std::shared_ptr<std::vector<uint32_t>> indices, std::shared_ptr<EngineUploadBatch> uploadBatch = nullptr);
+			EngineVertexModel(EngineDevice &device, std::shared_ptr<std::vector<PackedVertex>> vertices, std::shared_ptr<std::vector<DrawData>> drawDatas, 
+				MeshletIndices indices, std::shared_ptr<EngineUploadBatch> uploadBatch = nullptr);
 
 			EngineVertexModel(const EngineVertexModel&) = delete;
 			EngineVertexModel& operator = (const EngineVertexModel&) = delete;
 
 			VkDescriptorBufferInfo getVertexInfo() { return this->vertexBuffer->descriptorInfo(); }
-			VkDescriptorBufferInfo getIndexInfo() { return this->indexBuffer->descriptorInfo(); }
+			VkDescriptorBufferInfo getIndexInfo() { return this->indexCount > 0 ? this->indexBuffer->descriptorInfo() : this->index16Buffer->descriptorInfo(); }
+
+			bool hasIndexType(VkIndexType indexType) const { return indexType == VK_INDEX_TYPE_UINT16 ? this->index16Count > 0 : this->indexCount > 0; }
 
 			void bind(std::shared_ptr<EngineCommandBuffer> commandBuffer);
+			void bindIndexBuffer(std::shared_ptr<EngineCommandBuffer> commandBuffer, VkIndexType indexType);
 			void draw(std::shared_ptr<EngineCommandBuffer> commandBuffer);
 			
 		private:
 			EngineDevice &engineDevice;
 			
-			std::unique_ptr<EngineBuffer> vertexBuffer;
+			std::unique_ptr<EngineBufferSlice> vertexBuffer;
 			uint32_t vertextCount;
 
-			std::unique_ptr<EngineBuffer> indexBuffer;
-			uint32_t indexCount;
+			std::unique_ptr<EngineBufferSlice> drawDataBuffer;
+			bool hasDrawDataBuffer = false;
+
+			std::unique_ptr<EngineBufferSlice> indexBuffer;
+			uint32_t indexCount = 0;
+
+			std::unique_ptr<EngineBufferSlice> index16Buffer;
+			uint32_t index16Count = 0;
 
 			bool hasIndexBuffer = false;
 
-			void createVertexBuffers(std::shared_ptr<std::vector<Vertex>> vertices, std::shared_ptr<EngineCommandBuffer> commandBuffer = nullptr);
-			void createIndexBuffer(std::shared_ptr<std::vector<uint32_t>> indices, std::shared_ptr<EngineCommandBuffer> commandBuffer = nullptr);
+			void createVertexBuffers(void* vertices, uint32_t vertexSize, uint32_t vertexCount, std::shared_ptr<EngineUploadBatch> uploadBatch);
+			void createDrawDataBuffer(std::shared_ptr<std::vector<DrawData>> drawDatas, std::shared_ptr<EngineUploadBatch> uploadBatch);
+			void createIndexBuffer(std::shared_ptr<std::vector<uint32_t>> indices, std::shared_ptr<EngineUploadBatch> uploadBatch);
+			void createIndexBuffer(std::shared_ptr<std::vector<uint16_t>> indices, std::shared_ptr<EngineUploadBatch> uploadBatch);
+			std::unique_ptr<EngineBufferSlice> createIndexBuffer(void* indices, uint32_t indexSize, uint32_t indexCount, std::shared_ptr<EngineUploadBatch> uploadBatch);
 	};
 } // namespace nugiEngine
@@ -1,9 +1,18 @@
 #include "general_struct.hpp"
 
 namespace nugiEngine {
+  Transformation Transformation::fromMatrix(const glm::mat4 &pointMatrix, const glm::mat4 &pointInverseMatrix) {
+    return Transformation{ glm::mat3x4(glm::transpose(pointMatrix)), glm::mat3x4(glm::transpose(pointInverseMatrix)) };
+  }
+
+  glm::vec3 Transformation::transformNormal(glm::vec3 normal) const {
+    return glm::vec3(this->pointInverseMatrix[0]) * normal.x + glm::vec3(this->pointInverseMatrix[1]) * normal.y 
+      + glm::vec3(this->pointInverseMatrix[2]) * normal.z;
+  }
+
   bool Vertex::operator == (const Vertex &other) const {
     return this->position == other.position && this->materialIndex == other.materialIndex && 
-			this->transformIndex == other.transformIndex;
+			this->transformIndex == other.transformIndex && this->textCoord == other.textCoord;
   }
 
   std::vector<VkVertexInputBindingDescription> Vertex::getVertexBindingDescriptions() {
@@ -36,4 +45,54 @@ namespace nugiEngine {
 
 		return attributeDescription;
 	}
+
+	std::vector<VkVertexInputBindingDescription> PackedVertex::getVertexBindingDescriptions() {
+		std::vector<VkVertexInputBindingDescription> bindingDescriptions(2);
+		
+		bindingDescriptions[0].binding = 0;
+		bindingDescriptions[0].stride = sizeof(PackedVertex);
+		bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+		bindingDescriptions[1].binding = 1;
+		bindingDescriptions[1].stride = sizeof(DrawData);
+		bindingDescriptions[1].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+		return bindingDescriptions;
+	}
+
+	std::vector<VkVertexInputAttributeDescription> PackedVertex::getVertexAttributeDescriptions() {
+		std::vector<VkVertexInputAttributeDescription> attributeDescription(6);
+
+		attributeDescription[0].binding = 0;
+		attributeDescription[0].location = 0;
+		attributeDescription[0].format = VK_FORMAT_R16G16B16A16_UNORM;
+		attributeDescription[0].offset = offsetof(PackedVertex, position);
+
+		attributeDescription[1].binding = 0;
+		attributeDescription[1].location = 1;
+		attributeDescription[1].format = VK_FORMAT_R16G16_SNORM;
+		attributeDescription[1].offset = offsetof(PackedVertex, normal);
+
+		attributeDescription[2].binding = 0;
+		attributeDescription[2].location = 2;
+		attributeDescription[2].format = VK_FORMAT_R16G16_SFLOAT;
+		attributeDescription[2].offset = offsetof(PackedVertex, textCoord);
+
+		attributeDescription[3].binding = 1;
+		attributeDescription[3].location = 3;
+		attributeDescription[3].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+		attributeDescription[3].offset = offsetof(DrawData, positionOffset);
+
+		attributeDescription[4].binding = 1;
+		attributeDescription[4].location = 4;
+		attributeDescription[4].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+		attributeDescription[4].offset = offsetof(DrawData, positionScale);
+
+		attributeDescription[5].binding = 1;
+		attributeDescription[5].location = 5;
+		attributeDescription[5].format = VK_FORMAT_R32G32_UINT;
+		attributeDescription[5].offset = offsetof(DrawData, materialIndex);
+
+		return attributeDescription;
+	}
 }
\ No newline at end of file
@@ -13,6 +13,7 @@ namespace nugiEngine {
     glm::vec4 position{};
     uint32_t materialIndex{}; // Because of hybrid rendering, Material Index also hold by Vertex
     uint32_t transformIndex{}; // Because of hybrid rendering, Transform Index also hold by Vertex
+    glm::vec2 textCoord{0.0f};
 
     static std::vector<VkVertexInputBindingDescription> getVertexBindingDescriptions();
     static std::vector<VkVertexInputAttributeDescription> getVertexAttributeDescriptions();
@@ -20,6 +21,25 @@ namespace nugiEngine {
     bool operator == (const Vertex &other) const;
   };
 
+  // Compact raster vertex: position quantized to the bounds of its mesh (see DrawData),
+  // octahedral encoded normal and half float texture coordinate. Material and transform live in DrawData.
+  struct PackedVertex {
+    uint16_t position[4]{}; // unorm, w is unused
+    int16_t normal[2]{}; // snorm octahedral
+    uint16_t textCoord[2]{}; // half float
+
+    static std::vector<VkVertexInputBindingDescription> getVertexBindingDescriptions();
+    static std::vector<VkVertexInputAttributeDescription> getVertexAttributeDescriptions();
+  };
+
+  // Per draw data, fed as instance rate vertex attribute and selected by firstInstance of the draw
+  struct DrawData {
+    alignas(16) glm::vec4 positionOffset{0.0f};
+    glm::vec4 positionScale{1.0f};
+    uint32_t materialIndex = 0;
+    uint32_t transformIndex = 0;
+  };
+
   struct Primitive {
     alignas(16) glm::uvec3 indices;
     uint32_t materialIndex;
@@ -53,12 +73,19 @@ namespace nugiEngine {
     uint32_t normalTextureIndex;
   };
 
+  // Affine 3x4 matrix and its inverse, stored transposed: column i holds row i with the translation in w.
+  // Direction matrices are the upper 3x3 of them, the normal matrix is the transposed upper 3x3 of the inverse.
   struct Transformation {
-    glm::mat4 pointMatrix{1.0f};
-    glm::mat4 dirMatrix{1.0f};
-    glm::mat4 pointInverseMatrix{1.0f};
-    glm::mat4 dirInverseMatrix{1.0f};
-    glm::mat4 normalMatrix{1.0f};
+    glm::mat3x4 pointMatrix{1.0f};
+    glm::mat3x4 pointInverseMatrix{1.0f};
+
+    static Transformation fromMatrix(const glm::mat4 &pointMatrix, const glm::mat4 &pointInverseMatrix);
+
+    glm::vec3 transformPoint(glm::vec3 point) const { return glm::vec4(point, 1.0f) * this->pointMatrix; }
+    glm::vec3 transformDir(glm::vec3 direction) const { return glm::vec4(direction, 0.0f) * this->pointMatrix; }
+    glm::vec3 inverseTransformPoint(glm::vec3 point) const { return glm::vec4(point, 1.0f) * this->pointInverseMatrix; }
+    glm::vec3 inverseTransformDir(glm::vec3 direction) const { return glm::vec4(direction, 0.0f) * this->pointInverseMatrix; }
+    glm::vec3 transformNormal(glm::vec3 normal) const;
   };
 
   struct PointLight {
@@ -1,25 +1,28 @@
 #include "hybrid_renderer.hpp"
+#include "../../vulkan/upload/transfer_uploader.hpp"
 
 #include <stdexcept>
 #include <array>
 #include <string>
 
 namespace nugiEngine {
-	EngineHybridRenderer::EngineHybridRenderer(EngineWindow& window, EngineDevice& device) : appDevice{device}, appWindow{window} {
+	EngineHybridRenderer::EngineHybridRenderer(EngineWindow& window, EngineDevice& device, uint32_t recordingThreadCount) : appDevice{device}, appWindow{window} {
 		this->recreateSwapChain();
 		this->createSyncObjects(static_cast<uint32_t>(this->swapChain->imageCount()));
 
-		this->commandBuffers = EngineCommandBuffer::createCommandBuffers(device, EngineDevice::MAX_FRAMES_IN_FLIGHT);
+		this->commandAllocator = std::make_unique<EngineFrameCommandAllocator>(device, device.getFamilyIndices().graphicsFamily, recordingThreadCount);
+		this->computeCommandAllocator = std::make_unique<EngineFrameCommandAllocator>(device, device.getFamilyIndices().computeFamily, 1);
 		this->createDescriptorPool();
 	}
 
 	EngineHybridRenderer::~EngineHybridRenderer() {
+		// Command buffers of the last frames may still be executing
+		this->appDevice.getScheduler().waitIdle();
 		this->descriptorPool->resetPool();
 		
-    for (size_t i = 0; i < EngineDevice::MAX_FRAMES_IN_FLIGHT; i++) {
+    for (size_t i = 0; i < this->appDevice.getFramesInFlight(); i++) {
 			vkDestroySemaphore(this->appDevice.getLogicalDevice(), this->renderFinishedSemaphores[i], nullptr);
 			vkDestroySemaphore(this->appDevice.getLogicalDevice(), this->imageAvailableSemaphores[i], nullptr);
-			vkDestroyFence(this->appDevice.getLogicalDevice(), this->inFlightFences[i], nullptr);
 		}
 	}
 
@@ -30,7 +33,11 @@ namespace nugiEngine {
 			glfwWaitEvents();
 		}
 
-		vkDeviceWaitIdle(this->appDevice.getLogicalDevice());
+		{
+			// Waiting for idle accesses every queue, the transfer uploader may be submitting to one of them from its own thread
+			std::lock_guard<std::mutex> lock{this->appDevice.getScheduler().getQueueMutex()};
+			vkDeviceWaitIdle(this->appDevice.getLogicalDevice());
+		}
 
 		if (this->swapChain == nullptr) {
 			this->swapChain = std::make_unique<EngineSwapChain>(this->appDevice, extent);
@@ -50,26 +57,23 @@ namespace nugiEngine {
 				.setMaxSets(20)
 				.addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 50)
 				.addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 50)
+				.addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 50)
 				.addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 100)
 				.build();
 	}
 
 	void EngineHybridRenderer::createSyncObjects(uint32_t imageCount) {
-		imageAvailableSemaphores.resize(EngineDevice::MAX_FRAMES_IN_FLIGHT);
-		renderFinishedSemaphores.resize(EngineDevice::MAX_FRAMES_IN_FLIGHT);
-		inFlightFences.resize(EngineDevice::MAX_FRAMES_IN_FLIGHT);
+		imageAvailableSemaphores.resize(this->appDevice.getFramesInFlight());
+		renderFinishedSemaphores.resize(this->appDevice.getFramesInFlight());
+		frameTimelinePoints.resize(this->appDevice.getFramesInFlight());
+		frameComputeTimelinePoints.resize(this->appDevice.getFramesInFlight());
 
 		VkSemaphoreCreateInfo semaphoreInfo = {};
 		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-		VkFenceCreateInfo fenceInfo = {};
-		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-		fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
-		for (size_t i = 0; i < EngineDevice::MAX_FRAMES_IN_FLIGHT; i++) {
+		for (size_t i = 0; i < this->appDevice.getFramesInFlight(); i++) {
 		  if (vkCreateSemaphore(this->appDevice.getLogicalDevice(), &semaphoreInfo, nullptr, &this->imageAvailableSemaphores[i]) != VK_SUCCESS ||
-				vkCreateSemaphore(this->appDevice.getLogicalDevice(), &semaphoreInfo, nullptr, &this->renderFinishedSemaphores[i]) != VK_SUCCESS ||
-				vkCreateFence(this->appDevice.getLogicalDevice(), &fenceInfo, nullptr, &this->inFlightFences[i]) != VK_SUCCESS) 
+				vkCreateSemaphore(this->appDevice.getLogicalDevice(), &semaphoreInfo, nullptr, &this->renderFinishedSemaphores[i]) != VK_SUCCESS) 
 			{
 				throw std::runtime_error("failed to create synchronization objects for a frame!");
 		  }
@@ -79,8 +83,9 @@ namespace nugiEngine {
 	bool EngineHybridRenderer::acquireFrame() {
 		assert(!this->isFrameStarted && "can't acquire frame while frame still in progress");
 
-		std::vector<VkFence> acquireFrameFences = { this->inFlightFences[this->currentFrameIndex] };
-		auto result = this->swapChain->acquireNextImage(&this->currentImageIndex, acquireFrameFences, this->imageAvailableSemaphores[this->currentFrameIndex]);
+		this->appDevice.getScheduler().wait(this->frameTimelinePoints[this->currentFrameIndex]);
+		this->appDevice.getScheduler().wait(this->frameComputeTimelinePoints[this->currentFrameIndex]);
+		auto result = this->swapChain->acquireNextImage(&this->currentImageIndex, {}, this->imageAvailableSemaphores[this->currentFrameIndex]);
 		
 		if (result == VK_ERROR_OUT_OF_DATE_KHR) {
 			this->recreateSwapChain();
@@ -91,6 +96,11 @@ namespace nugiEngine {
 			throw std::runtime_error("failed to acquire swap chain image");
 		}
 
+		// The previous submission of this frame has finished, its constants and command buffers can be reused
+		this->appDevice.getUniformRing().beginFrame(this->currentFrameIndex);
+		this->commandAllocator->beginFrame(this->currentFrameIndex);
+		this->computeCommandAllocator->beginFrame(this->currentFrameIndex);
+
 		this->isFrameStarted = true;
 		return true;
 	}
@@ -98,8 +108,16 @@ namespace nugiEngine {
 	std::shared_ptr<EngineCommandBuffer> EngineHybridRenderer::beginCommand() {
 		assert(this->isFrameStarted && "can't start command while frame still in progress");
 
-		this->commandBuffers[this->currentFrameIndex]->beginReccuringCommand();
-		return this->commandBuffers[this->currentFrameIndex];
+		this->currentCommandBuffer = this->commandAllocator->acquire(0);
+		this->currentCommandBuffer->beginSingleTimeCommand();
+
+		// Uploads finished by the transfer queue are taken over first, so every later command of the frame can use them
+		if (!this->appDevice.isTransferIdle()) {
+			auto transferWaits = this->appDevice.getTransferUploader().acquire(QueueType::Graphics, this->currentCommandBuffer);
+			this->pendingGraphicsWaits.insert(this->pendingGraphicsWaits.end(), transferWaits.begin(), transferWaits.end());
+		}
+
+		return this->currentCommandBuffer;
 	}
 
 	void EngineHybridRenderer::endCommand(std::shared_ptr<EngineCommandBuffer> commandBuffer) {
@@ -109,33 +127,83 @@ namespace nugiEngine {
 
 	void EngineHybridRenderer::submitRenderCommands(std::vector<std::shared_ptr<EngineCommandBuffer>> commandBuffer) {
 		assert(this->isFrameStarted && "can't submit command if frame is not in progress");
-		vkResetFences(this->appDevice.getLogicalDevice(), 1, &this->inFlightFences[this->currentFrameIndex]);
+		this->appDevice.getUniformRing().flush();
 
 		std::vector<VkSemaphore> waitSemaphores = { this->imageAvailableSemaphores[this->currentFrameIndex] };
 		std::vector<VkSemaphore> signalSemaphores = { this->renderFinishedSemaphores[this->currentFrameIndex] };
 		std::vector<VkPipelineStageFlags> waitStages = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
 
-		EngineCommandBuffer::submitCommands(commandBuffers, this->appDevice.getGraphicsQueue(this->currentFrameIndex), waitSemaphores, waitStages, signalSemaphores, this->inFlightFences[this->currentFrameIndex]);
+		this->frameTimelinePoints[this->currentFrameIndex] = this->appDevice.getScheduler().submit(QueueType::Graphics, commandBuffer, this->pendingGraphicsWaits, 
+			waitSemaphores, waitStages, signalSemaphores);
+		this->pendingGraphicsWaits.clear();
 	}
 
 	void EngineHybridRenderer::submitRenderCommand(std::shared_ptr<EngineCommandBuffer> commandBuffer) {
 		assert(this->isFrameStarted && "can't submit command if frame is not in progress");
-		vkResetFences(this->appDevice.getLogicalDevice(), 1, &this->inFlightFences[this->currentFrameIndex]);
+		this->appDevice.getUniformRing().flush();
 
 		std::vector<VkSemaphore> waitSemaphores = { this->imageAvailableSemaphores[this->currentFrameIndex] };
 		std::vector<VkSemaphore> signalSemaphores = { this->renderFinishedSemaphores[this->currentFrameIndex] };
 		std::vector<VkPipelineStageFlags> waitStages = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
 
-		commandBuffer->submitCommand(this->appDevice.getGraphicsQueue(this->currentFrameIndex), waitSemaphores, waitStages, signalSemaphores, this->inFlightFences[this->currentFrameIndex]);
+		this->frameTimelinePoints[this->currentFrameIndex] = this->appDevice.getScheduler().submit(QueueType::Graphics, { commandBuffer }, this->pendingGraphicsWaits, 
+			waitSemaphores, waitStages, signalSemaphores);
+		this->pendingGraphicsWaits.clear();
+	}
+
+	std::shared_ptr<EngineCommandBuffer> EngineHybridRenderer::beginComputeCommand() {
+		assert(this->isFrameStarted && "can't start compute command if frame is not in progress");
+
+		auto commandBuffer = this->computeCommandAllocator->acquire(0);
+		commandBuffer->beginSingleTimeCommand();
+
+		if (!this->appDevice.isTransferIdle()) {
+			auto transferWaits = this->appDevice.getTransferUploader().acquire(QueueType::Compute, commandBuffer);
+			this->pendingComputeWaits.insert(this->pendingComputeWaits.end(), transferWaits.begin(), transferWaits.end());
+		}
+
+		return commandBuffer;
+	}
+
+	TimelinePoint EngineHybridRenderer::submitComputeCommand(std::shared_ptr<EngineCommandBuffer> commandBuffer, VkPipelineStageFlags graphicsWaitStage, 
+		std::vector<TimelineWait> waits) 
+	{
+		assert(this->isFrameStarted && "can't submit compute command if frame is not in progress");
+
+		waits.insert(waits.end(), this->pendingComputeWaits.begin(), this->pendingComputeWaits.end());
+		this->pendingComputeWaits.clear();
+
+		auto computePoint = this->appDevice.getScheduler().submit(QueueType::Compute, { commandBuffer }, waits);
+
+		this->frameComputeTimelinePoints[this->currentFrameIndex] = computePoint;
+		this->pendingGraphicsWaits.emplace_back(TimelineWait{ computePoint, graphicsWaitStage });
+
+		return computePoint;
+	}
+
+	EngineQueueTransfer EngineHybridRenderer::getComputeToGraphicsTransfer() const {
+		auto familyIndices = this->appDevice.getFamilyIndices();
+		return EngineQueueTransfer{ familyIndices.computeFamily, familyIndices.graphicsFamily };
+	}
+
+	EngineQueueTransfer EngineHybridRenderer::getGraphicsToComputeTransfer() const {
+		auto familyIndices = this->appDevice.getFamilyIndices();
+		return EngineQueueTransfer{ familyIndices.graphicsFamily, familyIndices.computeFamily };
 	}
 
 	bool EngineHybridRenderer::presentFrame() {
 		assert(this->isFrameStarted && "can't present frame if frame is not in progress");
 
 		std::vector<VkSemaphore> waitSemaphores = {this->renderFinishedSemaphores[this->currentFrameIndex]};
-		auto result = this->swapChain->presentRenders(this->appDevice.getPresentQueue(this->currentFrameIndex), &this->currentImageIndex, waitSemaphores);
+		VkResult result;
+
+		{
+			// The present queue may be one the transfer uploader submits to from its own thread
+			std::lock_guard<std::mutex> lock{this->appDevice.getScheduler().getQueueMutex()};
+			result = this->swapChain->presentRenders(this->appDevice.getPresentQueue(), &this->currentImageIndex, waitSemaphores);
+		}
 
-		this->currentFrameIndex = (this->currentFrameIndex + 1) % EngineDevice::MAX_FRAMES_IN_FLIGHT;
+		this->currentFrameIndex = (this->currentFrameIndex + 1) % this->appDevice.getFramesInFlight();
 		this->isFrameStarted = false;
 
 		if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || this->appWindow.wasResized()) {
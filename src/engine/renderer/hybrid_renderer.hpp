@@ -4,8 +4,12 @@
 #include "../../vulkan/device/device.hpp"
 #include "../../vulkan/swap_chain/swap_chain.hpp"
 #include "../../vulkan/buffer/buffer.hpp"
+#include "../../vulkan/buffer/uniform_ring.hpp"
 #include "../../vulkan/descriptor/descriptor.hpp"
 #include "../../vulkan/command/command_buffer.hpp"
+#include "../../vulkan/command/command_pool.hpp"
+#include "../../vulkan/scheduler/gpu_scheduler.hpp"
+#include "../../vulkan/scheduler/queue_transfer.hpp"
 #include "../general_struct.hpp"
 
 #include <memory>
@@ -16,7 +20,7 @@ namespace nugiEngine {
 	class EngineHybridRenderer
 	{
 		public:
-			EngineHybridRenderer(EngineWindow& window, EngineDevice& device);
+			EngineHybridRenderer(EngineWindow& window, EngineDevice& device, uint32_t recordingThreadCount = EngineFrameCommandAllocator::defaultThreadCount());
 			~EngineHybridRenderer();
 
 			EngineHybridRenderer(const EngineHybridRenderer&) = delete;
@@ -24,11 +28,14 @@ namespace nugiEngine {
 
 			std::shared_ptr<EngineSwapChain> getSwapChain() const { return this->swapChain; }
 			std::shared_ptr<EngineDescriptorPool> getDescriptorPool() const { return this->descriptorPool; }
+
+			// Command pools of every frame and recording thread, reset by acquireFrame
+			EngineFrameCommandAllocator& getCommandAllocator() { return *this->commandAllocator; }
 			bool isFrameInProgress() const { return this->isFrameStarted; }
 
 			VkCommandBuffer getCommandBuffer() const { 
 				assert(this->isFrameStarted && "cannot get command buffer when frame is not in progress");
-				return this->commandBuffers[this->currentFrameIndex]->getCommandBuffer();
+				return this->currentCommandBuffer->getCommandBuffer();
 			}
 
 			uint32_t getFrameIndex() {
@@ -47,6 +54,19 @@ namespace nugiEngine {
 			void submitRenderCommands(std::vector<std::shared_ptr<EngineCommandBuffer>> commandBuffer);
 			void submitRenderCommand(std::shared_ptr<EngineCommandBuffer> commandBuffer);
 
+			// Async compute: dispatches recorded here run on the compute queue, overlapping the raster work and presentation
+			// of the graphics queue. Only valid while a frame is in progress.
+			std::shared_ptr<EngineCommandBuffer> beginComputeCommand();
+
+			// The next render submission of the frame waits for this one at graphicsWaitStage. Resources the graphics queue reads
+			// afterwards are handed over with an EngineQueueTransfer from getComputeToGraphicsTransfer, released in commandBuffer
+			// before the submit and acquired in the render command buffer.
+			TimelinePoint submitComputeCommand(std::shared_ptr<EngineCommandBuffer> commandBuffer, VkPipelineStageFlags graphicsWaitStage, 
+				std::vector<TimelineWait> waits = {});
+
+			EngineQueueTransfer getComputeToGraphicsTransfer() const;
+			EngineQueueTransfer getGraphicsToComputeTransfer() const;
+
 			bool acquireFrame();
 			bool presentFrame();
 
@@ -59,12 +79,23 @@ namespace nugiEngine {
 			EngineDevice& appDevice;
 
 			std::shared_ptr<EngineSwapChain> swapChain;
-			std::vector<std::shared_ptr<EngineCommandBuffer>> commandBuffers;
+			std::unique_ptr<EngineFrameCommandAllocator> commandAllocator;
+			std::unique_ptr<EngineFrameCommandAllocator> computeCommandAllocator;
+			std::shared_ptr<EngineCommandBuffer> currentCommandBuffer;
 
 			std::shared_ptr<EngineDescriptorPool> descriptorPool;
 
+			// Binary, the swap chain can not wait for or signal timeline semaphores
 			std::vector<VkSemaphore> imageAvailableSemaphores, renderFinishedSemaphores;
-			std::vector<VkFence> inFlightFences;
+
+			// Where each frame's submission ends on the graphics timeline, reached means the frame is free again
+			std::vector<TimelinePoint> frameTimelinePoints, frameComputeTimelinePoints;
+
+			// Compute submissions and transfer uploads the next render submission still has to wait for
+			std::vector<TimelineWait> pendingGraphicsWaits;
+
+			// Transfer uploads acquired by the compute command buffer being recorded
+			std::vector<TimelineWait> pendingComputeWaits;
 
 			uint32_t currentImageIndex = 0, currentFrameIndex = 0;
 			bool isFrameStarted = false, isLoadResouce = false;
@@ -4,55 +4,50 @@
 #include <array>
 
 namespace nugiEngine {
-  EngineSwapChainSubRenderer::EngineSwapChainSubRenderer(EngineDevice &device, std::vector<std::shared_ptr<EngineImage>> swapChainImages, VkFormat swapChainImageFormat, int imageCount, int width, int height) 
-    : device{device}, swapChainImages{swapChainImages}, width{width}, height{height}
+  EngineSwapChainSubRenderer::EngineSwapChainSubRenderer(EngineDevice &device, EngineRenderGraph &renderGraph, std::vector<std::shared_ptr<EngineImage>> swapChainImages, 
+    VkFormat swapChainImageFormat, int imageCount, int width, int height) 
+    : device{device}, swapChainImages{swapChainImages}, swapChainImageFormat{swapChainImageFormat}, imageCount{imageCount}, width{width}, height{height}
   {
-    this->createColorResources(swapChainImageFormat, imageCount);
-    this->createDepthResources(imageCount);
-    this->createRenderPass(swapChainImageFormat, imageCount);
+    this->createColorResources(renderGraph);
+    this->createDepthResources(renderGraph);
   }
 
-  void EngineSwapChainSubRenderer::createColorResources(VkFormat swapChainImageFormat, int imageCount) {
-    VkFormat colorFormat = swapChainImageFormat;
+  void EngineSwapChainSubRenderer::createRenderTargets(EngineRenderGraph &renderGraph) {
+    this->renderPass = nullptr;
+    this->renderTargetMemory = std::make_unique<EngineRenderGraphMemory>(this->device, renderGraph);
 
-    auto msaaSamples = this->device.getMSAASamples();
-    this->colorImages.clear();
+    this->createRenderPass();
+  }
 
-    for (int i = 0; i < imageCount; i++) {
-      auto colorImage = std::make_shared<EngineImage>(
-        this->device, this->width, this->height, 1, msaaSamples, colorFormat,
-        VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
-        VMA_MEMORY_USAGE_AUTO, VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT, 
-        VK_IMAGE_ASPECT_COLOR_BIT
-      );
+  void EngineSwapChainSubRenderer::createColorResources(EngineRenderGraph &renderGraph) {
+    RenderGraphImageInfo colorInfo{};
+    colorInfo.width = static_cast<uint32_t>(this->width);
+    colorInfo.height = static_cast<uint32_t>(this->height);
+    colorInfo.format = this->swapChainImageFormat;
+    colorInfo.samples = this->device.getMSAASamples();
+    colorInfo.usage = VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    colorInfo.aspect = VK_IMAGE_ASPECT_COLOR_BIT;
 
-      this->colorImages.push_back(colorImage);
-    }
+    this->colorResource = renderGraph.createImage("msaaColor", colorInfo);
   }
 
-  void EngineSwapChainSubRenderer::createDepthResources(int imageCount) {
-    VkFormat depthFormat = this->findDepthFormat();
-    
-    auto msaaSamples = this->device.getMSAASamples();
-    this->depthImages.clear();
-
-    for (int i = 0; i < imageCount; i++) {
-      auto depthImage = std::make_shared<EngineImage>(
-        this->device, this->width, this->height, 1, msaaSamples, depthFormat, 
-        VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, 
-        VMA_MEMORY_USAGE_AUTO, VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT, 
-        VK_IMAGE_ASPECT_DEPTH_BIT
-      );
+  void EngineSwapChainSubRenderer::createDepthResources(EngineRenderGraph &renderGraph) {
+    RenderGraphImageInfo depthInfo{};
+    depthInfo.width = static_cast<uint32_t>(this->width);
+    depthInfo.height = static_cast<uint32_t>(this->height);
+    depthInfo.format = this->findDepthFormat();
+    depthInfo.samples = this->device.getMSAASamples();
+    depthInfo.usage = VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+    depthInfo.aspect = VK_IMAGE_ASPECT_DEPTH_BIT;
 
-      this->depthImages.push_back(depthImage);
-    }
+    this->depthResource = renderGraph.createImage("depth", depthInfo);
   }
 
-  void EngineSwapChainSubRenderer::createRenderPass(VkFormat swapChainImageFormat, int imageCount) {
+  void EngineSwapChainSubRenderer::createRenderPass() {
     auto msaaSamples = this->device.getMSAASamples();
 
     VkAttachmentDescription albedoColorAttachment{};
-    albedoColorAttachment.format = swapChainImageFormat;
+    albedoColorAttachment.format = this->swapChainImageFormat;
     albedoColorAttachment.samples = msaaSamples;
     albedoColorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
     albedoColorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
@@ -84,7 +79,7 @@ namespace nugiEngine {
     depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
     VkAttachmentDescription colorResolveAttachment{};
-    colorResolveAttachment.format = swapChainImageFormat;
+    colorResolveAttachment.format = this->swapChainImageFormat;
     colorResolveAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
     colorResolveAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     colorResolveAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
@@ -104,16 +99,15 @@ namespace nugiEngine {
     subpass.pDepthStencilAttachment = &depthAttachmentRef;
     subpass.pResolveAttachments = &colorResolveAttachmentRef;
 
+    // Only orders the swap chain image transition after the acquire semaphore, which waits at the color output stage.
+    // The previous frame's writes to the color and depth attachments are waited for by the render graph barrier.
     VkSubpassDependency dependency = {};
     dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
     dependency.srcAccessMask = 0;
-    dependency.srcStageMask =
-      VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+    dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
     dependency.dstSubpass = 0;
-    dependency.dstStageMask =
-      VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-    dependency.dstAccessMask =
-      VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
 
 		EngineRenderPass::Builder renderPassBuilder = EngineRenderPass::Builder(this->device, this->width, this->height)
 			.addAttachments(albedoColorAttachment)
@@ -123,10 +117,11 @@ namespace nugiEngine {
 			.addSubpass(subpass)
 			.addDependency(dependency);
 
-    for (int i = 0; i < imageCount; i++) {
+    // Every framebuffer shares the same attachments, only the resolve target differs
+    for (int i = 0; i < this->imageCount; i++) {
 			renderPassBuilder.addViewImages({
-        this->colorImages[i]->getImageView(), 
-        this->depthImages[i]->getImageView(),
+        this->renderTargetMemory->getImageView(this->colorResource), 
+        this->renderTargetMemory->getImageView(this->depthResource),
         this->swapChainImages[i]->getImageView()
       });
     }
@@ -141,7 +136,17 @@ namespace nugiEngine {
       VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
   }
 
-  void EngineSwapChainSubRenderer::beginRenderPass(std::shared_ptr<EngineCommandBuffer> commandBuffer, int currentImageIndex) {
+  VkCommandBufferInheritanceInfo EngineSwapChainSubRenderer::getInheritanceInfo(int currentImageIndex) const {
+    VkCommandBufferInheritanceInfo inheritanceInfo{};
+    inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritanceInfo.renderPass = this->getRenderPass()->getRenderPass();
+    inheritanceInfo.subpass = 0;
+    inheritanceInfo.framebuffer = this->getRenderPass()->getFramebuffers(currentImageIndex);
+
+    return inheritanceInfo;
+  }
+
+  void EngineSwapChainSubRenderer::beginRenderPass(std::shared_ptr<EngineCommandBuffer> commandBuffer, int currentImageIndex, VkSubpassContents contents) {
 		VkRenderPassBeginInfo renderBeginInfo{};
 		renderBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
 		renderBeginInfo.renderPass = this->getRenderPass()->getRenderPass();
@@ -156,7 +161,11 @@ namespace nugiEngine {
 		renderBeginInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
 		renderBeginInfo.pClearValues = clearValues.data();
 
-		vkCmdBeginRenderPass(commandBuffer->getCommandBuffer(), &renderBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+		vkCmdBeginRenderPass(commandBuffer->getCommandBuffer(), &renderBeginInfo, contents);
+
+		if (contents == VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS) {
+			return;
+		}
 
 		VkViewport viewport{};
 		viewport.x = 0.0f;
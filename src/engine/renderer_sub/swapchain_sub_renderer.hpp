@@ -2,35 +2,57 @@
 
 #include "../../vulkan/image/image.hpp"
 #include "../../vulkan/renderpass/renderpass.hpp"
+#include "../../vulkan/render_graph/render_graph.hpp"
+#include "../../vulkan/render_graph/render_graph_memory.hpp"
 
 #include <vulkan/vulkan.h>
 #include <vector>
 #include <memory>
 
 namespace nugiEngine {
+  // The MSAA color and depth attachments are transient images of the render graph: one of each, whatever the swap chain
+  // image count, since the frames using them run one after another on the graphics queue. The render pass exists
+  // once createRenderTargets allocated them, after the passes writing them were added and the graph compiled.
   class EngineSwapChainSubRenderer {
     public:
-      EngineSwapChainSubRenderer(EngineDevice &device, std::vector<std::shared_ptr<EngineImage>> swapChainImages, VkFormat swapChainImageFormat, int imageCount, int width, int height);
+      EngineSwapChainSubRenderer(EngineDevice &device, EngineRenderGraph &renderGraph, std::vector<std::shared_ptr<EngineImage>> swapChainImages, 
+        VkFormat swapChainImageFormat, int imageCount, int width, int height);
+
+      void createRenderTargets(EngineRenderGraph &renderGraph);
+
       std::shared_ptr<EngineRenderPass> getRenderPass() const { return this->renderPass; }
 
-      void beginRenderPass(std::shared_ptr<EngineCommandBuffer> commandBuffer, int currentImageIndex);
+      RenderGraphResource getColorResource() const { return this->colorResource; }
+      RenderGraphResource getDepthResource() const { return this->depthResource; }
+
+      VkExtent2D getExtent() const { return { static_cast<uint32_t>(this->width), static_cast<uint32_t>(this->height) }; }
+
+      // For secondary command buffers recorded into the render pass of currentImageIndex
+      VkCommandBufferInheritanceInfo getInheritanceInfo(int currentImageIndex) const;
+
+      // With SECONDARY_COMMAND_BUFFERS contents the viewport and scissor are left to the secondary command buffers
+      void beginRenderPass(std::shared_ptr<EngineCommandBuffer> commandBuffer, int currentImageIndex, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
 			void endRenderPass(std::shared_ptr<EngineCommandBuffer> commandBuffer);
       
     private:
       int width, height;
       EngineDevice &device;
 
-      std::vector<std::shared_ptr<EngineImage>> colorImages;
-      std::vector<std::shared_ptr<EngineImage>> depthImages;
+      VkFormat swapChainImageFormat;
+      int imageCount;
+
+      RenderGraphResource colorResource, depthResource;
       std::vector<std::shared_ptr<EngineImage>> swapChainImages;
-      
+
+      // Declared before the render pass, whose framebuffers have to go first
+      std::unique_ptr<EngineRenderGraphMemory> renderTargetMemory;
       std::shared_ptr<EngineRenderPass> renderPass;
 
       VkFormat findDepthFormat();
 
-      void createColorResources(VkFormat swapChainImageFormat, int imageCount);
-      void createDepthResources(int imageCount);
-      void createRenderPass(VkFormat swapChainImageFormat, int imageCount);
+      void createColorResources(EngineRenderGraph &renderGraph);
+      void createDepthResources(EngineRenderGraph &renderGraph);
+      void createRenderPass();
   };
   
 } // namespace nugiEngine
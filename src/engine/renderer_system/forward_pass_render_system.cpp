@@ -5,6 +5,7 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/constants.hpp>
 
+#include <algorithm>
 #include <stdexcept>
 #include <array>
 #include <string>
@@ -41,10 +42,12 @@ namespace nugiEngine {
 
 		this->pipeline = EngineGraphicPipeline::Builder(this->appDevice, renderPass, this->pipelineLayout)
 			.setDefault("shader/forward_pass.vert.spv", "shader/forward_pass.frag.spv")
+			.setBindingDescriptions(PackedVertex::getVertexBindingDescriptions())
+			.setAttributeDescriptions(PackedVertex::getVertexAttributeDescriptions())
 			.build();
 	}
 
-	void EngineForwardPassRenderSystem::render(std::shared_ptr<EngineCommandBuffer> commandBuffer, VkDescriptorSet descriptorSet, std::shared_ptr<EngineVertexModel> model) {
+	void EngineForwardPassRenderSystem::render(std::shared_ptr<EngineCommandBuffer> commandBuffer, VkDescriptorSet descriptorSet, uint32_t uniformOffset, std::shared_ptr<EngineVertexModel> model) {
 		this->pipeline->bind(commandBuffer->getCommandBuffer());
 
 		vkCmdBindDescriptorSets(
@@ -54,11 +57,87 @@ namespace nugiEngine {
 			0,
 			1u,
 			&descriptorSet,
-			0,
-			nullptr
+			1u,
+			&uniformOffset
 		);
 
 		model->bind(commandBuffer);
 		model->draw(commandBuffer);
 	}
+
+	void EngineForwardPassRenderSystem::render(std::shared_ptr<EngineCommandBuffer> commandBuffer, VkDescriptorSet descriptorSet, uint32_t uniformOffset, std::shared_ptr<EngineVertexModel> model, 
+		std::shared_ptr<EngineMeshletModel> meshletModel, uint32_t frameIndex) 
+	{
+		this->pipeline->bind(commandBuffer->getCommandBuffer());
+
+		vkCmdBindDescriptorSets(
+			commandBuffer->getCommandBuffer(),
+			VK_PIPELINE_BIND_POINT_GRAPHICS,
+			this->pipelineLayout,
+			0,
+			1u,
+			&descriptorSet,
+			1u,
+			&uniformOffset
+		);
+
+		model->bind(commandBuffer);
+
+		// Meshlets are split between a 16 and a 32 bit index buffer, draw each width with its buffer bound
+		for (auto &&indexType : { VK_INDEX_TYPE_UINT16, VK_INDEX_TYPE_UINT32 }) {
+			if (!model->hasIndexType(indexType) || meshletModel->getDrawCount(frameIndex, indexType) == 0) {
+				continue;
+			}
+
+			model->bindIndexBuffer(commandBuffer, indexType);
+			meshletModel->draw(commandBuffer, frameIndex, indexType);
+		}
+	}
+
+	std::vector<std::shared_ptr<EngineCommandBuffer>> EngineForwardPassRenderSystem::render(EngineParallelRecorder &recorder, VkCommandBufferInheritanceInfo inheritanceInfo, VkExtent2D extent, 
+		VkDescriptorSet descriptorSet, uint32_t uniformOffset, std::shared_ptr<EngineVertexModel> model, std::shared_ptr<EngineMeshletModel> meshletModel, uint32_t frameIndex) 
+	{
+		// The draw list is every 16 bit draw followed by every 32 bit one, a slice may span both
+		uint32_t draw16Count = model->hasIndexType(VK_INDEX_TYPE_UINT16) ? meshletModel->getDrawCount(frameIndex, VK_INDEX_TYPE_UINT16) : 0u;
+		uint32_t draw32Count = model->hasIndexType(VK_INDEX_TYPE_UINT32) ? meshletModel->getDrawCount(frameIndex, VK_INDEX_TYPE_UINT32) : 0u;
+
+		return recorder.record(draw16Count + draw32Count, inheritanceInfo, 
+			[this, extent, descriptorSet, uniformOffset, model, meshletModel, frameIndex, draw16Count](std::shared_ptr<EngineCommandBuffer> commandBuffer, uint32_t firstDraw, uint32_t drawCount) 
+		{
+			this->pipeline->bind(commandBuffer->getCommandBuffer());
+
+			VkViewport viewport{ 0.0f, 0.0f, static_cast<float>(extent.width), static_cast<float>(extent.height), 0.0f, 1.0f };
+			VkRect2D scissor{ {0, 0}, extent };
+
+			vkCmdSetViewport(commandBuffer->getCommandBuffer(), 0, 1, &viewport);
+			vkCmdSetScissor(commandBuffer->getCommandBuffer(), 0, 1, &scissor);
+
+			vkCmdBindDescriptorSets(
+				commandBuffer->getCommandBuffer(),
+				VK_PIPELINE_BIND_POINT_GRAPHICS,
+				this->pipelineLayout,
+				0,
+				1u,
+				&descriptorSet,
+				1u,
+				&uniformOffset
+			);
+
+			model->bind(commandBuffer);
+
+			uint32_t lastDraw = firstDraw + drawCount;
+
+			if (firstDraw < draw16Count) {
+				model->bindIndexBuffer(commandBuffer, VK_INDEX_TYPE_UINT16);
+				meshletModel->draw(commandBuffer, frameIndex, VK_INDEX_TYPE_UINT16, firstDraw, std::min(lastDraw, draw16Count) - firstDraw);
+			}
+
+			if (lastDraw > draw16Count) {
+				uint32_t first32Draw = std::max(firstDraw, draw16Count) - draw16Count;
+
+				model->bindIndexBuffer(commandBuffer, VK_INDEX_TYPE_UINT32);
+				meshletModel->draw(commandBuffer, frameIndex, VK_INDEX_TYPE_UINT32, first32Draw, lastDraw - draw16Count - first32Draw);
+			}
+		});
+	}
 }
\ No newline at end of file
@@ -1,12 +1,14 @@
 #pragma once
 
 #include "../../vulkan/command/command_buffer.hpp"
+#include "../../vulkan/command/parallel_recorder.hpp"
 #include "../../vulkan/device/device.hpp"
 #include "../../vulkan/pipeline/graphic_pipeline.hpp"
 #include "../../vulkan/buffer/buffer.hpp"
 #include "../../vulkan/descriptor/descriptor.hpp"
 #include "../../vulkan/swap_chain/swap_chain.hpp"
 #include "../data/model/vertex_model.hpp"
+#include "../data/model/meshlet_model.hpp"
 #include "../utils/camera/camera.hpp"
 #include "../general_struct.hpp"
 
@@ -19,7 +21,14 @@ namespace nugiEngine {
 			EngineForwardPassRenderSystem(EngineDevice& device, std::shared_ptr<EngineRenderPass> renderPass, std::shared_ptr<EngineDescriptorSetLayout> descriptorSetLayouts);
 			~EngineForwardPassRenderSystem();
 
-			void render(std::shared_ptr<EngineCommandBuffer> commandBuffer, VkDescriptorSet descriptorSets, std::shared_ptr<EngineVertexModel> model);
+			void render(std::shared_ptr<EngineCommandBuffer> commandBuffer, VkDescriptorSet descriptorSets, uint32_t uniformOffset, std::shared_ptr<EngineVertexModel> model);
+			void render(std::shared_ptr<EngineCommandBuffer> commandBuffer, VkDescriptorSet descriptorSets, uint32_t uniformOffset, std::shared_ptr<EngineVertexModel> model, 
+				std::shared_ptr<EngineMeshletModel> meshletModel, uint32_t frameIndex);
+
+			// Records the meshlet draws of the frame in slices on the recorder threads, the returned secondary command buffers
+			// are executed in order inside the render pass described by inheritanceInfo
+			std::vector<std::shared_ptr<EngineCommandBuffer>> render(EngineParallelRecorder &recorder, VkCommandBufferInheritanceInfo inheritanceInfo, VkExtent2D extent, 
+				VkDescriptorSet descriptorSets, uint32_t uniformOffset, std::shared_ptr<EngineVertexModel> model, std::shared_ptr<EngineMeshletModel> meshletModel, uint32_t frameIndex);
 		
 		private:
 			void createPipelineLayout(std::shared_ptr<EngineDescriptorSetLayout> descriptorSetLayouts);
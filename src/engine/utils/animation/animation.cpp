@@ -0,0 +1,394 @@
+#include "animation.hpp"
+#include "../simd/simd_lanes.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+namespace nugiEngine {
+  uint32_t AnimationClip::addChannel(uint32_t transformIndex, AnimationPath path, Interpolation interpolation,
+    const std::vector<float> &times, const std::vector<glm::vec4> &values)
+  {
+    if (times.empty() || times.size() != values.size()) {
+      throw std::runtime_error("animation channel needs one value for each key time!");
+    }
+
+    std::vector<uint32_t> order(times.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(), [&times](uint32_t a, uint32_t b) { return times[a] < times[b]; });
+
+    AnimationChannel channel{};
+    channel.transformIndex = transformIndex;
+    channel.path = path;
+    channel.interpolation = interpolation;
+    channel.firstKey = static_cast<uint32_t>(this->keyTimes.size());
+    channel.keyCount = static_cast<uint32_t>(times.size());
+
+    for (auto &&index : order) {
+      glm::vec4 value = values[index];
+      if (path == AnimationPath::Rotation) {
+        value = glm::normalize(value);
+      }
+
+      this->keyTimes.emplace_back(times[index]);
+      this->keyValues.emplace_back(value);
+    }
+
+    this->duration = std::max(this->duration, times[order.back()]);
+    this->channels.emplace_back(channel);
+
+    return static_cast<uint32_t>(this->channels.size() - 1);
+  }
+
+  static glm::vec4 multiplyQuaternion(glm::vec4 a, glm::vec4 b) {
+    glm::vec3 aVector{a}, bVector{b};
+    glm::vec3 vector = bVector * a.w + aVector * b.w + glm::cross(aVector, bVector);
+
+    return glm::vec4{ vector, a.w * b.w - glm::dot(aVector, bVector) };
+  }
+
+  glm::vec4 eulerToQuaternion(glm::vec3 rotation) {
+    glm::vec4 x{ std::sin(rotation.x / 2.0f), 0.0f, 0.0f, std::cos(rotation.x / 2.0f) };
+    glm::vec4 y{ 0.0f, std::sin(rotation.y / 2.0f), 0.0f, std::cos(rotation.y / 2.0f) };
+    glm::vec4 z{ 0.0f, 0.0f, std::sin(rotation.z / 2.0f), std::cos(rotation.z / 2.0f) };
+
+    return multiplyQuaternion(multiplyQuaternion(x, y), z);
+  }
+
+  // Rx * Ry * Rz has sin(y) at row 0 column 2, the other two angles come from the rest of row 0 and column 2
+  glm::vec3 quaternionToEuler(glm::vec4 q) {
+    float r00 = 1.0f - 2.0f * (q.y * q.y + q.z * q.z);
+    float r01 = 2.0f * (q.x * q.y - q.w * q.z);
+    float r02 = 2.0f * (q.x * q.z + q.w * q.y);
+    float r11 = 1.0f - 2.0f * (q.x * q.x + q.z * q.z);
+    float r12 = 2.0f * (q.y * q.z - q.w * q.x);
+    float r21 = 2.0f * (q.y * q.z + q.w * q.x);
+    float r22 = 1.0f - 2.0f * (q.x * q.x + q.y * q.y);
+
+    float y = std::asin(glm::clamp(r02, -1.0f, 1.0f));
+
+    // Gimbal lock, x and z turn around the same axis so put everything into x
+    if (std::abs(r02) > 0.99999f) {
+      return glm::vec3{ std::atan2(r21, r11), y, 0.0f };
+    }
+
+    return glm::vec3{ std::atan2(-r12, r22), y, std::atan2(-r01, r00) };
+  }
+
+  // ---------------------- gathered samples ----------------------
+
+  // Weighted sum of up to four keys, used by every translation and scale channel and by step and cubic rotations.
+  // Sized for every channel up front, count is the number actually gathered.
+  struct BlendSamples {
+    std::vector<float> weights[4];
+    std::vector<float> values[4][4];
+    std::vector<float> results[4];
+    std::vector<uint32_t> channels;
+    size_t count = 0;
+
+    void resize(size_t capacity) {
+      for (int key = 0; key < 4; key++) {
+        this->weights[key].resize(capacity);
+        for (int i = 0; i < 4; i++) {
+          this->values[key][i].resize(capacity);
+        }
+
+        this->results[key].resize(capacity);
+      }
+
+      this->channels.resize(capacity);
+    }
+
+    void add(uint32_t channel, const glm::vec4 keys[4], const float keyWeights[4]) {
+      for (int key = 0; key < 4; key++) {
+        this->weights[key][this->count] = keyWeights[key];
+
+        for (int i = 0; i < 4; i++) {
+          this->values[key][i][this->count] = keys[key][i];
+        }
+      }
+
+      this->channels[this->count++] = channel;
+    }
+  };
+
+  // Linear rotations, both quaternions already in the same hemisphere
+  struct SlerpSamples {
+    std::vector<float> from[4];
+    std::vector<float> to[4];
+    std::vector<float> factors;
+    std::vector<float> results[4];
+    std::vector<uint32_t> channels;
+    size_t count = 0;
+
+    void resize(size_t capacity) {
+      for (int i = 0; i < 4; i++) {
+        this->from[i].resize(capacity);
+        this->to[i].resize(capacity);
+        this->results[i].resize(capacity);
+      }
+
+      this->factors.resize(capacity);
+      this->channels.resize(capacity);
+    }
+
+    void add(uint32_t channel, glm::vec4 fromKey, glm::vec4 toKey, float factor) {
+      for (int i = 0; i < 4; i++) {
+        this->from[i][this->count] = fromKey[i];
+        this->to[i][this->count] = toKey[i];
+      }
+
+      this->factors[this->count] = factor;
+      this->channels[this->count++] = channel;
+    }
+  };
+
+  // ---------------------- kernels ----------------------
+
+  template <typename L>
+  void blendBlock(BlendSamples &samples, size_t first) {
+    using F = typename L::Float;
+
+    F weights[4];
+    for (int key = 0; key < 4; key++) {
+      weights[key] = L::load(&samples.weights[key][first]);
+    }
+
+    for (int i = 0; i < 4; i++) {
+      F result = L::mul(weights[0], L::load(&samples.values[0][i][first]));
+      for (int key = 1; key < 4; key++) {
+        result = L::add(result, L::mul(weights[key], L::load(&samples.values[key][i][first])));
+      }
+
+      L::store(&samples.results[i][first], result);
+    }
+  }
+
+  // acos on [0, 1] as sqrt(1 - x) times a polynomial (Abramowitz and Stegun 4.4.46), absolute error below 2e-8
+  template <typename L>
+  typename L::Float acosPositive(typename L::Float x) {
+    auto polynomial = L::set(-0.0012624911f);
+    polynomial = L::add(L::mul(polynomial, x), L::set(0.0066700901f));
+    polynomial = L::add(L::mul(polynomial, x), L::set(-0.0170881256f));
+    polynomial = L::add(L::mul(polynomial, x), L::set(0.0308918810f));
+    polynomial = L::add(L::mul(polynomial, x), L::set(-0.0501743046f));
+    polynomial = L::add(L::mul(polynomial, x), L::set(0.0889789874f));
+    polynomial = L::add(L::mul(polynomial, x), L::set(-0.2145988016f));
+    polynomial = L::add(L::mul(polynomial, x), L::set(1.5707963050f));
+
+    return L::mul(L::sqrt(L::sub(L::set(1.0f), x)), polynomial);
+  }
+
+  template <typename L>
+  void slerpBlock(SlerpSamples &samples, size_t first) {
+    using F = typename L::Float;
+
+    F from[4], to[4];
+    for (int i = 0; i < 4; i++) {
+      from[i] = L::load(&samples.from[i][first]);
+      to[i] = L::load(&samples.to[i][first]);
+    }
+
+    F factor = L::load(&samples.factors[first]);
+    F one = L::set(1.0f);
+
+    F cosine = L::mul(from[0], to[0]);
+    for (int i = 1; i < 4; i++) {
+      cosine = L::add(cosine, L::mul(from[i], to[i]));
+    }
+
+    cosine = L::min(L::max(cosine, L::set(0.0f)), one);
+
+    F angle = acosPositive<L>(cosine);
+    F inverseSine = L::div(one, L::sqrt(L::sub(one, L::mul(cosine, cosine))));
+
+    F fromSine, toSine, unusedCosine;
+    L::sinCos(L::mul(L::sub(one, factor), angle), fromSine, unusedCosine);
+    L::sinCos(L::mul(factor, angle), toSine, unusedCosine);
+
+    // Nearly equal keys divide by almost zero, a plain lerp is exact enough there
+    F isNearlyEqual = L::greaterThan(cosine, L::set(0.9995f));
+    F fromWeight = L::select(isNearlyEqual, L::sub(one, factor), L::mul(fromSine, inverseSine));
+    F toWeight = L::select(isNearlyEqual, factor, L::mul(toSine, inverseSine));
+
+    for (int i = 0; i < 4; i++) {
+      L::store(&samples.results[i][first], L::add(L::mul(fromWeight, from[i]), L::mul(toWeight, to[i])));
+    }
+  }
+
+  template <template <typename> class Kernel, typename Samples>
+  void dispatchBlocks(Samples &samples, size_t count) {
+    size_t first = 0;
+
+#if defined(__AVX__)
+    for (; first + AvxLanes::width <= count; first += AvxLanes::width) {
+      Kernel<AvxLanes>::run(samples, first);
+    }
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+    for (; first + SseLanes::width <= count; first += SseLanes::width) {
+      Kernel<SseLanes>::run(samples, first);
+    }
+#endif
+
+    for (; first < count; first++) {
+      Kernel<ScalarLanes>::run(samples, first);
+    }
+  }
+
+  template <typename L>
+  struct BlendKernel {
+    static void run(BlendSamples &samples, size_t first) { blendBlock<L>(samples, first); }
+  };
+
+  template <typename L>
+  struct SlerpKernel {
+    static void run(SlerpSamples &samples, size_t first) { slerpBlock<L>(samples, first); }
+  };
+
+  // ---------------------- evaluation ----------------------
+
+  // Index of the last key at or before time. Playback moves forward a little every frame,
+  // so the cursor and the key after it are tried before searching.
+  static uint32_t findKey(const AnimationClip &clip, const AnimationChannel &channel, uint32_t &cursor, float time) {
+    uint32_t lastKey = channel.firstKey + channel.keyCount - 1;
+    const float *times = clip.keyTimes.data();
+
+    auto isInside = [&](uint32_t key) {
+      return key >= channel.firstKey && key < lastKey && times[key] <= time && time < times[key + 1];
+    };
+
+    if (isInside(cursor)) {
+      return cursor;
+    }
+
+    if (isInside(cursor + 1)) {
+      return ++cursor;
+    }
+
+    const float *found = std::upper_bound(times + channel.firstKey, times + lastKey + 1, time);
+    cursor = static_cast<uint32_t>(std::max(found - times - 1, static_cast<ptrdiff_t>(channel.firstKey)));
+
+    return cursor;
+  }
+
+  std::vector<uint32_t> evaluateAnimation(const AnimationClip &clip, AnimationState &state, float time, bool isLooping,
+    std::vector<TransformComponent> &components)
+  {
+    auto channelCount = static_cast<uint32_t>(clip.channels.size());
+
+    if (state.keyCursors.size() != channelCount) {
+      state.keyCursors.assign(channelCount, 0u);
+
+      for (uint32_t i = 0; i < channelCount; i++) {
+        state.keyCursors[i] = clip.channels[i].firstKey;
+      }
+    }
+
+    if (isLooping && clip.duration > 0.0f) {
+      time = std::fmod(time, clip.duration);
+      time = time < 0.0f ? time + clip.duration : time;
+    }
+
+    BlendSamples blendSamples;
+    SlerpSamples slerpSamples;
+
+    blendSamples.resize(channelCount);
+    slerpSamples.resize(channelCount);
+
+    // Find the keys around time and gather them, so the interpolation itself runs over contiguous arrays
+    for (uint32_t i = 0; i < channelCount; i++) {
+      auto &channel = clip.channels[i];
+
+      uint32_t firstKey = channel.firstKey, lastKey = channel.firstKey + channel.keyCount - 1;
+      uint32_t key = findKey(clip, channel, state.keyCursors[i], time);
+
+      uint32_t keyIndices[4] = { std::max(key, firstKey + 1) - 1, key, std::min(key + 1, lastKey), std::min(key + 2, lastKey) };
+      float factor = 0.0f;
+
+      if (time >= clip.keyTimes[lastKey]) {
+        keyIndices[0] = keyIndices[1] = keyIndices[2] = keyIndices[3] = lastKey;
+      } else if (time > clip.keyTimes[key] && keyIndices[2] != key) {
+        factor = (time - clip.keyTimes[key]) / (clip.keyTimes[keyIndices[2]] - clip.keyTimes[key]);
+      }
+
+      glm::vec4 keys[4];
+      for (int j = 0; j < 4; j++) {
+        keys[j] = clip.keyValues[keyIndices[j]];
+      }
+
+      // q and -q are the same rotation, interpolate along the shorter arc
+      if (channel.path == AnimationPath::Rotation) {
+        keys[0] = glm::dot(keys[0], keys[1]) < 0.0f ? -keys[0] : keys[0];
+        keys[2] = glm::dot(keys[2], keys[1]) < 0.0f ? -keys[2] : keys[2];
+        keys[3] = glm::dot(keys[3], keys[2]) < 0.0f ? -keys[3] : keys[3];
+      }
+
+      if (channel.interpolation == Interpolation::Linear && channel.path == AnimationPath::Rotation) {
+        slerpSamples.add(i, keys[1], keys[2], factor);
+        continue;
+      }
+
+      float weights[4] = { 0.0f, 1.0f, 0.0f, 0.0f };
+
+      if (channel.interpolation == Interpolation::Linear) {
+        weights[1] = 1.0f - factor;
+        weights[2] = factor;
+      } else if (channel.interpolation == Interpolation::Cubic) {
+        float factor2 = factor * factor, factor3 = factor2 * factor;
+
+        weights[0] = 0.5f * (-factor3 + 2.0f * factor2 - factor);
+        weights[1] = 0.5f * (3.0f * factor3 - 5.0f * factor2 + 2.0f);
+        weights[2] = 0.5f * (-3.0f * factor3 + 4.0f * factor2 + factor);
+        weights[3] = 0.5f * (factor3 - factor2);
+      }
+
+      blendSamples.add(i, keys, weights);
+    }
+
+    dispatchBlocks<BlendKernel>(blendSamples, blendSamples.count);
+    dispatchBlocks<SlerpKernel>(slerpSamples, slerpSamples.count);
+
+    std::vector<uint32_t> changedIndices;
+
+    auto writeResult = [&](uint32_t channelIndex, glm::vec4 value) {
+      auto &channel = clip.channels[channelIndex];
+
+      if (channel.transformIndex >= components.size()) {
+        throw std::runtime_error("animation channel transform index is out of range!");
+      }
+
+      auto &component = components[channel.transformIndex];
+      glm::vec3 *target = &component.translation;
+      glm::vec3 result{value};
+
+      if (channel.path == AnimationPath::Scale) {
+        target = &component.scale;
+      } else if (channel.path == AnimationPath::Rotation) {
+        target = &component.rotation;
+        result = quaternionToEuler(glm::normalize(value));
+      }
+
+      // A clamped or paused channel keeps its value, nothing to upload then
+      if (*target != result) {
+        *target = result;
+        changedIndices.emplace_back(channel.transformIndex);
+      }
+    };
+
+    for (size_t i = 0; i < blendSamples.count; i++) {
+      writeResult(blendSamples.channels[i], glm::vec4{ blendSamples.results[0][i], blendSamples.results[1][i], blendSamples.results[2][i], blendSamples.results[3][i] });
+    }
+
+    for (size_t i = 0; i < slerpSamples.count; i++) {
+      writeResult(slerpSamples.channels[i], glm::vec4{ slerpSamples.results[0][i], slerpSamples.results[1][i], slerpSamples.results[2][i], slerpSamples.results[3][i] });
+    }
+
+    std::sort(changedIndices.begin(), changedIndices.end());
+    changedIndices.erase(std::unique(changedIndices.begin(), changedIndices.end()), changedIndices.end());
+
+    return changedIndices;
+  }
+} // namespace nugiEngine
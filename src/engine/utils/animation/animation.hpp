@@ -0,0 +1,62 @@
+#pragma once
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include "../transform/transform.hpp"
+
+#include <vector>
+#include <cstdint>
+
+namespace nugiEngine {
+  enum class AnimationPath : uint32_t {
+    Translation,
+    Scale,
+    Rotation
+  };
+
+  enum class Interpolation : uint32_t {
+    Step,
+    Linear, // slerp for rotation
+    Cubic   // Catmull-Rom through the neighbouring keys, renormalized for rotation
+  };
+
+  // One animated property of one transform. Its keys are keyCount consecutive entries starting at firstKey.
+  struct AnimationChannel {
+    uint32_t transformIndex = 0;
+    AnimationPath path = AnimationPath::Translation;
+    Interpolation interpolation = Interpolation::Linear;
+
+    uint32_t firstKey = 0;
+    uint32_t keyCount = 0;
+  };
+
+  // Keys of every channel in shared arrays, each channel sorted by time. Times are kept apart from the values
+  // so the key search only walks floats. Rotation keys are quaternions (x, y, z, w), translation and scale keys leave w at zero.
+  struct AnimationClip {
+    std::vector<AnimationChannel> channels;
+
+    std::vector<float> keyTimes;
+    std::vector<glm::vec4> keyValues;
+
+    float duration = 0.0f;
+
+    uint32_t addChannel(uint32_t transformIndex, AnimationPath path, Interpolation interpolation,
+      const std::vector<float> &times, const std::vector<glm::vec4> &values);
+  };
+
+  // Per instance playback state, the last key of every channel is kept so a playing clip finds its keys without searching
+  struct AnimationState {
+    std::vector<uint32_t> keyCursors;
+  };
+
+  // Rotation order of TransformComponent, R = Rx * Ry * Rz
+  glm::vec4 eulerToQuaternion(glm::vec3 rotation);
+  glm::vec3 quaternionToEuler(glm::vec4 quaternion);
+
+  // Sample every channel at time (wrapped into the clip when looping) and write the result into the target components.
+  // Returns the sorted indices of the changed components, for EngineTransformationModel::update.
+  std::vector<uint32_t> evaluateAnimation(const AnimationClip &clip, AnimationState &state, float time, bool isLooping,
+    std::vector<TransformComponent> &components);
+} // namespace nugiEngine
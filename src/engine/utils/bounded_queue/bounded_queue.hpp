@@ -0,0 +1,87 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+namespace nugiEngine {
+  // Multi producer multi consumer FIFO with fixed capacity. Producers block while it is full,
+  // which is what throttles a fast stage feeding a slow one. After close() every blocked call returns false.
+  template <typename T>
+  class BoundedQueue {
+    public:
+      explicit BoundedQueue(size_t capacity) : capacity{capacity} {}
+
+      BoundedQueue(const BoundedQueue&) = delete;
+      BoundedQueue& operator = (const BoundedQueue&) = delete;
+
+      bool push(T item) {
+        std::unique_lock<std::mutex> lock{this->mutex};
+        this->notFull.wait(lock, [this]() { return this->isClosed || this->items.size() < this->capacity; });
+
+        if (this->isClosed) {
+          return false;
+        }
+
+        this->items.emplace_back(std::move(item));
+        lock.unlock();
+
+        this->notEmpty.notify_one();
+        return true;
+      }
+
+      bool pop(T &item) {
+        std::unique_lock<std::mutex> lock{this->mutex};
+        this->notEmpty.wait(lock, [this]() { return this->isClosed || !this->items.empty(); });
+
+        if (this->isClosed) {
+          return false;
+        }
+
+        item = std::move(this->items.front());
+        this->items.pop_front();
+        lock.unlock();
+
+        this->notFull.notify_one();
+        return true;
+      }
+
+      bool tryPop(T &item) {
+        std::unique_lock<std::mutex> lock{this->mutex};
+
+        if (this->isClosed || this->items.empty()) {
+          return false;
+        }
+
+        item = std::move(this->items.front());
+        this->items.pop_front();
+        lock.unlock();
+
+        this->notFull.notify_one();
+        return true;
+      }
+
+      void close() {
+        {
+          std::lock_guard<std::mutex> lock{this->mutex};
+          this->isClosed = true;
+        }
+
+        this->notFull.notify_all();
+        this->notEmpty.notify_all();
+      }
+
+      size_t size() {
+        std::lock_guard<std::mutex> lock{this->mutex};
+        return this->items.size();
+      }
+
+    private:
+      std::mutex mutex;
+      std::condition_variable notFull, notEmpty;
+      std::deque<T> items;
+
+      size_t capacity;
+      bool isClosed = false;
+  };
+} // namespace nugiEngine
@@ -28,11 +28,11 @@ namespace nugiEngine
 				int vertexIndex1 = shape.mesh.indices[3 * i + 1].vertex_index;
 				int vertexIndex2 = shape.mesh.indices[3 * i + 2].vertex_index;
 
-				/* int textCoordIndex0 = shape.mesh.indices[3 * i + 0].texcoord_index;
+				int textCoordIndex0 = shape.mesh.indices[3 * i + 0].texcoord_index;
 				int textCoordIndex1 = shape.mesh.indices[3 * i + 1].texcoord_index;
 				int textCoordIndex2 = shape.mesh.indices[3 * i + 2].texcoord_index;
 
-				int normalIndex0 = shape.mesh.indices[3 * i + 0].normal_index;
+				/* int normalIndex0 = shape.mesh.indices[3 * i + 0].normal_index;
 				int normalIndex1 = shape.mesh.indices[3 * i + 1].normal_index;
 				int normalIndex2 = shape.mesh.indices[3 * i + 2].normal_index; */
 
@@ -82,26 +82,23 @@ namespace nugiEngine
           1.0f
 				}; */
 
-				/* vertex0.textCoord = glm::vec4{
-					attrib.texcoords[2 * textCoordIndex0 + 0],
-					1.0f - attrib.texcoords[2 * textCoordIndex0 + 1],
-          1.0f,
-          1.0f
-				};
-
-				vertex1.textCoord = glm::vec4{
-					attrib.texcoords[2 * textCoordIndex1 + 0],
-					1.0f - attrib.texcoords[2 * textCoordIndex1 + 1],
-          1.0f,
-          1.0f
-				};
-
-				vertex2.textCoord = glm::vec4{
-					attrib.texcoords[2 * textCoordIndex2 + 0],
-					1.0f - attrib.texcoords[2 * textCoordIndex2 + 1],
-          1.0f,
-          1.0f
-				}; */
+				// Faces without texture coordinate keep the default of zero
+				if (textCoordIndex0 >= 0 && textCoordIndex1 >= 0 && textCoordIndex2 >= 0) {
+					vertex0.textCoord = glm::vec2{
+						attrib.texcoords[2 * textCoordIndex0 + 0],
+						1.0f - attrib.texcoords[2 * textCoordIndex0 + 1]
+					};
+
+					vertex1.textCoord = glm::vec2{
+						attrib.texcoords[2 * textCoordIndex1 + 0],
+						1.0f - attrib.texcoords[2 * textCoordIndex1 + 1]
+					};
+
+					vertex2.textCoord = glm::vec2{
+						attrib.texcoords[2 * textCoordIndex2 + 0],
+						1.0f - attrib.texcoords[2 * textCoordIndex2 + 1]
+					};
+				}
 
 				vertex0.transformIndex = transformIndex;
 				vertex1.transformIndex = transformIndex;
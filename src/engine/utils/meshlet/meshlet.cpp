@@ -0,0 +1,374 @@
+#include "meshlet.hpp"
+
+#include <cfloat>
+#include <cmath>
+#include <map>
+
+namespace nugiEngine {
+  void computeMeshletBounds(Meshlet &meshlet, const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices) {
+    glm::vec3 minimum{FLT_MAX};
+    glm::vec3 maximum{-FLT_MAX};
+
+    for (uint32_t i = meshlet.firstIndex; i < meshlet.firstIndex + meshlet.indexCount; i++) {
+      glm::vec3 position = glm::vec3(vertices[indices[i]].position);
+
+      minimum = glm::min(minimum, position);
+      maximum = glm::max(maximum, position);
+    }
+
+    meshlet.center = (maximum + minimum) / 2.0f;
+    meshlet.radius = 0.0f;
+
+    for (uint32_t i = meshlet.firstIndex; i < meshlet.firstIndex + meshlet.indexCount; i++) {
+      meshlet.radius = glm::max(meshlet.radius, glm::length(glm::vec3(vertices[indices[i]].position) - meshlet.center));
+    }
+
+    // Normal cone: average the triangle normals, then find the widest deviation from the average
+    std::vector<glm::vec3> normals;
+    glm::vec3 normalSum{0.0f};
+
+    for (uint32_t i = meshlet.firstIndex; i < meshlet.firstIndex + meshlet.indexCount; i += 3) {
+      glm::vec3 p0 = glm::vec3(vertices[indices[i + 0]].position);
+      glm::vec3 p1 = glm::vec3(vertices[indices[i + 1]].position);
+      glm::vec3 p2 = glm::vec3(vertices[indices[i + 2]].position);
+
+      glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+      float area = glm::length(normal);
+
+      if (area <= FLT_EPSILON) {
+        continue;
+      }
+
+      normals.emplace_back(normal / area);
+      normalSum += normal / area;
+    }
+
+    meshlet.coneAxis = glm::vec3{0.0f};
+    meshlet.coneCutoff = 1.0f;
+
+    if (normals.empty() || glm::length(normalSum) <= FLT_EPSILON) {
+      return;
+    }
+
+    meshlet.coneAxis = glm::normalize(normalSum);
+
+    float minDot = 1.0f;
+    for (auto &&normal : normals) {
+      minDot = glm::min(minDot, glm::dot(normal, meshlet.coneAxis));
+    }
+
+    // Cone wider than 90 degree can't prove that the whole meshlet faces away
+    if (minDot > 0.0f) {
+      meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+    }
+  }
+
+  MeshletData createMeshlets(std::shared_ptr<std::vector<Vertex>> vertices, std::shared_ptr<std::vector<uint32_t>> indices, uint32_t maxVertices, uint32_t maxTriangles) {
+    auto meshlets = std::make_shared<std::vector<Meshlet>>();
+    auto reorderedIndices = std::make_shared<std::vector<uint32_t>>();
+    reorderedIndices->reserve(indices->size());
+
+    // Which meshlet has used the vertex last, so uniqueness check is O(1) without clearing per meshlet
+    std::vector<uint32_t> vertexOwner(vertices->size(), UINT32_MAX);
+
+    Meshlet current{};
+    uint32_t meshletId = 0;
+
+    auto flush = [&]() {
+      if (current.indexCount == 0) {
+        return;
+      }
+
+      computeMeshletBounds(current, *vertices, *reorderedIndices);
+      meshlets->emplace_back(current);
+
+      meshletId++;
+      current = Meshlet{};
+      current.firstIndex = static_cast<uint32_t>(reorderedIndices->size());
+    };
+
+    uint32_t triangleCount = static_cast<uint32_t>(indices->size()) / 3;
+
+    for (uint32_t i = 0; i < triangleCount; i++) {
+      uint32_t triangle[3] = { (*indices)[3 * i + 0], (*indices)[3 * i + 1], (*indices)[3 * i + 2] };
+      uint32_t transformIndex = (*vertices)[triangle[0]].transformIndex;
+      uint32_t materialIndex = (*vertices)[triangle[0]].materialIndex;
+
+      uint32_t newVertexCount = 0;
+      for (uint32_t j = 0; j < 3; j++) {
+        bool isDuplicated = (j > 0 && triangle[j] == triangle[0]) || (j > 1 && triangle[j] == triangle[1]);
+        if (vertexOwner[triangle[j]] != meshletId && !isDuplicated) {
+          newVertexCount++;
+        }
+      }
+
+      bool isFull = current.vertexCount + newVertexCount > maxVertices || current.indexCount / 3 + 1 > maxTriangles;
+      bool isOtherDraw = current.indexCount > 0 && (current.transformIndex != transformIndex || current.materialIndex != materialIndex);
+
+      if (isFull || isOtherDraw) {
+        flush();
+      }
+
+      current.transformIndex = transformIndex;
+      current.materialIndex = materialIndex;
+
+      for (uint32_t j = 0; j < 3; j++) {
+        if (vertexOwner[triangle[j]] != meshletId) {
+          vertexOwner[triangle[j]] = meshletId;
+          current.vertexCount++;
+        }
+
+        reorderedIndices->emplace_back(triangle[j]);
+      }
+
+      current.indexCount += 3;
+    }
+
+    flush();
+    return MeshletData{ meshlets, reorderedIndices, std::make_shared<std::vector<MeshletLodGroup>>() };
+  }
+
+  MeshletData createLodMeshlets(std::shared_ptr<std::vector<Vertex>> vertices, std::shared_ptr<std::vector<uint32_t>> indices, 
+    uint32_t lodLevel, uint32_t maxVertices, uint32_t maxTriangles) 
+  {
+    std::map<uint32_t, std::shared_ptr<std::vector<uint32_t>>> meshIndices;
+
+    for (size_t i = 0; i + 2 < indices->size(); i += 3) {
+      auto &mesh = meshIndices[(*vertices)[(*indices)[i]].transformIndex];
+      if (mesh == nullptr) {
+        mesh = std::make_shared<std::vector<uint32_t>>();
+      }
+
+      mesh->insert(mesh->end(), indices->begin() + i, indices->begin() + i + 3);
+    }
+
+    auto lodGroups = std::make_shared<std::vector<MeshletLodGroup>>();
+    uint32_t levelCount = 0;
+
+    for (auto &&mesh : meshIndices) {
+      MeshletLodGroup lodGroup{};
+      lodGroup.transformIndex = mesh.first;
+      lodGroup.lods = generateLodChain(*vertices, mesh.second, 0, lodLevel);
+
+      glm::vec3 minimum{FLT_MAX};
+      glm::vec3 maximum{-FLT_MAX};
+
+      for (auto &&index : *mesh.second) {
+        minimum = glm::min(minimum, glm::vec3((*vertices)[index].position));
+        maximum = glm::max(maximum, glm::vec3((*vertices)[index].position));
+      }
+
+      lodGroup.center = (maximum + minimum) / 2.0f;
+      for (auto &&index : *mesh.second) {
+        lodGroup.radius = glm::max(lodGroup.radius, glm::length(glm::vec3((*vertices)[index].position) - lodGroup.center));
+      }
+
+      levelCount = glm::max(levelCount, static_cast<uint32_t>(lodGroup.lods.size()));
+      lodGroups->emplace_back(lodGroup);
+    }
+
+    auto meshlets = std::make_shared<std::vector<Meshlet>>();
+    auto reorderedIndices = std::make_shared<std::vector<uint32_t>>();
+
+    for (uint32_t level = 0; level < levelCount; level++) {
+      auto levelIndices = std::make_shared<std::vector<uint32_t>>();
+
+      for (auto &&lodGroup : *lodGroups) {
+        if (level < lodGroup.lods.size()) {
+          levelIndices->insert(levelIndices->end(), lodGroup.lods[level].indices->begin(), lodGroup.lods[level].indices->end());
+        }
+      }
+
+      auto levelData = createMeshlets(vertices, levelIndices, maxVertices, maxTriangles);
+      auto firstIndex = static_cast<uint32_t>(reorderedIndices->size());
+
+      for (auto &&meshlet : *levelData.meshlets) {
+        meshlet.firstIndex += firstIndex;
+        meshlet.lodLevel = level;
+
+        meshlets->emplace_back(meshlet);
+      }
+
+      reorderedIndices->insert(reorderedIndices->end(), levelData.indices->begin(), levelData.indices->end());
+    }
+
+    for (auto &&lodGroup : *lodGroups) {
+      for (auto &&lod : lodGroup.lods) {
+        lod.indices = nullptr;
+      }
+    }
+
+    return MeshletData{ meshlets, reorderedIndices, lodGroups };
+  }
+
+  std::vector<uint32_t> selectMeshletLodLevels(const std::vector<MeshletLodGroup> &lodGroups, const std::vector<Transformation> &transformations,
+    glm::vec3 cameraPosition, float projectionScale, float maxPixelError)
+  {
+    std::vector<uint32_t> lodLevels(transformations.size(), 0u);
+
+    for (auto &&lodGroup : lodGroups) {
+      auto &transformation = transformations[lodGroup.transformIndex];
+      glm::vec3 center = transformation.transformPoint(lodGroup.center);
+
+      float maxScale = glm::max(glm::max(glm::length(transformation.transformDir(glm::vec3(1.0f, 0.0f, 0.0f))),
+        glm::length(transformation.transformDir(glm::vec3(0.0f, 1.0f, 0.0f)))), glm::length(transformation.transformDir(glm::vec3(0.0f, 0.0f, 1.0f))));
+
+      // Distance to the nearest point of the sphere, back in object space where the errors were measured
+      float distance = glm::max(glm::length(center - cameraPosition) - lodGroup.radius * maxScale, 0.0f) / glm::max(maxScale, FLT_EPSILON);
+      lodLevels[lodGroup.transformIndex] = selectLodLevel(lodGroup.lods, distance, projectionScale, maxPixelError);
+    }
+
+    return lodLevels;
+  }
+
+  MeshletIndices splitIndexWidth(const std::vector<uint32_t> &indices, std::vector<Meshlet> &meshlets) {
+    const uint32_t maxIndex16 = UINT16_MAX;
+
+    auto indices16 = std::make_shared<std::vector<uint16_t>>();
+    auto indices32 = std::make_shared<std::vector<uint32_t>>();
+
+    std::vector<uint32_t> meshletMinimums(meshlets.size(), UINT32_MAX);
+    std::vector<uint32_t> meshletMaximums(meshlets.size(), 0u);
+
+    for (size_t i = 0; i < meshlets.size(); i++) {
+      for (uint32_t j = meshlets[i].firstIndex; j < meshlets[i].firstIndex + meshlets[i].indexCount; j++) {
+        meshletMinimums[i] = glm::min(meshletMinimums[i], indices[j]);
+        meshletMaximums[i] = glm::max(meshletMaximums[i], indices[j]);
+      }
+    }
+
+    // First pass groups neighbouring meshlets into windows, so every meshlet in a window gets the same base vertex
+    std::vector<uint32_t> bases(meshlets.size(), 0u);
+    size_t windowStart = 0;
+    uint32_t windowMinimum = UINT32_MAX, windowMaximum = 0u;
+
+    auto closeWindow = [&](size_t windowEnd) {
+      for (size_t i = windowStart; i < windowEnd; i++) {
+        bases[i] = windowMinimum;
+      }
+
+      windowStart = windowEnd;
+      windowMinimum = UINT32_MAX;
+      windowMaximum = 0u;
+    };
+
+    for (size_t i = 0; i < meshlets.size(); i++) {
+      uint32_t minimum = glm::min(windowMinimum, meshletMinimums[i]);
+      uint32_t maximum = glm::max(windowMaximum, meshletMaximums[i]);
+
+      if (i > windowStart && maximum - minimum > maxIndex16) {
+        closeWindow(i);
+
+        minimum = meshletMinimums[i];
+        maximum = meshletMaximums[i];
+      }
+
+      windowMinimum = minimum;
+      windowMaximum = maximum;
+    }
+
+    closeWindow(meshlets.size());
+
+    for (size_t i = 0; i < meshlets.size(); i++) {
+      auto &meshlet = meshlets[i];
+      uint32_t firstIndex = meshlet.firstIndex;
+
+      // Meshlet alone spans too many vertices, keep it at full width
+      if (meshletMaximums[i] - bases[i] > maxIndex16) {
+        meshlet.indexType = VK_INDEX_TYPE_UINT32;
+        meshlet.vertexOffset = 0;
+        meshlet.firstIndex = static_cast<uint32_t>(indices32->size());
+
+        indices32->insert(indices32->end(), indices.begin() + firstIndex, indices.begin() + firstIndex + meshlet.indexCount);
+        continue;
+      }
+
+      meshlet.indexType = VK_INDEX_TYPE_UINT16;
+      meshlet.vertexOffset = static_cast<int32_t>(bases[i]);
+      meshlet.firstIndex = static_cast<uint32_t>(indices16->size());
+
+      for (uint32_t j = firstIndex; j < firstIndex + meshlet.indexCount; j++) {
+        indices16->emplace_back(static_cast<uint16_t>(indices[j] - bases[i]));
+      }
+    }
+
+    return MeshletIndices{ indices16, indices32 };
+  }
+
+  Frustum extractFrustum(glm::mat4 viewProjection) {
+    glm::vec4 rows[4];
+    for (int i = 0; i < 4; i++) {
+      rows[i] = glm::vec4{ viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i] };
+    }
+
+    // Depth range is zero to one, so the near plane is just the third row
+    Frustum frustum{};
+    frustum.planes[0] = rows[3] + rows[0];
+    frustum.planes[1] = rows[3] - rows[0];
+    frustum.planes[2] = rows[3] + rows[1];
+    frustum.planes[3] = rows[3] - rows[1];
+    frustum.planes[4] = rows[2];
+    frustum.planes[5] = rows[3] - rows[2];
+
+    for (int i = 0; i < 6; i++) {
+      frustum.planes[i] = frustum.planes[i] / glm::length(glm::vec3(frustum.planes[i]));
+    }
+
+    return frustum;
+  }
+
+  bool isMeshletVisible(const Meshlet &meshlet, const Transformation &transformation, const Frustum &frustum, glm::vec3 cameraPosition, bool isConeCullingEnabled) {
+    glm::vec3 center = transformation.transformPoint(meshlet.center);
+
+    float maxScale = glm::max(glm::max(glm::length(transformation.transformDir(glm::vec3(1.0f, 0.0f, 0.0f))),
+      glm::length(transformation.transformDir(glm::vec3(0.0f, 1.0f, 0.0f)))), glm::length(transformation.transformDir(glm::vec3(0.0f, 0.0f, 1.0f))));
+    float radius = meshlet.radius * maxScale;
+
+    for (int i = 0; i < 6; i++) {
+      if (glm::dot(glm::vec3(frustum.planes[i]), center) + frustum.planes[i].w < -radius) {
+        return false;
+      }
+    }
+
+    if (isConeCullingEnabled && meshlet.coneCutoff < 1.0f) {
+      glm::vec3 axis = glm::normalize(transformation.transformNormal(meshlet.coneAxis));
+      glm::vec3 view = center - cameraPosition;
+
+      if (glm::dot(view, axis) >= meshlet.coneCutoff * glm::length(view) + radius) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  MeshletDrawCommands cullMeshlets(const std::vector<Meshlet> &meshlets, const std::vector<Transformation> &transformations,
+    const std::vector<uint32_t> &lodLevels, const Frustum &frustum, glm::vec3 cameraPosition, bool isConeCullingEnabled)
+  {
+    MeshletDrawCommands drawCommands{};
+
+    for (auto &&meshlet : meshlets) {
+      uint32_t lodLevel = lodLevels.empty() ? 0u : lodLevels[meshlet.transformIndex];
+      if (meshlet.lodLevel != lodLevel) {
+        continue;
+      }
+
+      if (!isMeshletVisible(meshlet, transformations[meshlet.transformIndex], frustum, cameraPosition, isConeCullingEnabled)) {
+        continue;
+      }
+
+      auto &commands = meshlet.indexType == VK_INDEX_TYPE_UINT16 ? drawCommands.commands16 : drawCommands.commands32;
+
+      if (!commands.empty() && commands.back().firstIndex + commands.back().indexCount == meshlet.firstIndex
+        && commands.back().firstInstance == meshlet.drawIndex && commands.back().vertexOffset == meshlet.vertexOffset)
+      {
+        commands.back().indexCount += meshlet.indexCount;
+        continue;
+      }
+
+      commands.emplace_back(VkDrawIndexedIndirectCommand{ meshlet.indexCount, 1u, meshlet.firstIndex, meshlet.vertexOffset, meshlet.drawIndex });
+    }
+
+    return drawCommands;
+  }
+} // namespace nugiEngine
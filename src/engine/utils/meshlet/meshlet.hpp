@@ -0,0 +1,98 @@
+#pragma once
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include "../../general_struct.hpp"
+#include "../simplify/simplify.hpp"
+
+#include <vector>
+#include <memory>
+
+namespace nugiEngine {
+  const uint32_t maxMeshletVertices = 64;
+  const uint32_t maxMeshletTriangles = 124;
+
+  // A cluster of triangles occupying a contiguous range of the (reordered) index buffer.
+  // Bounds are in object space, the culler moves them to world space using transformIndex.
+  struct Meshlet {
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+    uint32_t vertexCount = 0;
+    uint32_t transformIndex = 0;
+    uint32_t materialIndex = 0;
+    uint32_t drawIndex = 0; // DrawData used by the meshlet, passed as firstInstance (see packVertices)
+
+    VkIndexType indexType = VK_INDEX_TYPE_UINT32; // which index buffer firstIndex points into (see splitIndexWidth)
+    int32_t vertexOffset = 0; // added to every index, lets 16 bit indices address a window of a larger vertex buffer
+
+    glm::vec3 center{0.0f};
+    float radius = 0.0f;
+
+    glm::vec3 coneAxis{0.0f};
+    float coneCutoff = 1.0f; // 1.0 means the cone is too wide to be used for backface culling
+
+    uint32_t lodLevel = 0; // level of detail of its mesh the meshlet was built from (see createLodMeshlets)
+  };
+
+  // LOD chain of one mesh, every vertex sharing transformIndex. The bounding sphere is in object space.
+  // Only the errors are kept, the indices of each level live in the meshlets built from it.
+  struct MeshletLodGroup {
+    uint32_t transformIndex = 0;
+    glm::vec3 center{0.0f};
+    float radius = 0.0f;
+
+    std::vector<MeshLod> lods;
+  };
+
+  struct MeshletData {
+    std::shared_ptr<std::vector<Meshlet>> meshlets;
+    std::shared_ptr<std::vector<uint32_t>> indices; // indices reordered so every meshlet is contiguous
+    std::shared_ptr<std::vector<MeshletLodGroup>> lodGroups; // empty unless built by createLodMeshlets
+  };
+
+  struct MeshletIndices {
+    std::shared_ptr<std::vector<uint16_t>> indices16;
+    std::shared_ptr<std::vector<uint32_t>> indices32;
+  };
+
+  struct MeshletDrawCommands {
+    std::vector<VkDrawIndexedIndirectCommand> commands16;
+    std::vector<VkDrawIndexedIndirectCommand> commands32;
+  };
+
+  // Plane equations (xyz = normal pointing inside, w = distance) in world space.
+  struct Frustum {
+    glm::vec4 planes[6];
+  };
+
+  // Split the triangles into meshlets. A meshlet never mixes vertices with different transform or material index,
+  // so it can be culled with a single matrix and drawn with a single DrawData.
+  MeshletData createMeshlets(std::shared_ptr<std::vector<Vertex>> vertices, std::shared_ptr<std::vector<uint32_t>> indices,
+    uint32_t maxVertices = maxMeshletVertices, uint32_t maxTriangles = maxMeshletTriangles);
+
+  // Generate the LOD chain of every mesh, then split every level into meshlets tagged with it. All levels share the
+  // vertex buffer and follow each other in the index buffer, level 0 first.
+  MeshletData createLodMeshlets(std::shared_ptr<std::vector<Vertex>> vertices, std::shared_ptr<std::vector<uint32_t>> indices,
+    uint32_t lodLevel = maxLodLevel, uint32_t maxVertices = maxMeshletVertices, uint32_t maxTriangles = maxMeshletTriangles);
+
+  // Pick the level of every LOD group from its distance to the camera, indexed by transform index.
+  // projectionScale is projection[1][1] * viewport height / 2, see selectLodLevel.
+  std::vector<uint32_t> selectMeshletLodLevels(const std::vector<MeshletLodGroup> &lodGroups, const std::vector<Transformation> &transformations,
+    glm::vec3 cameraPosition, float projectionScale, float maxPixelError = 1.0f);
+
+  // Move every meshlet whose vertices fit in a 65536 wide window to a 16 bit index buffer, relative to vertexOffset.
+  // Neighbouring meshlets share the window while they can, so the culler is still able to merge their draws.
+  // The rest stays in a 32 bit index buffer. Meshlet firstIndex is rewritten to point into its new buffer.
+  MeshletIndices splitIndexWidth(const std::vector<uint32_t> &indices, std::vector<Meshlet> &meshlets);
+
+  Frustum extractFrustum(glm::mat4 viewProjection);
+
+  // Test every meshlet of the selected LOD level of its mesh against the frustum (and the normal cone if requested), then emit
+  // one draw command for each run of visible meshlets that are adjacent in the index buffer and share the same DrawData and vertex offset.
+  // Commands are separated by index width, since each width is drawn with its own index buffer bound.
+  // lodLevels is indexed by transform index, when empty only level 0 is drawn.
+  MeshletDrawCommands cullMeshlets(const std::vector<Meshlet> &meshlets, const std::vector<Transformation> &transformations,
+    const std::vector<uint32_t> &lodLevels, const Frustum &frustum, glm::vec3 cameraPosition, bool isConeCullingEnabled);
+} // namespace nugiEngine
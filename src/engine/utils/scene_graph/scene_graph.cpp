@@ -0,0 +1,291 @@
+#include "scene_graph.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace nugiEngine {
+  // Workers meet here after each level, nobody starts a level before its parents are written
+  class LevelBarrier {
+    public:
+      explicit LevelBarrier(uint32_t count) : count{count} {}
+
+      void wait() {
+        std::unique_lock<std::mutex> lock{this->mutex};
+        uint32_t generation = this->generation;
+
+        if (++this->arrived == this->count) {
+          this->arrived = 0;
+          this->generation++;
+
+          lock.unlock();
+          this->released.notify_all();
+
+          return;
+        }
+
+        this->released.wait(lock, [this, generation]() { return this->generation != generation; });
+      }
+
+    private:
+      std::mutex mutex;
+      std::condition_variable released;
+
+      uint32_t count;
+      uint32_t arrived = 0;
+      uint32_t generation = 0;
+  };
+
+  // Both matrices are stored as rows, so the product is a weighted sum of the rows of the right hand side.
+  // The world inverse is the local inverse followed by the parent inverse.
+  static Transformation combineTransformation(const Transformation &parent, const Transformation &local) {
+    Transformation result;
+
+    for (int row = 0; row < 3; row++) {
+      glm::vec4 parentRow = parent.pointMatrix[row];
+      result.pointMatrix[row] = local.pointMatrix[0] * parentRow.x + local.pointMatrix[1] * parentRow.y
+        + local.pointMatrix[2] * parentRow.z + glm::vec4(0.0f, 0.0f, 0.0f, parentRow.w);
+
+      glm::vec4 localInverseRow = local.pointInverseMatrix[row];
+      result.pointInverseMatrix[row] = parent.pointInverseMatrix[0] * localInverseRow.x + parent.pointInverseMatrix[1] * localInverseRow.y
+        + parent.pointInverseMatrix[2] * localInverseRow.z + glm::vec4(0.0f, 0.0f, 0.0f, localInverseRow.w);
+    }
+
+    return result;
+  }
+
+  // Center and half extent form, the world extent along an axis is the absolute row of the linear part times the local extent
+  static Aabb transformBounds(const Transformation &transformation, glm::vec3 minimum, glm::vec3 maximum) {
+    glm::vec3 center = transformation.transformPoint((maximum + minimum) / 2.0f);
+    glm::vec3 extent = (maximum - minimum) / 2.0f;
+    glm::vec3 worldExtent;
+
+    for (int row = 0; row < 3; row++) {
+      worldExtent[row] = glm::dot(glm::abs(glm::vec3(transformation.pointMatrix[row])), extent);
+    }
+
+    Aabb bounds;
+    bounds.min = center - worldExtent;
+    bounds.max = center + worldExtent;
+
+    return bounds;
+  }
+
+  SceneGraph::SceneGraph(const std::vector<SceneNode> &nodes, uint32_t workerCount) : workerCount{std::max(workerCount, 1u)} {
+    auto nodeCount = static_cast<uint32_t>(nodes.size());
+
+    std::vector<std::vector<uint32_t>> children(nodeCount);
+    std::vector<uint32_t> order;
+    order.reserve(nodeCount);
+
+    for (uint32_t i = 0; i < nodeCount; i++) {
+      if (nodes[i].parent == noParentNode) {
+        order.emplace_back(i);
+      } else if (nodes[i].parent >= nodeCount) {
+        throw std::runtime_error("scene node parent is out of range!");
+      } else {
+        children[nodes[i].parent].emplace_back(i);
+      }
+    }
+
+    // Breadth first, one level at a time so the level boundaries fall out of the traversal
+    this->levelOffsets.emplace_back(0u);
+
+    for (uint32_t levelStart = 0; levelStart < order.size();) {
+      auto levelEnd = static_cast<uint32_t>(order.size());
+
+      for (uint32_t i = levelStart; i < levelEnd; i++) {
+        order.insert(order.end(), children[order[i]].begin(), children[order[i]].end());
+      }
+
+      this->levelOffsets.emplace_back(levelEnd);
+      levelStart = levelEnd;
+    }
+
+    if (order.size() != nodeCount) {
+      throw std::runtime_error("scene graph has a cycle!");
+    }
+
+    this->sortedPositions.resize(nodeCount);
+    for (uint32_t i = 0; i < nodeCount; i++) {
+      this->sortedPositions[order[i]] = i;
+    }
+
+    this->parents.resize(nodeCount);
+    this->transformIndices.resize(nodeCount);
+    this->locals.resize(nodeCount);
+
+    for (uint32_t i = 0; i < nodeCount; i++) {
+      auto &node = nodes[order[i]];
+
+      this->parents[i] = node.parent == noParentNode ? noParentNode : this->sortedPositions[node.parent];
+      this->transformIndices[i] = node.transformIndex;
+      this->locals[i] = node.local;
+    }
+
+    this->localTransformations.resize(nodeCount);
+    this->worldTransformations.resize(nodeCount);
+    this->worldBounds.resize(nodeCount);
+
+    // The first update evaluates everything
+    this->dirtyFlags.assign(nodeCount, 1u);
+    this->dirtyLocals.resize(nodeCount);
+
+    for (uint32_t i = 0; i < nodeCount; i++) {
+      this->dirtyLocals[i] = i;
+    }
+
+    // Smaller graphs never split a level, they would only keep idle threads around
+    if (this->workerCount > 1 && nodeCount >= parallelLevelSize) {
+      this->levelBarrier = std::make_unique<LevelBarrier>(this->workerCount);
+
+      for (uint32_t i = 1; i < this->workerCount; i++) {
+        this->workers.emplace_back(&SceneGraph::runWorker, this, i);
+      }
+    }
+  }
+
+  SceneGraph::~SceneGraph() {
+    {
+      std::lock_guard<std::mutex> lock{this->mutex};
+      this->isStopping = true;
+    }
+
+    this->jobCondition.notify_all();
+
+    for (auto &&worker : this->workers) {
+      worker.join();
+    }
+  }
+
+  void SceneGraph::setLocal(uint32_t node, const TransformComponent &local) {
+    uint32_t position = this->sortedPositions[node];
+    this->locals[position] = local;
+
+    if (!this->dirtyFlags[position]) {
+      this->dirtyFlags[position] = 1u;
+      this->dirtyLocals.emplace_back(position);
+    }
+  }
+
+  void SceneGraph::evaluateLocals() {
+    TransformBatch batch;
+    batch.resize(this->dirtyLocals.size());
+
+    for (size_t i = 0; i < this->dirtyLocals.size(); i++) {
+      batch.set(i, this->locals[this->dirtyLocals[i]]);
+    }
+
+    std::vector<Transformation> evaluated;
+    evaluateTransforms(batch, evaluated);
+
+    for (size_t i = 0; i < this->dirtyLocals.size(); i++) {
+      this->localTransformations[this->dirtyLocals[i]] = evaluated[i];
+    }
+
+    this->dirtyLocals.clear();
+  }
+
+  void SceneGraph::propagateRange(uint32_t first, uint32_t last) {
+    for (uint32_t i = first; i < last; i++) {
+      uint32_t parent = this->parents[i];
+      bool isParentDirty = parent != noParentNode && this->dirtyFlags[parent];
+
+      if (!this->dirtyFlags[i] && !isParentDirty) {
+        continue;
+      }
+
+      this->dirtyFlags[i] = 1u;
+      this->worldTransformations[i] = parent == noParentNode ? this->localTransformations[i]
+        : combineTransformation(this->worldTransformations[parent], this->localTransformations[i]);
+
+      this->worldBounds[i] = transformBounds(this->worldTransformations[i], this->locals[i].objectMinimum, this->locals[i].objectMaximum);
+    }
+  }
+
+  void SceneGraph::propagateLevels(uint32_t workerIndex) {
+    for (uint32_t level = 0; level < this->getLevelCount(); level++) {
+      uint32_t levelStart = this->levelOffsets[level], levelEnd = this->levelOffsets[level + 1];
+      uint32_t levelSize = levelEnd - levelStart;
+
+      if (levelSize < parallelLevelSize) {
+        if (workerIndex == 0) {
+          this->propagateRange(levelStart, levelEnd);
+        }
+      } else {
+        uint32_t chunkSize = (levelSize + this->workerCount - 1) / this->workerCount;
+        uint32_t chunkStart = std::min(levelStart + workerIndex * chunkSize, levelEnd);
+
+        this->propagateRange(chunkStart, std::min(chunkStart + chunkSize, levelEnd));
+      }
+
+      this->levelBarrier->wait();
+    }
+  }
+
+  void SceneGraph::runWorker(uint32_t workerIndex) {
+    uint64_t seenGeneration = 0;
+
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock{this->mutex};
+        this->jobCondition.wait(lock, [this, seenGeneration]() { return this->isStopping || this->jobGeneration != seenGeneration; });
+
+        if (this->isStopping) {
+          return;
+        }
+
+        seenGeneration = this->jobGeneration;
+      }
+
+      this->propagateLevels(workerIndex);
+    }
+  }
+
+  std::vector<uint32_t> SceneGraph::update(std::vector<Transformation> &transformations) {
+    std::vector<uint32_t> changedTransformIndices;
+
+    if (this->dirtyLocals.empty()) {
+      return changedTransformIndices;
+    }
+
+    this->evaluateLocals();
+
+    if (this->workers.empty()) {
+      for (uint32_t level = 0; level < this->getLevelCount(); level++) {
+        this->propagateRange(this->levelOffsets[level], this->levelOffsets[level + 1]);
+      }
+    } else {
+      {
+        std::lock_guard<std::mutex> lock{this->mutex};
+        this->jobGeneration++;
+      }
+
+      this->jobCondition.notify_all();
+
+      // Every worker waits at the barrier after the last level, so all of them are done once this returns
+      this->propagateLevels(0);
+    }
+
+    for (uint32_t i = 0; i < this->size(); i++) {
+      if (!this->dirtyFlags[i]) {
+        continue;
+      }
+
+      this->dirtyFlags[i] = 0u;
+
+      uint32_t transformIndex = this->transformIndices[i];
+      if (transformIndex == noTransformIndex) {
+        continue;
+      }
+
+      if (transformIndex >= transformations.size()) {
+        throw std::runtime_error("scene node transform index is out of range!");
+      }
+
+      transformations[transformIndex] = this->worldTransformations[i];
+      changedTransformIndices.emplace_back(transformIndex);
+    }
+
+    return changedTransformIndices;
+  }
+} // namespace nugiEngine
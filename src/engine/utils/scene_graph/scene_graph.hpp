@@ -0,0 +1,90 @@
+#pragma once
+
+#include "../transform/transform.hpp"
+#include "../transform/transform_batch.hpp"
+#include "../bvh/bvh.hpp"
+#include "../../general_struct.hpp"
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace nugiEngine {
+  const uint32_t noParentNode = UINT32_MAX;
+  const uint32_t noTransformIndex = UINT32_MAX;
+
+  // Levels with fewer nodes than this are propagated by one thread, splitting them costs more than it saves
+  const uint32_t parallelLevelSize = 2048;
+
+  // parent is the position of the parent node in the vector given to SceneGraph, transformIndex the slot of the
+  // node in the Transformation buffer. Grouping nodes without geometry keep noTransformIndex.
+  struct SceneNode {
+    uint32_t parent = noParentNode;
+    uint32_t transformIndex = noTransformIndex;
+    TransformComponent local{};
+  };
+
+  class LevelBarrier;
+
+  // Nodes are stored sorted breadth first, so every level is a contiguous range and all parents of a level
+  // are done before it starts. Node ids in the public functions are positions in the constructor vector.
+  // Graphs large enough to split their levels keep workerCount - 1 threads alive, the calling thread of update is the last one.
+  class SceneGraph {
+    public:
+      SceneGraph(const std::vector<SceneNode> &nodes, uint32_t workerCount = 1);
+      ~SceneGraph();
+
+      SceneGraph(const SceneGraph&) = delete;
+      SceneGraph& operator = (const SceneGraph&) = delete;
+
+      void setLocal(uint32_t node, const TransformComponent &local);
+
+      const TransformComponent& getLocal(uint32_t node) const { return this->locals[this->sortedPositions[node]]; }
+      const Transformation& getWorld(uint32_t node) const { return this->worldTransformations[this->sortedPositions[node]]; }
+      const Aabb& getWorldBounds(uint32_t node) const { return this->worldBounds[this->sortedPositions[node]]; }
+
+      size_t size() const { return this->parents.size(); }
+      uint32_t getLevelCount() const { return static_cast<uint32_t>(this->levelOffsets.size() - 1); }
+
+      // Recompute the world transform and bounds of every changed node and its descendants. They are written to
+      // transformations[transformIndex] and the written indices are returned, ready for EngineTransformationModel::update.
+      std::vector<uint32_t> update(std::vector<Transformation> &transformations);
+
+    private:
+      // Everything below is in breadth first order
+      std::vector<uint32_t> parents;
+      std::vector<uint32_t> transformIndices;
+      std::vector<TransformComponent> locals;
+      std::vector<Transformation> localTransformations;
+      std::vector<Transformation> worldTransformations;
+      std::vector<Aabb> worldBounds;
+
+      // Set by setLocal, then passed down to the descendants during update
+      std::vector<uint8_t> dirtyFlags;
+      std::vector<uint32_t> dirtyLocals;
+
+      // Level l is [levelOffsets[l], levelOffsets[l + 1])
+      std::vector<uint32_t> levelOffsets;
+      std::vector<uint32_t> sortedPositions;
+
+      uint32_t workerCount;
+
+      std::vector<std::thread> workers;
+      std::unique_ptr<LevelBarrier> levelBarrier;
+
+      std::mutex mutex;
+      std::condition_variable jobCondition;
+
+      // Bumped by update to start the workers on the levels, they meet at the level barrier after each one
+      uint64_t jobGeneration = 0;
+      bool isStopping = false;
+
+      void evaluateLocals();
+      void propagateRange(uint32_t first, uint32_t last);
+      void propagateLevels(uint32_t workerIndex);
+      void runWorker(uint32_t workerIndex);
+  };
+} // namespace nugiEngine
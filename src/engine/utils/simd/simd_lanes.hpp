@@ -0,0 +1,181 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+namespace nugiEngine {
+  // Each lane type wraps one register type with the few operations the batched kernels need,
+  // a kernel is written once as a template over them and dispatched to the widest one available.
+
+  struct ScalarLanes {
+    using Float = float;
+    static constexpr size_t width = 1;
+
+    static Float set(float value) { return value; }
+    static Float load(const float *pointer) { return *pointer; }
+    static void store(float *pointer, Float value) { *pointer = value; }
+
+    static Float add(Float a, Float b) { return a + b; }
+    static Float sub(Float a, Float b) { return a - b; }
+    static Float mul(Float a, Float b) { return a * b; }
+    static Float div(Float a, Float b) { return a / b; }
+    static Float min(Float a, Float b) { return a < b ? a : b; }
+    static Float max(Float a, Float b) { return a > b ? a : b; }
+    static Float sqrt(Float a) { return std::sqrt(a); }
+
+    // mask comes from greaterThan, select picks a where it is set
+    static Float greaterThan(Float a, Float b) { return a > b ? 1.0f : 0.0f; }
+    static Float select(Float mask, Float a, Float b) { return mask != 0.0f ? a : b; }
+
+    static void sinCos(Float x, Float &sine, Float &cosine) {
+      sine = std::sin(x);
+      cosine = std::cos(x);
+    }
+
+    static void scatterColumn(Float x, Float y, Float z, Float w, float *destination, size_t) {
+      destination[0] = x;
+      destination[1] = y;
+      destination[2] = z;
+      destination[3] = w;
+    }
+  };
+
+  // Cephes style single precision sin and cos: reduce to [-pi/4, pi/4] around the nearest multiple of pi/2,
+  // evaluate both polynomials, then swap and negate them according to the quadrant.
+  template <typename L>
+  inline void sinCosPolynomial(typename L::Float y, typename L::Float &sine, typename L::Float &cosine) {
+    auto y2 = L::mul(y, y);
+
+    auto sinePolynomial = L::add(L::mul(L::set(-1.9515295891e-4f), y2), L::set(8.3321608736e-3f));
+    sinePolynomial = L::add(L::mul(sinePolynomial, y2), L::set(-1.6666654611e-1f));
+    sine = L::add(L::mul(L::mul(sinePolynomial, y2), y), y);
+
+    auto cosinePolynomial = L::add(L::mul(L::set(2.443315711809948e-5f), y2), L::set(-1.388731625493765e-3f));
+    cosinePolynomial = L::add(L::mul(cosinePolynomial, y2), L::set(4.166664568298827e-2f));
+    cosine = L::add(L::sub(L::set(1.0f), L::mul(L::set(0.5f), y2)), L::mul(L::mul(cosinePolynomial, y2), y2));
+  }
+
+  template <typename L>
+  inline typename L::Float reduceQuarterPi(typename L::Float x, typename L::Float quadrant) {
+    // pi / 2 split in three parts, so the reduction stays exact for the angles used by transforms
+    auto y = L::sub(x, L::mul(quadrant, L::set(1.5703125f)));
+    y = L::sub(y, L::mul(quadrant, L::set(4.837512969970703125e-4f)));
+    return L::sub(y, L::mul(quadrant, L::set(7.54978995489188216e-8f)));
+  }
+
+#if defined(__SSE2__) || defined(_M_X64)
+  struct SseLanes {
+    using Float = __m128;
+    static constexpr size_t width = 4;
+
+    static Float set(float value) { return _mm_set1_ps(value); }
+    static Float load(const float *pointer) { return _mm_loadu_ps(pointer); }
+    static void store(float *pointer, Float value) { _mm_storeu_ps(pointer, value); }
+
+    static Float add(Float a, Float b) { return _mm_add_ps(a, b); }
+    static Float sub(Float a, Float b) { return _mm_sub_ps(a, b); }
+    static Float mul(Float a, Float b) { return _mm_mul_ps(a, b); }
+    static Float div(Float a, Float b) { return _mm_div_ps(a, b); }
+    static Float min(Float a, Float b) { return _mm_min_ps(a, b); }
+    static Float max(Float a, Float b) { return _mm_max_ps(a, b); }
+    static Float sqrt(Float a) { return _mm_sqrt_ps(a); }
+
+    static Float greaterThan(Float a, Float b) { return _mm_cmpgt_ps(a, b); }
+    static Float select(Float mask, Float a, Float b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+
+    static void sinCos(Float x, Float &sine, Float &cosine) {
+      __m128i quadrant = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(0.63661977236f)));
+
+      Float polySine, polyCosine;
+      sinCosPolynomial<SseLanes>(reduceQuarterPi<SseLanes>(x, _mm_cvtepi32_ps(quadrant)), polySine, polyCosine);
+
+      // Odd quadrant swaps sin and cos, bit 1 of quadrant (and of quadrant + 1 for cos) flips the sign
+      __m128i one = _mm_set1_epi32(1), two = _mm_set1_epi32(2);
+      Float swapMask = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, one), one));
+      Float sineSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, two), 30));
+      Float cosineSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, one), two), 30));
+
+      sine = _mm_or_ps(_mm_and_ps(swapMask, polyCosine), _mm_andnot_ps(swapMask, polySine));
+      cosine = _mm_or_ps(_mm_and_ps(swapMask, polySine), _mm_andnot_ps(swapMask, polyCosine));
+
+      sine = _mm_xor_ps(sine, sineSign);
+      cosine = _mm_xor_ps(cosine, cosineSign);
+    }
+
+    // Lane k gets (x, y, z, w) at destination + k * stride
+    static void scatterColumn(Float x, Float y, Float z, Float w, float *destination, size_t stride) {
+      _MM_TRANSPOSE4_PS(x, y, z, w);
+
+      _mm_storeu_ps(destination, x);
+      _mm_storeu_ps(destination + stride, y);
+      _mm_storeu_ps(destination + 2 * stride, z);
+      _mm_storeu_ps(destination + 3 * stride, w);
+    }
+  };
+#endif
+
+#if defined(__AVX__)
+  struct AvxLanes {
+    using Float = __m256;
+    static constexpr size_t width = 8;
+
+    static Float set(float value) { return _mm256_set1_ps(value); }
+    static Float load(const float *pointer) { return _mm256_loadu_ps(pointer); }
+    static void store(float *pointer, Float value) { _mm256_storeu_ps(pointer, value); }
+
+    static Float add(Float a, Float b) { return _mm256_add_ps(a, b); }
+    static Float sub(Float a, Float b) { return _mm256_sub_ps(a, b); }
+    static Float mul(Float a, Float b) { return _mm256_mul_ps(a, b); }
+    static Float div(Float a, Float b) { return _mm256_div_ps(a, b); }
+    static Float min(Float a, Float b) { return _mm256_min_ps(a, b); }
+    static Float max(Float a, Float b) { return _mm256_max_ps(a, b); }
+    static Float sqrt(Float a) { return _mm256_sqrt_ps(a); }
+
+    static Float greaterThan(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+    static Float select(Float mask, Float a, Float b) { return _mm256_blendv_ps(b, a, mask); }
+
+    static void sinCos(Float x, Float &sine, Float &cosine) {
+      // AVX without AVX2 has no 256 bit integer ops, so the quadrant is found with float math
+      Float quadrant = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(0.63661977236f)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+      Float quadrantMod = _mm256_sub_ps(quadrant, _mm256_mul_ps(_mm256_floor_ps(_mm256_mul_ps(quadrant, _mm256_set1_ps(0.25f))), _mm256_set1_ps(4.0f)));
+
+      Float polySine, polyCosine;
+      sinCosPolynomial<AvxLanes>(reduceQuarterPi<AvxLanes>(x, quadrant), polySine, polyCosine);
+
+      Float signBit = _mm256_set1_ps(-0.0f);
+      Float isOne = _mm256_cmp_ps(quadrantMod, _mm256_set1_ps(1.0f), _CMP_EQ_OQ);
+      Float isTwo = _mm256_cmp_ps(quadrantMod, _mm256_set1_ps(2.0f), _CMP_EQ_OQ);
+      Float isThree = _mm256_cmp_ps(quadrantMod, _mm256_set1_ps(3.0f), _CMP_EQ_OQ);
+
+      Float swapMask = _mm256_or_ps(isOne, isThree);
+      Float sineSign = _mm256_and_ps(_mm256_or_ps(isTwo, isThree), signBit);
+      Float cosineSign = _mm256_and_ps(_mm256_or_ps(isOne, isTwo), signBit);
+
+      sine = _mm256_xor_ps(_mm256_blendv_ps(polySine, polyCosine, swapMask), sineSign);
+      cosine = _mm256_xor_ps(_mm256_blendv_ps(polyCosine, polySine, swapMask), cosineSign);
+    }
+
+    // Both 128 bit halves are transposed like SseLanes::scatterColumn, lanes 4 to 7 come from the high half
+    static void scatterColumn(Float x, Float y, Float z, Float w, float *destination, size_t stride) {
+      __m128 lowX = _mm256_castps256_ps128(x), lowY = _mm256_castps256_ps128(y), lowZ = _mm256_castps256_ps128(z), lowW = _mm256_castps256_ps128(w);
+      __m128 highX = _mm256_extractf128_ps(x, 1), highY = _mm256_extractf128_ps(y, 1), highZ = _mm256_extractf128_ps(z, 1), highW = _mm256_extractf128_ps(w, 1);
+
+      _MM_TRANSPOSE4_PS(lowX, lowY, lowZ, lowW);
+      _MM_TRANSPOSE4_PS(highX, highY, highZ, highW);
+
+      _mm_storeu_ps(destination, lowX);
+      _mm_storeu_ps(destination + stride, lowY);
+      _mm_storeu_ps(destination + 2 * stride, lowZ);
+      _mm_storeu_ps(destination + 3 * stride, lowW);
+      _mm_storeu_ps(destination + 4 * stride, highX);
+      _mm_storeu_ps(destination + 5 * stride, highY);
+      _mm_storeu_ps(destination + 6 * stride, highZ);
+      _mm_storeu_ps(destination + 7 * stride, highW);
+    }
+  };
+#endif
+} // namespace nugiEngine
@@ -0,0 +1,333 @@
+#include "simplify.hpp"
+
+#include <array>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+
+namespace nugiEngine {
+  void Quadric::addPlane(glm::vec3 normal, float distance, float weight) {
+    double a = normal.x, b = normal.y, c = normal.z, d = distance;
+
+    this->a2 += weight * a * a; this->ab += weight * a * b; this->ac += weight * a * c; this->ad += weight * a * d;
+    this->b2 += weight * b * b; this->bc += weight * b * c; this->bd += weight * b * d;
+    this->c2 += weight * c * c; this->cd += weight * c * d;
+    this->d2 += weight * d * d;
+  }
+
+  void Quadric::add(const Quadric &other) {
+    this->a2 += other.a2; this->ab += other.ab; this->ac += other.ac; this->ad += other.ad;
+    this->b2 += other.b2; this->bc += other.bc; this->bd += other.bd;
+    this->c2 += other.c2; this->cd += other.cd;
+    this->d2 += other.d2;
+  }
+
+  double Quadric::evaluate(glm::vec3 point) const {
+    double x = point.x, y = point.y, z = point.z;
+
+    double error = this->a2 * x * x + 2.0 * this->ab * x * y + 2.0 * this->ac * x * z + 2.0 * this->ad * x
+      + this->b2 * y * y + 2.0 * this->bc * y * z + 2.0 * this->bd * y
+      + this->c2 * z * z + 2.0 * this->cd * z
+      + this->d2;
+
+    return error > 0.0 ? error : 0.0;
+  }
+
+  struct WeldKey {
+    glm::vec4 position;
+    uint32_t materialIndex;
+    uint32_t transformIndex;
+
+    bool operator == (const WeldKey &other) const {
+      return this->position == other.position && this->materialIndex == other.materialIndex && this->transformIndex == other.transformIndex;
+    }
+  };
+
+  struct WeldKeyHash {
+    size_t operator()(const WeldKey &key) const {
+      size_t seed = 0;
+      auto combine = [&seed](size_t value) { seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2); };
+
+      for (int i = 0; i < 3; i++) {
+        combine(std::hash<float>{}(key.position[i]));
+      }
+
+      combine(std::hash<uint32_t>{}(key.materialIndex));
+      combine(std::hash<uint32_t>{}(key.transformIndex));
+
+      return seed;
+    }
+  };
+
+  struct CollapseCandidate {
+    double cost;
+    uint32_t from, to;
+    uint32_t fromVersion, toVersion;
+
+    bool operator > (const CollapseCandidate &other) const { return this->cost > other.cost; }
+  };
+
+  std::shared_ptr<std::vector<uint32_t>> simplifyMesh(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices,
+    uint32_t indexOffset, uint32_t targetIndexCount, float targetError, float *resultError)
+  {
+    uint32_t vertexCount = static_cast<uint32_t>(vertices.size());
+
+    // Weld vertices with equal position and attributes, the loader emits a separate vertex per triangle corner
+    std::vector<uint32_t> remap(vertexCount);
+    std::unordered_map<WeldKey, uint32_t, WeldKeyHash> uniqueVertices;
+
+    for (uint32_t i = 0; i < vertexCount; i++) {
+      WeldKey key{ vertices[i].position, vertices[i].materialIndex, vertices[i].transformIndex };
+      auto inserted = uniqueVertices.emplace(key, i);
+      remap[i] = inserted.first->second;
+    }
+
+    auto position = [&vertices](uint32_t index) { return glm::vec3(vertices[index].position); };
+
+    std::vector<std::array<uint32_t, 3>> triangles;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+      std::array<uint32_t, 3> triangle = { remap[indices[i] - indexOffset], remap[indices[i + 1] - indexOffset], remap[indices[i + 2] - indexOffset] };
+
+      if (triangle[0] != triangle[1] && triangle[1] != triangle[2] && triangle[2] != triangle[0]) {
+        triangles.emplace_back(triangle);
+      }
+    }
+
+    std::vector<bool> isTriangleRemoved(triangles.size(), false);
+    std::vector<std::vector<uint32_t>> vertexTriangles(vertexCount);
+    std::vector<Quadric> quadrics(vertexCount);
+    std::unordered_map<uint64_t, uint32_t> edgeCounts;
+
+    auto edgeKey = [](uint32_t a, uint32_t b) {
+      return (static_cast<uint64_t>(glm::min(a, b)) << 32) | static_cast<uint64_t>(glm::max(a, b));
+    };
+
+    for (uint32_t t = 0; t < triangles.size(); t++) {
+      auto &triangle = triangles[t];
+
+      glm::vec3 p0 = position(triangle[0]);
+      glm::vec3 normal = glm::cross(position(triangle[1]) - p0, position(triangle[2]) - p0);
+      float area = glm::length(normal);
+
+      for (uint32_t j = 0; j < 3; j++) {
+        vertexTriangles[triangle[j]].emplace_back(t);
+        edgeCounts[edgeKey(triangle[j], triangle[(j + 1) % 3])]++;
+      }
+
+      if (area <= FLT_EPSILON) {
+        continue;
+      }
+
+      normal /= area;
+      for (uint32_t j = 0; j < 3; j++) {
+        quadrics[triangle[j]].addPlane(normal, -glm::dot(normal, p0), 1.0f);
+      }
+    }
+
+    // Border and attribute seam edges are used by a single triangle. A plane perpendicular to the face
+    // through such an edge keeps the outline in place while the interior is simplified.
+    for (auto &&triangle : triangles) {
+      glm::vec3 p0 = position(triangle[0]);
+      glm::vec3 faceNormal = glm::cross(position(triangle[1]) - p0, position(triangle[2]) - p0);
+
+      if (glm::length(faceNormal) <= FLT_EPSILON) {
+        continue;
+      }
+
+      for (uint32_t j = 0; j < 3; j++) {
+        uint32_t a = triangle[j], b = triangle[(j + 1) % 3];
+        if (edgeCounts[edgeKey(a, b)] != 1) {
+          continue;
+        }
+
+        glm::vec3 edge = position(b) - position(a);
+        glm::vec3 borderNormal = glm::cross(edge, faceNormal);
+        float borderLength = glm::length(borderNormal);
+
+        if (borderLength <= FLT_EPSILON) {
+          continue;
+        }
+
+        borderNormal /= borderLength;
+        float distance = -glm::dot(borderNormal, position(a));
+
+        quadrics[a].addPlane(borderNormal, distance, borderWeight);
+        quadrics[b].addPlane(borderNormal, distance, borderWeight);
+      }
+    }
+
+    std::vector<uint32_t> versions(vertexCount, 0u);
+    std::vector<bool> isVertexRemoved(vertexCount, false);
+    std::priority_queue<CollapseCandidate, std::vector<CollapseCandidate>, std::greater<CollapseCandidate>> candidates;
+
+    auto pushCandidate = [&](uint32_t a, uint32_t b) {
+      Quadric merged = quadrics[a];
+      merged.add(quadrics[b]);
+
+      double costToB = merged.evaluate(position(b));
+      double costToA = merged.evaluate(position(a));
+
+      if (costToB <= costToA) {
+        candidates.push(CollapseCandidate{ costToB, a, b, versions[a], versions[b] });
+      } else {
+        candidates.push(CollapseCandidate{ costToA, b, a, versions[b], versions[a] });
+      }
+    };
+
+    for (auto &&triangle : triangles) {
+      for (uint32_t j = 0; j < 3; j++) {
+        if (triangle[j] < triangle[(j + 1) % 3]) {
+          pushCandidate(triangle[j], triangle[(j + 1) % 3]);
+        }
+      }
+    }
+
+    // Moving the vertex must not flip any of the triangles that survive the collapse
+    auto isFlipped = [&](uint32_t from, uint32_t to) {
+      for (auto &&t : vertexTriangles[from]) {
+        auto &triangle = triangles[t];
+        if (isTriangleRemoved[t] || triangle[0] == to || triangle[1] == to || triangle[2] == to) {
+          continue;
+        }
+
+        glm::vec3 oldPoints[3], newPoints[3];
+        for (uint32_t j = 0; j < 3; j++) {
+          oldPoints[j] = position(triangle[j]);
+          newPoints[j] = triangle[j] == from ? position(to) : oldPoints[j];
+        }
+
+        glm::vec3 oldNormal = glm::cross(oldPoints[1] - oldPoints[0], oldPoints[2] - oldPoints[0]);
+        glm::vec3 newNormal = glm::cross(newPoints[1] - newPoints[0], newPoints[2] - newPoints[0]);
+
+        if (glm::dot(oldNormal, newNormal) <= 0.0f) {
+          return true;
+        }
+      }
+
+      return false;
+    };
+
+    uint32_t triangleCount = static_cast<uint32_t>(triangles.size());
+    double maxCost = 0.0;
+    double maxAllowedCost = static_cast<double>(targetError) * static_cast<double>(targetError);
+
+    while (!candidates.empty() && triangleCount * 3 > targetIndexCount) {
+      CollapseCandidate candidate = candidates.top();
+      candidates.pop();
+
+      if (isVertexRemoved[candidate.from] || isVertexRemoved[candidate.to] ||
+        versions[candidate.from] != candidate.fromVersion || versions[candidate.to] != candidate.toVersion)
+      {
+        continue;
+      }
+
+      if (candidate.cost > maxAllowedCost) {
+        break;
+      }
+
+      if (isFlipped(candidate.from, candidate.to)) {
+        continue;
+      }
+
+      for (auto &&t : vertexTriangles[candidate.from]) {
+        if (isTriangleRemoved[t]) {
+          continue;
+        }
+
+        auto &triangle = triangles[t];
+        if (triangle[0] == candidate.to || triangle[1] == candidate.to || triangle[2] == candidate.to) {
+          isTriangleRemoved[t] = true;
+          triangleCount--;
+          continue;
+        }
+
+        for (uint32_t j = 0; j < 3; j++) {
+          if (triangle[j] == candidate.from) {
+            triangle[j] = candidate.to;
+          }
+        }
+
+        vertexTriangles[candidate.to].emplace_back(t);
+      }
+
+      quadrics[candidate.to].add(quadrics[candidate.from]);
+      isVertexRemoved[candidate.from] = true;
+      versions[candidate.to]++;
+      maxCost = glm::max(maxCost, candidate.cost);
+
+      for (auto &&t : vertexTriangles[candidate.to]) {
+        if (isTriangleRemoved[t]) {
+          continue;
+        }
+
+        for (auto &&neighbour : triangles[t]) {
+          if (neighbour != candidate.to) {
+            pushCandidate(candidate.to, neighbour);
+          }
+        }
+      }
+    }
+
+    auto result = std::make_shared<std::vector<uint32_t>>();
+    result->reserve(triangleCount * 3);
+
+    for (uint32_t t = 0; t < triangles.size(); t++) {
+      if (isTriangleRemoved[t]) {
+        continue;
+      }
+
+      for (auto &&index : triangles[t]) {
+        result->emplace_back(index + indexOffset);
+      }
+    }
+
+    if (resultError != nullptr) {
+      *resultError = static_cast<float>(std::sqrt(maxCost));
+    }
+
+    return result;
+  }
+
+  std::vector<MeshLod> generateLodChain(const std::vector<Vertex> &vertices, std::shared_ptr<std::vector<uint32_t>> indices,
+    uint32_t indexOffset, uint32_t lodLevel, float reduction, float maxError)
+  {
+    std::vector<MeshLod> lods;
+    lods.emplace_back(MeshLod{ indices, 0.0f });
+
+    for (uint32_t i = 1; i < lodLevel; i++) {
+      auto &previous = lods.back();
+
+      auto previousCount = static_cast<uint32_t>(previous.indices->size());
+      auto targetCount = static_cast<uint32_t>(static_cast<float>(previousCount) * reduction) / 3 * 3;
+
+      float levelError = 0.0f;
+      auto levelIndices = simplifyMesh(vertices, *previous.indices, indexOffset, targetCount, maxError, &levelError);
+
+      // Simplifier got stuck on locked borders or the error bound, more levels would just duplicate this one
+      if (levelIndices->empty() || levelIndices->size() >= previousCount * 0.95f) {
+        break;
+      }
+
+      // Each level is built from the previous one, so its deviation from the original accumulates
+      lods.emplace_back(MeshLod{ levelIndices, previous.error + levelError });
+    }
+
+    return lods;
+  }
+
+  uint32_t selectLodLevel(const std::vector<MeshLod> &lods, float distance, float projectionScale, float maxPixelError) {
+    uint32_t selected = 0;
+
+    for (uint32_t i = 1; i < lods.size(); i++) {
+      float projectedError = lods[i].error / glm::max(distance, FLT_EPSILON) * projectionScale;
+      if (projectedError > maxPixelError) {
+        break;
+      }
+
+      selected = i;
+    }
+
+    return selected;
+  }
+} // namespace nugiEngine
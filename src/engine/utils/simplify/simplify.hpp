@@ -0,0 +1,51 @@
+#pragma once
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include "../../general_struct.hpp"
+
+#include <vector>
+#include <memory>
+#include <cfloat>
+
+namespace nugiEngine {
+  const uint32_t maxLodLevel = 4;
+  const float lodReduction = 0.5f;
+  const float borderWeight = 10.0f;
+
+  // One level of detail: indices into the same vertex buffer as the full resolution mesh,
+  // plus the object space distance the surface may deviate from the original.
+  struct MeshLod {
+    std::shared_ptr<std::vector<uint32_t>> indices;
+    float error = 0.0f;
+  };
+
+  // Symmetric 4x4 error quadric (Garland-Heckbert), only the upper triangle is stored.
+  struct Quadric {
+    double a2 = 0.0, ab = 0.0, ac = 0.0, ad = 0.0;
+    double b2 = 0.0, bc = 0.0, bd = 0.0;
+    double c2 = 0.0, cd = 0.0;
+    double d2 = 0.0;
+
+    void addPlane(glm::vec3 normal, float distance, float weight);
+    void add(const Quadric &other);
+    double evaluate(glm::vec3 point) const;
+  };
+
+  // Collapse edges by increasing quadric error until the index count reaches targetIndexCount or
+  // the next collapse would exceed targetError. Collapses only move a vertex onto one of its neighbours,
+  // so the result keeps indexing the original vertices. Vertices sharing a position are welded, except
+  // when material or transform differs; these seams and open borders are guarded by extra quadric planes.
+  // indexOffset is subtracted from every index to find its vertex (see loadModelFromFile).
+  std::shared_ptr<std::vector<uint32_t>> simplifyMesh(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices,
+    uint32_t indexOffset, uint32_t targetIndexCount, float targetError, float *resultError = nullptr);
+
+  // Level 0 is the original index buffer, every next level aims for lodReduction of the previous one.
+  std::vector<MeshLod> generateLodChain(const std::vector<Vertex> &vertices, std::shared_ptr<std::vector<uint32_t>> indices,
+    uint32_t indexOffset, uint32_t lodLevel = maxLodLevel, float reduction = lodReduction, float maxError = FLT_MAX);
+
+  // projectionScale is projection[1][1] * viewport height / 2, so error / distance * projectionScale is in pixel
+  uint32_t selectLodLevel(const std::vector<MeshLod> &lods, float distance, float projectionScale, float maxPixelError = 1.0f);
+} // namespace nugiEngine
@@ -0,0 +1,126 @@
+#include "transform_batch.hpp"
+
+#include "../simd/simd_lanes.hpp"
+
+namespace nugiEngine {
+  void TransformBatch::resize(size_t count) {
+    for (int i = 0; i < 3; i++) {
+      this->translation[i].resize(count);
+      this->scale[i].resize(count);
+      this->rotation[i].resize(count);
+      this->origin[i].resize(count);
+    }
+  }
+
+  void TransformBatch::set(size_t index, const TransformComponent &component) {
+    glm::vec3 origin = (component.objectMaximum - component.objectMinimum) / 2.0f + component.objectMinimum;
+
+    for (int i = 0; i < 3; i++) {
+      this->translation[i][index] = component.translation[i];
+      this->scale[i][index] = component.scale[i];
+      this->rotation[i][index] = component.rotation[i];
+      this->origin[i][index] = origin[i];
+    }
+  }
+
+  TransformBatch createTransformBatch(const std::vector<TransformComponent> &components) {
+    TransformBatch batch;
+    batch.resize(components.size());
+
+    for (size_t i = 0; i < components.size(); i++) {
+      batch.set(i, components[i]);
+    }
+
+    return batch;
+  }
+
+  // ---------------------- kernel ----------------------
+
+  static_assert(sizeof(Transformation) == sizeof(float) * 12 * 2, "Transformation is expected to be two tightly packed 3x4 float matrices");
+
+  // Point matrix is T(t) * T(o) * S * Rx * Ry * Rz * T(-o). With L = S * R the linear part, its translation is t + o - L * o.
+  // The inverse linear part is R^T * S^-1.
+  template <typename L>
+  void evaluateTransformBlock(const TransformBatch &batch, size_t first, Transformation *transformations) {
+    using F = typename L::Float;
+
+    F t[3], s[3], o[3], sine[3], cosine[3];
+    for (int i = 0; i < 3; i++) {
+      t[i] = L::load(&batch.translation[i][first]);
+      s[i] = L::load(&batch.scale[i][first]);
+      o[i] = L::load(&batch.origin[i][first]);
+
+      L::sinCos(L::load(&batch.rotation[i][first]), sine[i], cosine[i]);
+    }
+
+    F sxsy = L::mul(sine[0], sine[1]);
+    F cxsy = L::mul(cosine[0], sine[1]);
+
+    // Rotation matrix by row, R = Rx * Ry * Rz
+    F r[3][3] = {
+      { L::mul(cosine[1], cosine[2]), L::sub(L::set(0.0f), L::mul(cosine[1], sine[2])), sine[1] },
+      { L::add(L::mul(sxsy, cosine[2]), L::mul(cosine[0], sine[2])), L::sub(L::mul(cosine[0], cosine[2]), L::mul(sxsy, sine[2])), L::sub(L::set(0.0f), L::mul(sine[0], cosine[1])) },
+      { L::sub(L::mul(sine[0], sine[2]), L::mul(cxsy, cosine[2])), L::add(L::mul(cxsy, sine[2]), L::mul(sine[0], cosine[2])), L::mul(cosine[0], cosine[1]) }
+    };
+
+    F inverseScale[3];
+    for (int i = 0; i < 3; i++) {
+      inverseScale[i] = L::div(L::set(1.0f), s[i]);
+    }
+
+    // linear[row][col] = s_row * r[row][col], inverseLinear[row][col] = r[col][row] / s_col
+    F linear[3][3], inverseLinear[3][3];
+    for (int row = 0; row < 3; row++) {
+      for (int col = 0; col < 3; col++) {
+        linear[row][col] = L::mul(s[row], r[row][col]);
+        inverseLinear[row][col] = L::mul(r[col][row], inverseScale[col]);
+      }
+    }
+
+    F pointTranslation[3], inverseTranslation[3];
+    for (int row = 0; row < 3; row++) {
+      F linearOrigin = L::add(L::add(L::mul(linear[row][0], o[0]), L::mul(linear[row][1], o[1])), L::mul(linear[row][2], o[2]));
+      pointTranslation[row] = L::sub(L::add(t[row], o[row]), linearOrigin);
+
+      F inverseOffset = L::mul(inverseLinear[row][0], L::add(t[0], o[0]));
+      inverseOffset = L::add(inverseOffset, L::mul(inverseLinear[row][1], L::add(t[1], o[1])));
+      inverseOffset = L::add(inverseOffset, L::mul(inverseLinear[row][2], L::add(t[2], o[2])));
+      inverseTranslation[row] = L::sub(o[row], inverseOffset);
+    }
+
+    // Back to one transform per lane, a whole row at a time. Row row of matrix m is column row of the transposed 3x4, at m * 12 + row * 4.
+    float *base = reinterpret_cast<float*>(&transformations[first]);
+    const size_t stride = sizeof(Transformation) / sizeof(float);
+
+    for (int row = 0; row < 3; row++) {
+      L::scatterColumn(linear[row][0], linear[row][1], linear[row][2], pointTranslation[row], base + row * 4, stride);
+      L::scatterColumn(inverseLinear[row][0], inverseLinear[row][1], inverseLinear[row][2], inverseTranslation[row], base + 12 + row * 4, stride);
+    }
+  }
+
+  void evaluateTransforms(const TransformBatch &batch, Transformation *transformations) {
+    size_t count = batch.size();
+    size_t first = 0;
+
+#if defined(__AVX__)
+    for (; first + AvxLanes::width <= count; first += AvxLanes::width) {
+      evaluateTransformBlock<AvxLanes>(batch, first, transformations);
+    }
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+    for (; first + SseLanes::width <= count; first += SseLanes::width) {
+      evaluateTransformBlock<SseLanes>(batch, first, transformations);
+    }
+#endif
+
+    for (; first < count; first++) {
+      evaluateTransformBlock<ScalarLanes>(batch, first, transformations);
+    }
+  }
+
+  void evaluateTransforms(const TransformBatch &batch, std::vector<Transformation> &transformations) {
+    transformations.resize(batch.size());
+    evaluateTransforms(batch, transformations.data());
+  }
+} // namespace nugiEngine
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "transform.hpp"
+#include "../../general_struct.hpp"
+
+#include <vector>
+
+namespace nugiEngine {
+  // Structure of arrays copy of TransformComponent, so a SIMD register can hold the same field of 4 (SSE) or 8 (AVX) transforms.
+  // origin is the center of the object bounds, the point TransformComponent scales and rotates around.
+  struct TransformBatch {
+    std::vector<float> translation[3];
+    std::vector<float> scale[3];
+    std::vector<float> rotation[3];
+    std::vector<float> origin[3];
+
+    size_t size() const { return this->translation[0].size(); }
+
+    void resize(size_t count);
+    void set(size_t index, const TransformComponent &component);
+  };
+
+  TransformBatch createTransformBatch(const std::vector<TransformComponent> &components);
+
+  // Evaluate the point matrix and its inverse of every transform in the batch, the same result as the TransformComponent getters.
+  // Inverses are built from the decomposed scale and rotation (R^T * S^-1) instead of a general 4x4 inverse.
+  void evaluateTransforms(const TransformBatch &batch, Transformation *transformations);
+  void evaluateTransforms(const TransformBatch &batch, std::vector<Transformation> &transformations);
+} // namespace nugiEngine
@@ -0,0 +1,182 @@
+#include "vertex_packing.hpp"
+
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <utility>
+
+namespace nugiEngine {
+  glm::vec2 encodeOctahedral(glm::vec3 normal) {
+    normal /= (glm::abs(normal.x) + glm::abs(normal.y) + glm::abs(normal.z));
+    glm::vec2 encoded{ normal.x, normal.y };
+
+    // Fold the lower hemisphere over the diagonals
+    if (normal.z < 0.0f) {
+      encoded = glm::vec2{
+        (1.0f - glm::abs(normal.y)) * (normal.x >= 0.0f ? 1.0f : -1.0f),
+        (1.0f - glm::abs(normal.x)) * (normal.y >= 0.0f ? 1.0f : -1.0f)
+      };
+    }
+
+    return encoded;
+  }
+
+  glm::vec3 decodeOctahedral(glm::vec2 encoded) {
+    glm::vec3 normal{ encoded.x, encoded.y, 1.0f - glm::abs(encoded.x) - glm::abs(encoded.y) };
+    float t = glm::max(-normal.z, 0.0f);
+
+    normal.x += normal.x >= 0.0f ? -t : t;
+    normal.y += normal.y >= 0.0f ? -t : t;
+
+    return glm::normalize(normal);
+  }
+
+  uint16_t packHalf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xFFu) - 127 + 15;
+    uint32_t mantissa = bits & 0x7FFFFFu;
+
+    if (exponent >= 31) {
+      // Overflow saturates to infinity, NaN keeps a mantissa bit
+      bool isNan = ((bits >> 23) & 0xFFu) == 0xFFu && mantissa != 0;
+      return static_cast<uint16_t>(sign | 0x7C00u | (isNan ? 0x200u : 0u));
+    }
+
+    if (exponent <= 0) {
+      if (exponent < -10) {
+        return static_cast<uint16_t>(sign);
+      }
+
+      mantissa |= 0x800000u;
+      uint32_t shift = static_cast<uint32_t>(14 - exponent);
+      uint32_t halfMantissa = mantissa >> shift;
+
+      if ((mantissa >> (shift - 1)) & 1u) {
+        halfMantissa++;
+      }
+
+      return static_cast<uint16_t>(sign | halfMantissa);
+    }
+
+    uint32_t half = sign | (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+    if (mantissa & 0x1000u) {
+      half++; // round to nearest, carry into the exponent is still correct
+    }
+
+    return static_cast<uint16_t>(half);
+  }
+
+  float unpackHalf(uint16_t value) {
+    uint32_t sign = static_cast<uint32_t>(value & 0x8000u) << 16;
+    uint32_t exponent = (value >> 10) & 0x1Fu;
+    uint32_t mantissa = value & 0x3FFu;
+    uint32_t bits;
+
+    if (exponent == 0) {
+      if (mantissa == 0) {
+        bits = sign;
+      } else {
+        // Subnormal, normalize it
+        exponent = 127 - 15 + 1;
+        while ((mantissa & 0x400u) == 0) {
+          mantissa <<= 1;
+          exponent--;
+        }
+
+        bits = sign | (exponent << 23) | ((mantissa & 0x3FFu) << 13);
+      }
+    } else if (exponent == 31) {
+      bits = sign | 0x7F800000u | (mantissa << 13);
+    } else {
+      bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+    }
+
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+
+    return result;
+  }
+
+  PackedModel packVertices(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices, std::vector<Meshlet> &meshlets) {
+    std::map<uint32_t, std::pair<glm::vec3, glm::vec3>> meshBounds;
+
+    for (auto &&vertex : vertices) {
+      auto inserted = meshBounds.emplace(vertex.transformIndex, std::make_pair(glm::vec3{FLT_MAX}, glm::vec3{-FLT_MAX}));
+      auto &bound = inserted.first->second;
+
+      bound.first = glm::min(bound.first, glm::vec3(vertex.position));
+      bound.second = glm::max(bound.second, glm::vec3(vertex.position));
+    }
+
+    std::vector<glm::vec3> normals(vertices.size(), glm::vec3{0.0f});
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+      glm::vec3 p0 = glm::vec3(vertices[indices[i + 0]].position);
+      glm::vec3 p1 = glm::vec3(vertices[indices[i + 1]].position);
+      glm::vec3 p2 = glm::vec3(vertices[indices[i + 2]].position);
+
+      // Not normalized, so bigger triangles weight more
+      glm::vec3 faceNormal = glm::cross(p1 - p0, p2 - p0);
+      for (size_t j = 0; j < 3; j++) {
+        normals[indices[i + j]] += faceNormal;
+      }
+    }
+
+    auto packedVertices = std::make_shared<std::vector<PackedVertex>>(vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++) {
+      auto &bound = meshBounds[vertices[i].transformIndex];
+      glm::vec3 extent = glm::max(bound.second - bound.first, glm::vec3{FLT_EPSILON});
+      glm::vec3 normalized = glm::clamp((glm::vec3(vertices[i].position) - bound.first) / extent, 0.0f, 1.0f);
+
+      auto &packed = (*packedVertices)[i];
+      for (int j = 0; j < 3; j++) {
+        packed.position[j] = static_cast<uint16_t>(std::lround(normalized[j] * 65535.0f));
+      }
+
+      glm::vec3 normal = glm::length(normals[i]) > FLT_EPSILON ? glm::normalize(normals[i]) : glm::vec3{0.0f, 0.0f, 1.0f};
+      glm::vec2 encoded = glm::clamp(encodeOctahedral(normal), -1.0f, 1.0f);
+
+      for (int j = 0; j < 2; j++) {
+        packed.normal[j] = static_cast<int16_t>(std::lround(encoded[j] * 32767.0f));
+      }
+
+      packed.textCoord[0] = packHalf(vertices[i].textCoord.x);
+      packed.textCoord[1] = packHalf(vertices[i].textCoord.y);
+    }
+
+    auto drawDatas = std::make_shared<std::vector<DrawData>>();
+    std::map<std::pair<uint32_t, uint32_t>, uint32_t> drawIndices;
+
+    for (auto &&meshlet : meshlets) {
+      auto key = std::make_pair(meshlet.transformIndex, meshlet.materialIndex);
+      auto found = drawIndices.find(key);
+
+      if (found != drawIndices.end()) {
+        meshlet.drawIndex = found->second;
+        continue;
+      }
+
+      auto &bound = meshBounds[meshlet.transformIndex];
+
+      DrawData drawData{};
+      drawData.positionOffset = glm::vec4(bound.first, 0.0f);
+      drawData.positionScale = glm::vec4(glm::max(bound.second - bound.first, glm::vec3{FLT_EPSILON}), 0.0f);
+      drawData.materialIndex = meshlet.materialIndex;
+      drawData.transformIndex = meshlet.transformIndex;
+
+      meshlet.drawIndex = static_cast<uint32_t>(drawDatas->size());
+      drawIndices.emplace(key, meshlet.drawIndex);
+      drawDatas->emplace_back(drawData);
+    }
+
+    return PackedModel{ packedVertices, drawDatas };
+  }
+
+  glm::vec3 unpackPosition(const PackedVertex &vertex, const DrawData &drawData) {
+    glm::vec3 normalized{ vertex.position[0] / 65535.0f, vertex.position[1] / 65535.0f, vertex.position[2] / 65535.0f };
+    return glm::vec3(drawData.positionOffset) + normalized * glm::vec3(drawData.positionScale);
+  }
+} // namespace nugiEngine
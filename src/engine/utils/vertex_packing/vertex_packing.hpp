@@ -0,0 +1,31 @@
+#pragma once
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include "../../general_struct.hpp"
+#include "../meshlet/meshlet.hpp"
+
+#include <vector>
+#include <memory>
+
+namespace nugiEngine {
+  struct PackedModel {
+    std::shared_ptr<std::vector<PackedVertex>> vertices;
+    std::shared_ptr<std::vector<DrawData>> drawDatas;
+  };
+
+  glm::vec2 encodeOctahedral(glm::vec3 normal);
+  glm::vec3 decodeOctahedral(glm::vec2 encoded);
+
+  uint16_t packHalf(float value);
+  float unpackHalf(uint16_t value);
+
+  // A mesh is every vertex sharing the same transform index, positions are quantized to 16 bit
+  // relative to its bounding box. Normals are the area weighted average of the triangles using the vertex.
+  // One DrawData is made for every transform and material pair used by the meshlets, and meshlet drawIndex is set to it.
+  PackedModel packVertices(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices, std::vector<Meshlet> &meshlets);
+
+  glm::vec3 unpackPosition(const PackedVertex &vertex, const DrawData &drawData);
+} // namespace nugiEngine
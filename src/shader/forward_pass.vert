@@ -2,12 +2,18 @@
 
 #include "struct.glsl"
 
-layout(location = 0) in vec4 position;
-layout(location = 1) in uint materialIndex;
-layout(location = 2) in uint transformIndex;
+layout(location = 0) in vec4 quantizedPosition;
+layout(location = 1) in vec2 encodedNormal;
+layout(location = 2) in vec2 textCoord;
+
+layout(location = 3) in vec4 positionOffset;
+layout(location = 4) in vec4 positionScale;
+layout(location = 5) in uvec2 drawIndices; // x = material index, y = transform index
 
 layout(location = 0) out vec3 positionFrag;
 layout(location = 1) flat out uint materialIndexFrag;
+layout(location = 2) out vec3 normalFrag;
+layout(location = 3) out vec2 textCoordFrag;
 
 layout(set = 0, binding = 0) uniform readonly RasterUbo {
 	mat4 viewProjection;
@@ -18,9 +24,14 @@ layout(set = 0, binding = 1) buffer readonly TransformationSsbo {
 };
 
 void main() {
-	vec4 positionWorld = transformations[transformIndex].pointMatrix * position;
+	DrawData drawData = DrawData(positionOffset, positionScale, drawIndices.x, drawIndices.y);
+	Transformation transformation = transformations[drawData.transformIndex];
+
+	vec4 positionWorld = vec4(transformPoint(transformation, decodePosition(quantizedPosition.xyz, drawData)), 1.0);
 	gl_Position = ubo.viewProjection * positionWorld;
 
 	positionFrag = positionWorld.xyz;
-	materialIndexFrag = materialIndex;
+	materialIndexFrag = drawData.materialIndex;
+	normalFrag = normalize(transformNormal(transformation, decodeOctahedral(encodedNormal)));
+	textCoordFrag = textCoord;
 }
\ No newline at end of file
@@ -6,6 +6,21 @@ struct Vertex {
   vec4 position;
   uint materialIndex; // Because of hybrid rendering, Material Index also hold by Vertex
   uint transformIndex; // Because of hybrid rendering, Transform Index also hold by Vertex
+  vec2 textCoord;
+};
+
+// Raster vertex, position is quantized to the bounds of the mesh held by its DrawData
+struct PackedVertex {
+  uvec2 position; // 4x unorm16, w unused
+  uint normal; // 2x snorm16 octahedral
+  uint textCoord; // 2x half
+};
+
+struct DrawData {
+  vec4 positionOffset;
+  vec4 positionScale;
+  uint materialIndex;
+  uint transformIndex;
 };
 
 struct Primitive {
@@ -59,12 +74,10 @@ struct Material {
   uint normalTextureIndex;
 };
 
+// Affine 3x4 matrix and its inverse, stored transposed: column i holds row i with the translation in w
 struct Transformation {
-  mat4 pointMatrix;
-  mat4 dirMatrix;
-  mat4 pointInverseMatrix;
-  mat4 dirInverseMatrix;
-  mat4 normalMatrix;
+  mat3x4 pointMatrix;
+  mat3x4 pointInverseMatrix;
 };
 
 // ---------------------- internal struct ----------------------
@@ -101,4 +114,54 @@ struct ShadeRecord {
 
 float pi = 3.14159265359;
 float FLT_MAX = 3.402823e+38;
-float FLT_MIN = 1.175494e-38;
\ No newline at end of file
+float FLT_MIN = 1.175494e-38;
+
+// ---------------------- packed vertex decoding ----------------------
+
+vec3 decodeOctahedral(vec2 encoded) {
+  vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+  float t = max(-normal.z, 0.0);
+  normal.xy += mix(vec2(t), vec2(-t), greaterThanEqual(normal.xy, vec2(0.0)));
+
+  return normalize(normal);
+}
+
+vec3 decodePosition(vec3 quantizedPosition, DrawData drawData) {
+  return drawData.positionOffset.xyz + quantizedPosition * drawData.positionScale.xyz;
+}
+
+vec3 decodePosition(PackedVertex vertex, DrawData drawData) {
+  vec3 quantizedPosition = vec3(unpackUnorm2x16(vertex.position.x), unpackUnorm2x16(vertex.position.y).x);
+  return decodePosition(quantizedPosition, drawData);
+}
+
+vec3 decodeNormal(PackedVertex vertex) {
+  return decodeOctahedral(unpackSnorm2x16(vertex.normal));
+}
+
+vec2 decodeTextCoord(PackedVertex vertex) {
+  return unpackHalf2x16(vertex.textCoord);
+}
+
+// ---------------------- transformation ----------------------
+
+vec3 transformPoint(Transformation transformation, vec3 point) {
+  return vec4(point, 1.0) * transformation.pointMatrix;
+}
+
+vec3 transformDir(Transformation transformation, vec3 direction) {
+  return vec4(direction, 0.0) * transformation.pointMatrix;
+}
+
+vec3 inverseTransformPoint(Transformation transformation, vec3 point) {
+  return vec4(point, 1.0) * transformation.pointInverseMatrix;
+}
+
+vec3 inverseTransformDir(Transformation transformation, vec3 direction) {
+  return vec4(direction, 0.0) * transformation.pointInverseMatrix;
+}
+
+// Transpose of the inverse upper 3x3, which is the inverse stored transposed
+vec3 transformNormal(Transformation transformation, vec3 normal) {
+  return mat3(transformation.pointInverseMatrix) * normal;
+}
@@ -37,11 +37,13 @@ namespace nugiEngine {
     VkBufferUsageFlags bufferUsage,
     VmaMemoryUsage memoryUsageFlags,
     VmaAllocationCreateFlags memoryPropertyFlags,
-    VkDeviceSize minOffsetAlignment
+    VkDeviceSize minOffsetAlignment,
+    MemoryCategory category
   )
     : engineDevice{device},
       instanceSize{instanceSize},
-      instanceCount{instanceCount}
+      instanceCount{instanceCount},
+      category{category}
   {
     this->alignmentSize = getAlignment(instanceSize, minOffsetAlignment);
     this->bufferSize = alignmentSize * instanceCount;
@@ -51,7 +53,16 @@ namespace nugiEngine {
   
   EngineBuffer::~EngineBuffer() {
     this->unmap();
-    vmaDestroyBuffer(this->engineDevice.getMemoryAllocator(), this->buffer, this->allocation);
+
+    // While being moved the allocation belongs to the defragmentation pass, only the handles are ours
+    if (this->isDefragmentable && this->engineDevice.getDefragmenter().cancel(this)) {
+      vkDestroyBuffer(this->engineDevice.getLogicalDevice(), this->buffer, nullptr);
+      vkDestroyBuffer(this->engineDevice.getLogicalDevice(), this->movedBuffer, nullptr);
+    } else {
+      vmaDestroyBuffer(this->engineDevice.getMemoryAllocator(), this->buffer, this->allocation);
+    }
+
+    this->engineDevice.getMemoryTracker().onFree(this->category, this->allocationInfo.size);
   }
   
   /**
@@ -230,13 +241,68 @@ namespace nugiEngine {
     bufferInfo.usage = bufferUsage;
     bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
+    auto &memoryTracker = this->engineDevice.getMemoryTracker();
+    memoryTracker.reserve(this->category, size);
+
     VmaAllocationCreateInfo allocInfo{};
     allocInfo.usage = memoryUsage;
-    allocInfo.flags = memoryPropertyFlags;
+    allocInfo.flags = memoryPropertyFlags | VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT;
+
+    VkResult result = vmaCreateBuffer(this->engineDevice.getMemoryAllocator(), &bufferInfo, &allocInfo, &this->buffer, &this->allocation, &this->allocationInfo);
+
+    // Over the heap budget, retry once if something could be evicted
+    if (result == VK_ERROR_OUT_OF_DEVICE_MEMORY && memoryTracker.evict(this->category, size)) {
+      result = vmaCreateBuffer(this->engineDevice.getMemoryAllocator(), &bufferInfo, &allocInfo, &this->buffer, &this->allocation, &this->allocationInfo);
+    }
+
+    if (result != VK_SUCCESS) {
+      memoryTracker.cancel(this->category, size);
+      throw std::runtime_error("failed to create buffer!");
+    }
+
+    memoryTracker.commit(this->category, size, this->allocationInfo.size);
+    this->bufferUsage = bufferUsage;
+
+    // Only device local content that can be copied on the GPU may be moved, mapped memory stays where it is
+    VkMemoryPropertyFlags memoryProperties;
+    vmaGetAllocationMemoryProperties(this->engineDevice.getMemoryAllocator(), this->allocation, &memoryProperties);
+
+    VkBufferUsageFlags transferUsage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    this->isDefragmentable = (memoryProperties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) == 0 && (bufferUsage & transferUsage) == transferUsage;
 
-    if (vmaCreateBuffer(this->engineDevice.getMemoryAllocator(), &bufferInfo, &allocInfo, &this->buffer, &this->allocation, &this->allocationInfo) != VK_SUCCESS) {
+    if (this->isDefragmentable) {
+      vmaSetAllocationUserData(this->engineDevice.getMemoryAllocator(), this->allocation, static_cast<EngineDefragmentable*>(this));
+    }
+  }
+
+  void EngineBuffer::beginMove(VmaAllocation dstAllocation, std::shared_ptr<EngineCommandBuffer> commandBuffer) {
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = this->bufferSize;
+    bufferInfo.usage = this->bufferUsage;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VkBuffer newBuffer;
+    if (vkCreateBuffer(this->engineDevice.getLogicalDevice(), &bufferInfo, nullptr, &newBuffer) != VK_SUCCESS) {
       throw std::runtime_error("failed to create buffer!");
     }
+
+    if (vmaBindBufferMemory(this->engineDevice.getMemoryAllocator(), dstAllocation, newBuffer) != VK_SUCCESS) {
+      vkDestroyBuffer(this->engineDevice.getLogicalDevice(), newBuffer, nullptr);
+      throw std::runtime_error("failed to bind moved buffer memory!");
+    }
+
+    VkBufferCopy copyRegion{};
+    copyRegion.size = this->bufferSize;
+    vkCmdCopyBuffer(commandBuffer->getCommandBuffer(), this->buffer, newBuffer, 1, &copyRegion);
+
+    this->movedBuffer = this->buffer;
+    this->buffer = newBuffer;
+  }
+
+  void EngineBuffer::finishMove() {
+    vkDestroyBuffer(this->engineDevice.getLogicalDevice(), this->movedBuffer, nullptr);
+    this->movedBuffer = VK_NULL_HANDLE;
   }
 
   void EngineBuffer::copyBuffer(VkBuffer srcBuffer, VkDeviceSize size, std::shared_ptr<EngineCommandBuffer> commandBuffer) {
@@ -257,7 +323,7 @@ namespace nugiEngine {
 
     if (isCommandBufferCreatedHere) {
       commandBuffer->endCommand();
-      commandBuffer->submitCommand(this->engineDevice.getTransferQueue(0));
+      commandBuffer->submitCommandAndWait(QueueType::Graphics);
     }
   }
 
@@ -295,7 +361,7 @@ namespace nugiEngine {
 
     if (isCommandBufferCreatedHere) {
       commandBuffer->endCommand();
-      commandBuffer->submitCommand(this->engineDevice.getTransferQueue(0));
+      commandBuffer->submitCommandAndWait(QueueType::Graphics);
     }
   }
   
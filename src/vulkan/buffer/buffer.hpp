@@ -4,10 +4,12 @@
 
 #include "../device/device.hpp"
 #include "../command/command_buffer.hpp"
+#include "../memory/memory_tracker.hpp"
+#include "../memory/defragmenter.hpp"
  
 namespace nugiEngine {
  
-class EngineBuffer {
+class EngineBuffer : public EngineDefragmentable {
  public:
   EngineBuffer(
       EngineDevice& device,
@@ -16,7 +18,8 @@ class EngineBuffer {
       VkBufferUsageFlags bufferUsage,
       VmaMemoryUsage memoryUsageFlags,
       VmaAllocationCreateFlags memoryPropertyFlags,
-      VkDeviceSize minOffsetAlignment = 1);
+      VkDeviceSize minOffsetAlignment = 1,
+      MemoryCategory category = MemoryCategory::Other);
   ~EngineBuffer();
  
   EngineBuffer(const EngineBuffer&) = delete;
@@ -48,6 +51,10 @@ class EngineBuffer {
   VkDeviceSize getInstanceSize() const { return instanceSize; }
   VkDeviceSize getAlignmentSize() const { return instanceSize; }
   VkDeviceSize getBufferSize() const { return bufferSize; }
+  MemoryCategory getCategory() const { return category; }
+
+  void beginMove(VmaAllocation dstAllocation, std::shared_ptr<EngineCommandBuffer> commandBuffer) override;
+  void finishMove() override;
  
  private:
   static VkDeviceSize getAlignment(VkDeviceSize instanceSize, VkDeviceSize minOffsetAlignment);
@@ -56,12 +63,18 @@ class EngineBuffer {
 
   void* mapped = nullptr;
   VkBuffer buffer = VK_NULL_HANDLE;
+  VkBuffer movedBuffer = VK_NULL_HANDLE;
 
   VmaAllocation allocation;
   VmaAllocationInfo allocationInfo;
  
   VkDeviceSize bufferSize, instanceSize, alignmentSize;
   uint32_t instanceCount;
+
+  VkBufferUsageFlags bufferUsage = 0;
+  bool isDefragmentable = false;
+
+  MemoryCategory category;
 };
  
 }  // namespace lve
\ No newline at end of file
@@ -0,0 +1,103 @@
+#include "buffer_pool.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace nugiEngine {
+  EngineBufferSlice::EngineBufferSlice(EngineBufferPool &pool, uint32_t blockIndex, VmaVirtualAllocation allocation, EngineBuffer &blockBuffer,
+    VkDeviceSize offset, VkDeviceSize size) : pool{pool}, blockIndex{blockIndex}, allocation{allocation}, blockBuffer{blockBuffer}, offset{offset}, size{size}
+  {
+
+  }
+
+  EngineBufferSlice::~EngineBufferSlice() {
+    this->pool.free(this->blockIndex, this->allocation);
+  }
+
+  EngineBufferPool::EngineBufferPool(EngineDevice &device, VkBufferUsageFlags bufferUsage, MemoryCategory category, VkDeviceSize minOffsetAlignment, VkDeviceSize blockSize)
+    : engineDevice{device}, bufferUsage{bufferUsage}, category{category}, minOffsetAlignment{minOffsetAlignment}, blockSize{blockSize}
+  {
+    this->statisticsSourceId = this->engineDevice.getMemoryTracker().addStatisticsSource([this](MemoryReport &report) {
+      this->addStatistics(report);
+    });
+  }
+
+  EngineBufferPool::~EngineBufferPool() {
+    this->engineDevice.getMemoryTracker().removeStatisticsSource(this->statisticsSourceId);
+
+    // Slices only reference the pool, every one of them has to be gone before it
+    for (auto &&block : this->blocks) {
+      assert(vmaIsVirtualBlockEmpty(block.virtualBlock) && "buffer pool destroyed while slices of it are still alive");
+      vmaDestroyVirtualBlock(block.virtualBlock);
+    }
+  }
+
+  std::unique_ptr<EngineBufferSlice> EngineBufferPool::allocate(VkDeviceSize size, VkDeviceSize alignment) {
+    std::lock_guard<std::mutex> lock{this->mutex};
+
+    VmaVirtualAllocationCreateInfo allocationInfo{};
+    allocationInfo.size = size;
+    allocationInfo.alignment = std::max(alignment, this->minOffsetAlignment);
+
+    VmaVirtualAllocation allocation;
+    VkDeviceSize offset;
+
+    for (uint32_t i = 0; i < this->blocks.size(); i++) {
+      if (vmaVirtualAllocate(this->blocks[i].virtualBlock, &allocationInfo, &allocation, &offset) == VK_SUCCESS) {
+        return std::make_unique<EngineBufferSlice>(*this, i, allocation, *this->blocks[i].buffer, offset, size);
+      }
+    }
+
+    this->createBlock(std::max(size, this->blockSize));
+    auto blockIndex = static_cast<uint32_t>(this->blocks.size() - 1);
+
+    if (vmaVirtualAllocate(this->blocks[blockIndex].virtualBlock, &allocationInfo, &allocation, &offset) != VK_SUCCESS) {
+      throw std::runtime_error("failed to allocate from buffer pool!");
+    }
+
+    return std::make_unique<EngineBufferSlice>(*this, blockIndex, allocation, *this->blocks[blockIndex].buffer, offset, size);
+  }
+
+  void EngineBufferPool::addStatistics(MemoryReport &report) {
+    std::lock_guard<std::mutex> lock{this->mutex};
+    auto &categoryStats = report.categories[static_cast<uint32_t>(this->category)];
+
+    for (auto &&block : this->blocks) {
+      VmaStatistics statistics;
+      vmaGetVirtualBlockStatistics(block.virtualBlock, &statistics);
+
+      categoryStats.pooledBytes += statistics.blockBytes;
+      categoryStats.pooledUsedBytes += statistics.allocationBytes;
+    }
+  }
+
+  void EngineBufferPool::createBlock(VkDeviceSize size) {
+    // Transfer source as well, so the defragmenter can copy the block somewhere else
+    Block block;
+    block.buffer = std::make_unique<EngineBuffer>(
+      this->engineDevice,
+      size,
+      1,
+      this->bufferUsage | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+      VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+      0,
+      1,
+      this->category
+    );
+
+    VmaVirtualBlockCreateInfo blockInfo{};
+    blockInfo.size = size;
+
+    if (vmaCreateVirtualBlock(&blockInfo, &block.virtualBlock) != VK_SUCCESS) {
+      throw std::runtime_error("failed to create virtual block!");
+    }
+
+    this->blocks.emplace_back(std::move(block));
+  }
+
+  void EngineBufferPool::free(uint32_t blockIndex, VmaVirtualAllocation allocation) {
+    std::lock_guard<std::mutex> lock{this->mutex};
+    vmaVirtualFree(this->blocks[blockIndex].virtualBlock, allocation);
+  }
+} // namespace nugiEngine
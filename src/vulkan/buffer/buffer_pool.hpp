@@ -0,0 +1,92 @@
+#pragma once
+
+#include <vk_mem_alloc.h>
+
+#include "buffer.hpp"
+#include "../device/device.hpp"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace nugiEngine {
+  // Usage classes that get their own pool, resources of one class share the same few large buffers
+  enum class BufferPoolUsage : uint32_t {
+    Vertex,
+    Index,
+    Storage
+  };
+
+  class EngineBufferPool;
+
+  // A range of one pooled buffer, handed back to the pool when destroyed.
+  // Bind getBuffer() at getOffset(), the other resources of the pool live in the same buffer.
+  // The buffer handle changes when the defragmenter moves the block, so query it when recording.
+  class EngineBufferSlice {
+    public:
+      EngineBufferSlice(EngineBufferPool &pool, uint32_t blockIndex, VmaVirtualAllocation allocation, EngineBuffer &blockBuffer, VkDeviceSize offset, VkDeviceSize size);
+      ~EngineBufferSlice();
+
+      EngineBufferSlice(const EngineBufferSlice&) = delete;
+      EngineBufferSlice& operator = (const EngineBufferSlice&) = delete;
+
+      VkBuffer getBuffer() const { return this->blockBuffer.getBuffer(); }
+      VkDeviceSize getOffset() const { return this->offset; }
+      VkDeviceSize getSize() const { return this->size; }
+
+      VkDescriptorBufferInfo descriptorInfo() const { return VkDescriptorBufferInfo{ this->blockBuffer.getBuffer(), this->offset, this->size }; }
+
+    private:
+      EngineBufferPool &pool;
+      uint32_t blockIndex;
+      VmaVirtualAllocation allocation;
+
+      EngineBuffer &blockBuffer;
+      VkDeviceSize offset, size;
+  };
+
+  // Device local buffers of one usage class, suballocated through VMA virtual blocks. A new block is added when
+  // none of the existing ones has room, an allocation bigger than the block size gets a block of its own.
+  // Blocks are kept for the lifetime of the pool, which has to outlive every slice allocated from it.
+  // The defragmenter moves whole blocks, never slices inside of one, so a block has to fit into its per frame byte limit.
+  class EngineBufferPool {
+    public:
+      static constexpr VkDeviceSize DEFAULT_BLOCK_SIZE = 8 * 1024 * 1024;
+
+      EngineBufferPool(EngineDevice &device, VkBufferUsageFlags bufferUsage, MemoryCategory category, VkDeviceSize minOffsetAlignment = 16, VkDeviceSize blockSize = DEFAULT_BLOCK_SIZE);
+      ~EngineBufferPool();
+
+      EngineBufferPool(const EngineBufferPool&) = delete;
+      EngineBufferPool& operator = (const EngineBufferPool&) = delete;
+
+      std::unique_ptr<EngineBufferSlice> allocate(VkDeviceSize size, VkDeviceSize alignment = 1);
+
+      uint32_t getBlockCount() const { return static_cast<uint32_t>(this->blocks.size()); }
+      VkBufferUsageFlags getBufferUsage() const { return this->bufferUsage; }
+      MemoryCategory getCategory() const { return this->category; }
+
+    private:
+      struct Block {
+        std::unique_ptr<EngineBuffer> buffer;
+        VmaVirtualBlock virtualBlock;
+      };
+
+      EngineDevice &engineDevice;
+
+      VkBufferUsageFlags bufferUsage;
+      MemoryCategory category;
+      VkDeviceSize minOffsetAlignment;
+      VkDeviceSize blockSize;
+
+      std::vector<Block> blocks;
+      std::mutex mutex;
+
+      uint32_t statisticsSourceId;
+
+      void addStatistics(MemoryReport &report);
+      void createBlock(VkDeviceSize size);
+      void free(uint32_t blockIndex, VmaVirtualAllocation allocation);
+
+      friend class EngineBufferSlice;
+  };
+} // namespace nugiEngine
@@ -0,0 +1,61 @@
+#include "uniform_ring.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace nugiEngine {
+  EngineUniformRing::EngineUniformRing(EngineDevice &device, VkDeviceSize frameSize) : engineDevice{device} {
+    auto limits = this->engineDevice.getProperties().limits;
+
+    // Both limits are powers of two, the larger one satisfies uniform and storage bindings alike
+    this->alignment = std::max<VkDeviceSize>({ 16, limits.minUniformBufferOffsetAlignment, limits.minStorageBufferOffsetAlignment });
+    this->frameSize = (frameSize + this->alignment - 1) & ~(this->alignment - 1);
+
+    this->buffer = std::make_unique<EngineBuffer>(
+      this->engineDevice,
+      this->frameSize,
+      this->engineDevice.getFramesInFlight(),
+      VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+      VMA_MEMORY_USAGE_AUTO_PREFER_HOST,
+      VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
+      1,
+      MemoryCategory::Uniform
+    );
+
+    this->buffer->map();
+    this->mapped = static_cast<uint8_t*>(this->buffer->getMappedMemory());
+  }
+
+  void EngineUniformRing::beginFrame(uint32_t frameIndex) {
+    this->frameIndex = frameIndex;
+    this->frameHead = 0;
+  }
+
+  void EngineUniformRing::flush() {
+    VkDeviceSize usedSize = std::min(this->frameHead.load(), this->frameSize);
+
+    if (usedSize > 0) {
+      this->buffer->flush(usedSize, this->frameIndex * this->frameSize);
+    }
+  }
+
+  UniformRingAllocation EngineUniformRing::allocate(VkDeviceSize size) {
+    VkDeviceSize alignedSize = (size + this->alignment - 1) & ~(this->alignment - 1);
+    VkDeviceSize begin = this->frameHead.fetch_add(alignedSize);
+
+    if (begin + alignedSize > this->frameSize) {
+      throw std::runtime_error("uniform ring is full!");
+    }
+
+    VkDeviceSize offset = this->frameIndex * this->frameSize + begin;
+    return UniformRingAllocation{ this->mapped + offset, static_cast<uint32_t>(offset) };
+  }
+
+  uint32_t EngineUniformRing::push(const void *data, VkDeviceSize size) {
+    auto allocation = this->allocate(size);
+    memcpy(allocation.data, data, static_cast<size_t>(size));
+
+    return allocation.offset;
+  }
+} // namespace nugiEngine
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "buffer.hpp"
+#include "../device/device.hpp"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace nugiEngine {
+  struct UniformRingAllocation {
+    void *data;
+
+    // Dynamic offset to bind the allocation with, relative to the start of the ring buffer
+    uint32_t offset;
+  };
+
+  // One persistently mapped buffer for per-frame and per-draw constants, split into a region per frame in flight.
+  // Allocations bump a pointer inside the region of the current frame, which is rewound once the frame's timeline point has been
+  // waited on. Descriptors point at the whole ring with UNIFORM_BUFFER_DYNAMIC or STORAGE_BUFFER_DYNAMIC, and draws
+  // select their data through the dynamic offset, so no descriptor set is needed per allocation.
+  class EngineUniformRing {
+    public:
+      static constexpr VkDeviceSize DEFAULT_FRAME_SIZE = 4 * 1024 * 1024;
+
+      EngineUniformRing(EngineDevice &device, VkDeviceSize frameSize = DEFAULT_FRAME_SIZE);
+
+      EngineUniformRing(const EngineUniformRing&) = delete;
+      EngineUniformRing& operator = (const EngineUniformRing&) = delete;
+
+      // Rewind the region of frameIndex, its previous contents must not be in flight anymore
+      void beginFrame(uint32_t frameIndex);
+
+      // Make the writes of the current frame visible to the device, before its command buffers are submitted
+      void flush();
+
+      // Safe to call from several threads during a frame. Throws when the region of the frame is full.
+      UniformRingAllocation allocate(VkDeviceSize size);
+      uint32_t push(const void *data, VkDeviceSize size);
+
+      // Descriptor for a dynamic binding, range is the size of the struct the shader reads at each offset
+      VkDescriptorBufferInfo descriptorInfo(VkDeviceSize range) const { return VkDescriptorBufferInfo{ this->buffer->getBuffer(), 0, range }; }
+
+      VkBuffer getBuffer() const { return this->buffer->getBuffer(); }
+      VkDeviceSize getAlignment() const { return this->alignment; }
+      VkDeviceSize getFrameSize() const { return this->frameSize; }
+
+    private:
+      EngineDevice &engineDevice;
+      std::unique_ptr<EngineBuffer> buffer;
+      uint8_t *mapped = nullptr;
+
+      VkDeviceSize alignment;
+      VkDeviceSize frameSize;
+
+      uint32_t frameIndex = 0;
+      std::atomic<VkDeviceSize> frameHead{0};
+  };
+} // namespace nugiEngine
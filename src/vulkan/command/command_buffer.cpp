@@ -1,12 +1,14 @@
 #include "command_buffer.hpp"
+#include "../scheduler/gpu_scheduler.hpp"
 
 #include <iostream>
+#include <stdexcept>
 
 namespace nugiEngine {
 	EngineCommandBuffer::~EngineCommandBuffer() {
 		vkFreeCommandBuffers(
       this->appDevice.getLogicalDevice(), 
-      this->appDevice.getCommandPool(), 
+      this->commandPool, 
       1, 
       &this->commandBuffer
     );
@@ -36,16 +38,22 @@ namespace nugiEngine {
 	}
 
 	EngineCommandBuffer::EngineCommandBuffer(EngineDevice& device, VkCommandBuffer commandBuffer) 
-		: appDevice{device}, commandBuffer {commandBuffer} 
+		: appDevice{device}, commandPool{device.getCommandPool()}, commandBuffer {commandBuffer} 
 	{
 
 	}
 
-	EngineCommandBuffer::EngineCommandBuffer(EngineDevice& device) : appDevice{device} {
+	EngineCommandBuffer::EngineCommandBuffer(EngineDevice& device) : EngineCommandBuffer(device, device.getCommandPool(), VK_COMMAND_BUFFER_LEVEL_PRIMARY) {
+
+	}
+
+	EngineCommandBuffer::EngineCommandBuffer(EngineDevice& device, VkCommandPool commandPool, VkCommandBufferLevel level) 
+		: appDevice{device}, commandPool{commandPool} 
+	{
 		VkCommandBufferAllocateInfo allocInfo{};
 		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-		allocInfo.commandPool = this->appDevice.getCommandPool();
+		allocInfo.level = level;
+		allocInfo.commandPool = this->commandPool;
 		allocInfo.commandBufferCount = 1;
 
 		if (vkAllocateCommandBuffers(appDevice.getLogicalDevice(), &allocInfo, &this->commandBuffer) != VK_SUCCESS) {
@@ -72,6 +80,32 @@ namespace nugiEngine {
 		}
 	}
 
+	void EngineCommandBuffer::beginSecondaryCommand(VkCommandBufferInheritanceInfo inheritanceInfo) {
+		inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+		beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+		if (vkBeginCommandBuffer(this->commandBuffer, &beginInfo) != VK_SUCCESS) {
+			std::cerr << "Failed to start recording secondary command buffer" << '\n';
+		}
+	}
+
+	void EngineCommandBuffer::executeCommands(std::vector<std::shared_ptr<EngineCommandBuffer>> secondaryCommandBuffers) {
+		if (secondaryCommandBuffers.empty()) {
+			return;
+		}
+
+		std::vector<VkCommandBuffer> buffers;
+		for (auto &&secondaryCommandBuffer : secondaryCommandBuffers) {
+			buffers.emplace_back(secondaryCommandBuffer->getCommandBuffer());
+		}
+
+		vkCmdExecuteCommands(this->commandBuffer, static_cast<uint32_t>(buffers.size()), buffers.data());
+	}
+
 	void EngineCommandBuffer::endCommand() {
 		if (vkEndCommandBuffer(this->commandBuffer) != VK_SUCCESS) {
 			std::cerr << "Failed to end recording command buffer" << '\n';
@@ -107,10 +141,11 @@ namespace nugiEngine {
 		if (vkQueueSubmit(queue, 1, &submitInfo, fence) != VK_SUCCESS) {
 			std::cerr << "Failed to submitting command buffer" << '\n';
 		}
+	}
 
-		if (vkQueueWaitIdle(queue) != VK_SUCCESS) {
-			std::cerr << "Failed to waiting queue" << '\n';
-		}
+	void EngineCommandBuffer::submitCommandAndWait(QueueType queueType) {
+		auto &scheduler = this->appDevice.getScheduler();
+		scheduler.wait(scheduler.submit(queueType, { this->shared_from_this() }));
 	}
 
 	void EngineCommandBuffer::submitCommands(std::vector<std::shared_ptr<EngineCommandBuffer>> commandBuffers, VkQueue queue, std::vector<VkSemaphore> waitSemaphores, 
@@ -147,10 +182,5 @@ namespace nugiEngine {
 		if (vkQueueSubmit(queue, 1, &submitInfo, fence) != VK_SUCCESS) {
 			std::cerr << "Failed to submitting command buffer" << '\n';
 		}
-
-		if (vkQueueWaitIdle(queue) != VK_SUCCESS) {
-			std::cerr << "Failed to waiting queue" << '\n';
-		}
-		
 	}
 } // namespace nugiEngine
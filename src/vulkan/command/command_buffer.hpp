@@ -1,17 +1,21 @@
 #pragma once
 
 #include "../device/device.hpp"
+#include "../scheduler/timeline_point.hpp"
 
 #include <vector>
 #include <memory>
 
 namespace nugiEngine
 {
-  class EngineCommandBuffer {
+  class EngineCommandBuffer : public std::enable_shared_from_this<EngineCommandBuffer> {
     public:
       EngineCommandBuffer(EngineDevice& device, VkCommandBuffer commandBuffer);
       EngineCommandBuffer(EngineDevice& device);
 
+      // Allocated from a pool other than the device one, like the per thread pools of EngineParallelRecorder
+      EngineCommandBuffer(EngineDevice& device, VkCommandPool commandPool, VkCommandBufferLevel level);
+
       ~EngineCommandBuffer();
 
       EngineCommandBuffer(const EngineCommandBuffer&) = delete;
@@ -22,19 +26,36 @@ namespace nugiEngine
       void beginSingleTimeCommand();
       void beginReccuringCommand();
       void endCommand();
+
+      // Secondary command buffers continuing the render pass and subpass of inheritanceInfo
+      void beginSecondaryCommand(VkCommandBufferInheritanceInfo inheritanceInfo);
+
+      // Runs the secondary command buffers in order, inside a render pass begun with SECONDARY_COMMAND_BUFFERS contents
+      void executeCommands(std::vector<std::shared_ptr<EngineCommandBuffer>> secondaryCommandBuffers);
+
+      // Both return right after queueing the work, completion is observed through the fence or the signaled semaphores
       void submitCommand(VkQueue queue, std::vector<VkSemaphore> waitSemaphores = {}, 
         std::vector<VkPipelineStageFlags> waitStages = {}, std::vector<VkSemaphore> signalSemaphores = {}, 
         VkFence fence = VK_NULL_HANDLE);
 
+      // Submits through the scheduler and blocks until this submission has finished, for one-off work outside of the frame loop
+      void submitCommandAndWait(QueueType queueType);
+
       static void submitCommands(std::vector<std::shared_ptr<EngineCommandBuffer>> commandBuffers, VkQueue queue, std::vector<VkSemaphore> waitSemaphores = {}, 
         std::vector<VkPipelineStageFlags> waitStages = {}, std::vector<VkSemaphore> signalSemaphores = {}, 
         VkFence fence = VK_NULL_HANDLE);
 
       VkCommandBuffer getCommandBuffer() const { return this->commandBuffer; }
 
+      // Set by EngineGpuScheduler on submit, the command buffer can be reset or freed once this point is reached
+      TimelinePoint getLastUse() const { return this->lastUse; }
+      void setLastUse(TimelinePoint point) { this->lastUse = point; }
+
     private:
       EngineDevice& appDevice;
+      VkCommandPool commandPool;
       VkCommandBuffer commandBuffer;
+      TimelinePoint lastUse{};
   };
   
 } // namespace nugiEngine
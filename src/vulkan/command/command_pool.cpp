@@ -0,0 +1,76 @@
+#include "command_pool.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace nugiEngine {
+  EngineCommandPool::EngineCommandPool(EngineDevice &device, uint32_t queueFamilyIndex) : engineDevice{device} {
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.queueFamilyIndex = queueFamilyIndex;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+    if (vkCreateCommandPool(this->engineDevice.getLogicalDevice(), &poolInfo, nullptr, &this->commandPool) != VK_SUCCESS) {
+      throw std::runtime_error("failed to create command pool!");
+    }
+  }
+
+  EngineCommandPool::~EngineCommandPool() {
+    this->primaryList.commandBuffers.clear();
+    this->secondaryList.commandBuffers.clear();
+
+    vkDestroyCommandPool(this->engineDevice.getLogicalDevice(), this->commandPool, nullptr);
+  }
+
+  std::shared_ptr<EngineCommandBuffer> EngineCommandPool::acquire(VkCommandBufferLevel level) {
+    auto &freeList = level == VK_COMMAND_BUFFER_LEVEL_PRIMARY ? this->primaryList : this->secondaryList;
+
+    if (freeList.usedCount == freeList.commandBuffers.size()) {
+      freeList.commandBuffers.emplace_back(std::make_shared<EngineCommandBuffer>(this->engineDevice, this->commandPool, level));
+    }
+
+    return freeList.commandBuffers[freeList.usedCount++];
+  }
+
+  void EngineCommandPool::reset() {
+    if (this->primaryList.usedCount == 0 && this->secondaryList.usedCount == 0) {
+      return;
+    }
+
+    vkResetCommandPool(this->engineDevice.getLogicalDevice(), this->commandPool, 0);
+
+    this->primaryList.usedCount = 0;
+    this->secondaryList.usedCount = 0;
+  }
+
+  EngineFrameCommandAllocator::EngineFrameCommandAllocator(EngineDevice &device, uint32_t queueFamilyIndex, uint32_t threadCount) 
+    : threadCount{std::max(1u, threadCount)} 
+  {
+    this->commandPools.resize(device.getFramesInFlight());
+
+    for (auto &&framePools : this->commandPools) {
+      for (uint32_t i = 0; i < this->threadCount; i++) {
+        framePools.emplace_back(std::make_unique<EngineCommandPool>(device, queueFamilyIndex));
+      }
+    }
+  }
+
+  uint32_t EngineFrameCommandAllocator::defaultThreadCount() {
+    uint32_t hardwareCount = std::thread::hardware_concurrency();
+
+    // Keep one core for the window thread, the render thread records too
+    return hardwareCount > 1u ? hardwareCount - 1u : 1u;
+  }
+
+  void EngineFrameCommandAllocator::beginFrame(uint32_t frameIndex) {
+    this->frameIndex = frameIndex;
+
+    for (auto &&commandPool : this->commandPools[frameIndex]) {
+      commandPool->reset();
+    }
+  }
+
+  std::shared_ptr<EngineCommandBuffer> EngineFrameCommandAllocator::acquire(uint32_t threadIndex, VkCommandBufferLevel level) {
+    return this->commandPools[this->frameIndex][threadIndex]->acquire(level);
+  }
+} // namespace nugiEngine
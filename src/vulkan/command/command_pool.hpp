@@ -0,0 +1,68 @@
+#pragma once
+
+#include "command_buffer.hpp"
+#include "../device/device.hpp"
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace nugiEngine {
+  // A transient command pool whose command buffers are never freed one by one. They are handed out front to back
+  // from a list that only grows, and reset() rewinds the list after resetting the whole pool with vkResetCommandPool,
+  // so once the list has grown to a frame's needs recording allocates nothing.
+  class EngineCommandPool {
+    public:
+      EngineCommandPool(EngineDevice &device, uint32_t queueFamilyIndex);
+      ~EngineCommandPool();
+
+      EngineCommandPool(const EngineCommandPool&) = delete;
+      EngineCommandPool& operator = (const EngineCommandPool&) = delete;
+
+      // Valid until the next reset, do not keep it beyond that
+      std::shared_ptr<EngineCommandBuffer> acquire(VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+
+      // Every command buffer handed out since the last reset must have finished on the GPU
+      void reset();
+
+      VkCommandPool getCommandPool() const { return this->commandPool; }
+
+    private:
+      struct FreeList {
+        std::vector<std::shared_ptr<EngineCommandBuffer>> commandBuffers;
+        uint32_t usedCount = 0;
+      };
+
+      EngineDevice &engineDevice;
+      VkCommandPool commandPool;
+
+      FreeList primaryList, secondaryList;
+  };
+
+  // One EngineCommandPool per frame in flight and per recording thread, all for the queue family they are submitted to.
+  // A pool is only used by its thread, and all pools of a frame are reset together once the previous submission of that frame has finished.
+  class EngineFrameCommandAllocator {
+    public:
+      EngineFrameCommandAllocator(EngineDevice &device, uint32_t queueFamilyIndex, uint32_t threadCount = defaultThreadCount());
+
+      EngineFrameCommandAllocator(const EngineFrameCommandAllocator&) = delete;
+      EngineFrameCommandAllocator& operator = (const EngineFrameCommandAllocator&) = delete;
+
+      // Called once the timeline point of frameIndex was waited on
+      void beginFrame(uint32_t frameIndex);
+
+      std::shared_ptr<EngineCommandBuffer> acquire(uint32_t threadIndex, VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+
+      uint32_t getThreadCount() const { return this->threadCount; }
+      uint32_t getFrameIndex() const { return this->frameIndex; }
+
+      static uint32_t defaultThreadCount();
+
+    private:
+      uint32_t threadCount;
+      uint32_t frameIndex = 0;
+
+      // Indexed by frame, then by thread
+      std::vector<std::vector<std::unique_ptr<EngineCommandPool>>> commandPools;
+  };
+} // namespace nugiEngine
@@ -0,0 +1,126 @@
+#include "parallel_recorder.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace nugiEngine {
+  EngineParallelRecorder::EngineParallelRecorder(EngineFrameCommandAllocator &commandAllocator, uint32_t minItemsPerSlice) 
+    : commandAllocator{commandAllocator}, threadCount{commandAllocator.getThreadCount()}, minItemsPerSlice{std::max(1u, minItemsPerSlice)}
+  {
+    for (uint32_t i = 1; i < this->threadCount; i++) {
+      this->workers.emplace_back(&EngineParallelRecorder::runWorker, this, i);
+    }
+  }
+
+  EngineParallelRecorder::~EngineParallelRecorder() {
+    {
+      std::lock_guard<std::mutex> lock{this->mutex};
+      this->isStopping = true;
+    }
+
+    this->jobCondition.notify_all();
+
+    for (auto &&worker : this->workers) {
+      worker.join();
+    }
+  }
+
+  std::vector<std::shared_ptr<EngineCommandBuffer>> EngineParallelRecorder::record(uint32_t itemCount, VkCommandBufferInheritanceInfo inheritanceInfo, 
+    RecordFunction recordFunction)
+  {
+    if (itemCount == 0) {
+      return {};
+    }
+
+    // Small lists are not worth waking the other threads
+    uint32_t sliceCount = std::min(this->threadCount, (itemCount + this->minItemsPerSlice - 1) / this->minItemsPerSlice);
+    uint32_t sliceSize = (itemCount + sliceCount - 1) / sliceCount;
+    sliceCount = (itemCount + sliceSize - 1) / sliceSize;
+
+    {
+      std::lock_guard<std::mutex> lock{this->mutex};
+
+      this->jobItemCount = itemCount;
+      this->jobSliceCount = sliceCount;
+      this->jobSliceSize = sliceSize;
+      this->jobInheritanceInfo = inheritanceInfo;
+      this->jobRecordFunction = recordFunction;
+      this->jobCommandBuffers.assign(sliceCount, nullptr);
+
+      this->pendingSliceCount = sliceCount - 1;
+      this->jobGeneration++;
+    }
+
+    if (sliceCount > 1) {
+      this->jobCondition.notify_all();
+    }
+
+    std::exception_ptr error = this->recordSlice(0);
+
+    {
+      std::unique_lock<std::mutex> lock{this->mutex};
+      this->doneCondition.wait(lock, [this]() { return this->pendingSliceCount == 0; });
+
+      if (error == nullptr) {
+        error = this->jobError;
+      }
+
+      this->jobError = nullptr;
+      this->jobRecordFunction = nullptr;
+    }
+
+    if (error != nullptr) {
+      std::rethrow_exception(error);
+    }
+
+    return std::move(this->jobCommandBuffers);
+  }
+
+  void EngineParallelRecorder::runWorker(uint32_t threadIndex) {
+    uint64_t seenGeneration = 0;
+
+    while (true) {
+      std::unique_lock<std::mutex> lock{this->mutex};
+      this->jobCondition.wait(lock, [this, seenGeneration]() { return this->isStopping || this->jobGeneration != seenGeneration; });
+
+      if (this->isStopping) {
+        return;
+      }
+
+      seenGeneration = this->jobGeneration;
+      if (threadIndex >= this->jobSliceCount) {
+        continue;
+      }
+
+      lock.unlock();
+      std::exception_ptr error = this->recordSlice(threadIndex);
+      lock.lock();
+
+      if (error != nullptr && this->jobError == nullptr) {
+        this->jobError = error;
+      }
+
+      if (--this->pendingSliceCount == 0) {
+        this->doneCondition.notify_one();
+      }
+    }
+  }
+
+  std::exception_ptr EngineParallelRecorder::recordSlice(uint32_t sliceIndex) {
+    // The job fields stay untouched until this slice is counted as done, and only this slice writes its command buffer entry
+    uint32_t firstItem = sliceIndex * this->jobSliceSize;
+
+    try {
+      auto commandBuffer = this->commandAllocator.acquire(sliceIndex, VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+      this->jobCommandBuffers[sliceIndex] = commandBuffer;
+
+      commandBuffer->beginSecondaryCommand(this->jobInheritanceInfo);
+      this->jobRecordFunction(commandBuffer, firstItem, std::min(this->jobSliceSize, this->jobItemCount - firstItem));
+      commandBuffer->endCommand();
+    } catch (...) {
+      return std::current_exception();
+    }
+
+    return nullptr;
+  }
+} // namespace nugiEngine
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "command_buffer.hpp"
+#include "command_pool.hpp"
+#include "../device/device.hpp"
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace nugiEngine {
+  // Splits a list of draws into contiguous slices and records each slice into its own secondary command buffer,
+  // one slice per thread. Slice i is recorded by thread i from its own pool of the frame command allocator, so recording
+  // needs no locking. The calling thread records the first slice.
+  class EngineParallelRecorder {
+    public:
+      // Record the draws [firstItem, firstItem + itemCount). Secondary command buffers inherit no state,
+      // so the function binds the pipeline, descriptors, buffers and dynamic state itself.
+      using RecordFunction = std::function<void(std::shared_ptr<EngineCommandBuffer> commandBuffer, uint32_t firstItem, uint32_t itemCount)>;
+
+      EngineParallelRecorder(EngineFrameCommandAllocator &commandAllocator, uint32_t minItemsPerSlice = 512);
+      ~EngineParallelRecorder();
+
+      EngineParallelRecorder(const EngineParallelRecorder&) = delete;
+      EngineParallelRecorder& operator = (const EngineParallelRecorder&) = delete;
+
+      // Blocks until every slice is recorded and returns the secondary command buffers in slice order, ready for
+      // EngineCommandBuffer::executeCommands. They belong to the current frame of the command allocator.
+      std::vector<std::shared_ptr<EngineCommandBuffer>> record(uint32_t itemCount, VkCommandBufferInheritanceInfo inheritanceInfo, 
+        RecordFunction recordFunction);
+
+      uint32_t getThreadCount() const { return this->threadCount; }
+
+    private:
+      EngineFrameCommandAllocator &commandAllocator;
+
+      uint32_t threadCount;
+      uint32_t minItemsPerSlice;
+
+      std::vector<std::thread> workers;
+      std::mutex mutex;
+      std::condition_variable jobCondition, doneCondition;
+
+      // The job currently being recorded, replaced only once every slice of the previous one is done
+      uint64_t jobGeneration = 0;
+      uint32_t jobItemCount = 0;
+      uint32_t jobSliceCount = 0;
+      uint32_t jobSliceSize = 0;
+      VkCommandBufferInheritanceInfo jobInheritanceInfo{};
+      RecordFunction jobRecordFunction;
+      std::vector<std::shared_ptr<EngineCommandBuffer>> jobCommandBuffers;
+
+      uint32_t pendingSliceCount = 0;
+      std::exception_ptr jobError;
+      bool isStopping = false;
+
+      void runWorker(uint32_t threadIndex);
+      std::exception_ptr recordSlice(uint32_t sliceIndex);
+  };
+} // namespace nugiEngine
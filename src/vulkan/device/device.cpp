@@ -1,9 +1,17 @@
 #include "device.hpp"
+#include "../staging/staging_ring.hpp"
+#include "../buffer/buffer_pool.hpp"
+#include "../buffer/uniform_ring.hpp"
+#include "../memory/memory_tracker.hpp"
+#include "../memory/defragmenter.hpp"
+#include "../scheduler/gpu_scheduler.hpp"
+#include "../upload/transfer_uploader.hpp"
 
 #define VMA_IMPLEMENTATION
 #include "vk_mem_alloc.h"
 
 // std headers
+#include <algorithm>
 #include <cstring>
 #include <iostream>
 #include <set>
@@ -52,7 +60,13 @@ namespace nugiEngine {
   }
 
   // class member functions
-  EngineDevice::EngineDevice(EngineWindow &window) : window{window} {
+  EngineDevice::EngineDevice(EngineWindow &window, uint32_t framesInFlight, VkDeviceSize stagingRingSize) 
+    : window{window}, framesInFlight{framesInFlight}, stagingRingSize{stagingRingSize} 
+  {
+    if (framesInFlight == 0 || framesInFlight > EngineDevice::MAX_FRAMES_IN_FLIGHT) {
+      throw std::runtime_error("frames in flight must be between 1 and " + std::to_string(EngineDevice::MAX_FRAMES_IN_FLIGHT) + "!");
+    }
+
     this->createInstance();
     this->setupDebugMessenger();
     this->createSurface();
@@ -61,9 +75,20 @@ namespace nugiEngine {
     this->createLogicalDevice();
     this->createMemoryAllocator();
     this->createCommandPool();
+
+    this->scheduler = std::make_unique<EngineGpuScheduler>(*this);
   }
 
   EngineDevice::~EngineDevice() {
+    // Stops its worker first, which still stages through the ring and submits through the scheduler
+    this->transferUploader.reset();
+    this->stagingRing.reset();
+    this->uniformRing.reset();
+    this->bufferPools.clear();
+    this->defragmenter.reset();
+    this->scheduler.reset();
+    this->memoryTracker.reset();
+
     vmaDestroyAllocator(this->allocator);
     vkDestroyCommandPool(this->device, this->commandPool, nullptr);
     vkDestroyDevice(this->device, nullptr);
@@ -76,6 +101,61 @@ namespace nugiEngine {
     vkDestroyInstance(this->instance, nullptr);
   }
 
+  EngineStagingRing& EngineDevice::getStagingRing() {
+    if (this->stagingRing == nullptr) {
+      this->stagingRing = std::make_unique<EngineStagingRing>(*this, this->stagingRingSize);
+    }
+
+    return *this->stagingRing;
+  }
+
+  EngineTransferUploader& EngineDevice::getTransferUploader() {
+    if (this->transferUploader == nullptr) {
+      this->transferUploader = std::make_unique<EngineTransferUploader>(*this, this->stagingRingSize);
+    }
+
+    return *this->transferUploader;
+  }
+
+  bool EngineDevice::isTransferIdle() {
+    return this->transferUploader == nullptr || this->transferUploader->isIdle();
+  }
+
+  EngineBufferPool& EngineDevice::getBufferPool(BufferPoolUsage usage) {
+    auto poolIndex = static_cast<uint32_t>(usage);
+
+    if (poolIndex >= this->bufferPools.size()) {
+      this->bufferPools.resize(poolIndex + 1);
+    }
+
+    if (this->bufferPools[poolIndex] == nullptr) {
+      switch (usage) {
+        case BufferPoolUsage::Vertex:
+          this->bufferPools[poolIndex] = std::make_unique<EngineBufferPool>(*this, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, MemoryCategory::Geometry);
+          break;
+
+        case BufferPoolUsage::Index:
+          this->bufferPools[poolIndex] = std::make_unique<EngineBufferPool>(*this, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, MemoryCategory::Geometry);
+          break;
+
+        case BufferPoolUsage::Storage:
+          this->bufferPools[poolIndex] = std::make_unique<EngineBufferPool>(*this, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, MemoryCategory::Storage,
+            std::max<VkDeviceSize>(16, this->properties.limits.minStorageBufferOffsetAlignment));
+          break;
+      }
+    }
+
+    return *this->bufferPools[poolIndex];
+  }
+
+  EngineUniformRing& EngineDevice::getUniformRing() {
+    if (this->uniformRing == nullptr) {
+      this->uniformRing = std::make_unique<EngineUniformRing>(*this);
+    }
+
+    return *this->uniformRing;
+  }
+
   void EngineDevice::createInstance() {
     if (enableValidationLayers && !this->checkValidationLayerSupport()) {
       throw std::runtime_error("validation layers requested, but not available!");
@@ -154,29 +234,26 @@ namespace nugiEngine {
       this->familyIndices.transferFamily
     };
 
-    std::vector<float> queuePriority;
-
-    for (int i = 0; i < EngineDevice::MAX_FRAMES_IN_FLIGHT; i++) {
-      if (i == 0) {
-        queuePriority.emplace_back(1.0f);
-      } else {
-        queuePriority.emplace_back(queuePriority[i - 1] * 0.5f);
-      }
-    }
+    float queuePriority = 1.0f;
 
     for (uint32_t queueFamily : uniqueQueueFamilies) {
       VkDeviceQueueCreateInfo queueCreateInfo = {};
       queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
       queueCreateInfo.queueFamilyIndex = queueFamily;
-      queueCreateInfo.queueCount = static_cast<uint32_t>(queuePriority.size());
-      queueCreateInfo.pQueuePriorities = queuePriority.data();
+      queueCreateInfo.queueCount = 1;
+      queueCreateInfo.pQueuePriorities = &queuePriority;
       queueCreateInfos.push_back(queueCreateInfo);
     }
 
+    VkPhysicalDeviceFeatures supportedFeatures;
+    vkGetPhysicalDeviceFeatures(this->physicalDevice, &supportedFeatures);
+
     VkPhysicalDeviceFeatures deviceFeatures = {};
     deviceFeatures.samplerAnisotropy = VK_TRUE;
     deviceFeatures.sampleRateShading = VK_TRUE;
     deviceFeatures.fragmentStoresAndAtomics = VK_TRUE;
+    deviceFeatures.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+    deviceFeatures.drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
 
     VkDeviceCreateInfo createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -184,9 +261,23 @@ namespace nugiEngine {
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
 
+    // Optional, without it VMA estimates the heap budgets from its own allocations
+    std::vector<const char *> enabledExtensions = deviceExtensions;
+    this->memoryBudgetEnabled = this->isDeviceExtensionSupported(this->physicalDevice, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
+    if (this->memoryBudgetEnabled) {
+      enabledExtensions.emplace_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
+
+    // Core since Vulkan 1.2, required for the per queue timelines of the scheduler
+    VkPhysicalDeviceVulkan12Features vulkan12Features{};
+    vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    vulkan12Features.timelineSemaphore = VK_TRUE;
+
+    createInfo.pNext = &vulkan12Features;
     createInfo.pEnabledFeatures = &deviceFeatures;
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-    createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+    createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 
     // might not really be necessary anymore because device specific validation layers
     // have been deprecated
@@ -201,17 +292,12 @@ namespace nugiEngine {
       throw std::runtime_error("failed to create logical device!");
     }
 
-    this->graphicsQueue.resize(EngineDevice::MAX_FRAMES_IN_FLIGHT);
-    this->presentQueue.resize(EngineDevice::MAX_FRAMES_IN_FLIGHT);
-    this->computeQueue.resize(EngineDevice::MAX_FRAMES_IN_FLIGHT);
-    this->transferQueue.resize(EngineDevice::MAX_FRAMES_IN_FLIGHT);
+    this->enabledFeatures = deviceFeatures;
 
-    for (int i = 0; i < EngineDevice::MAX_FRAMES_IN_FLIGHT; i++) {
-      vkGetDeviceQueue(this->device, this->familyIndices.graphicsFamily, i, &this->graphicsQueue[i]);
-      vkGetDeviceQueue(this->device, this->familyIndices.presentFamily, i, &this->presentQueue[i]);
-      vkGetDeviceQueue(this->device, this->familyIndices.computeFamily, i, &this->computeQueue[i]);
-      vkGetDeviceQueue(this->device, this->familyIndices.transferFamily, i, &this->transferQueue[i]);
-    }
+    vkGetDeviceQueue(this->device, this->familyIndices.graphicsFamily, 0, &this->graphicsQueue);
+    vkGetDeviceQueue(this->device, this->familyIndices.presentFamily, 0, &this->presentQueue);
+    vkGetDeviceQueue(this->device, this->familyIndices.computeFamily, 0, &this->computeQueue);
+    vkGetDeviceQueue(this->device, this->familyIndices.transferFamily, 0, &this->transferQueue);
   }
 
   void EngineDevice::createMemoryAllocator() {
@@ -222,9 +308,16 @@ namespace nugiEngine {
     allocatorCreateInfo.instance = this->instance;
     allocatorCreateInfo.pVulkanFunctions = nullptr;
 
+    if (this->memoryBudgetEnabled) {
+      allocatorCreateInfo.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+    }
+
     if (vmaCreateAllocator(&allocatorCreateInfo, &allocator) != VK_SUCCESS) {
       throw std::runtime_error("failed to create memory allocator!");
     }
+
+    this->memoryTracker = std::make_unique<EngineMemoryTracker>(this->allocator);
+    this->defragmenter = std::make_unique<EngineDefragmenter>(*this);
   }
 
   void EngineDevice::createCommandPool() {
@@ -260,7 +353,19 @@ namespace nugiEngine {
     vkGetPhysicalDeviceFeatures(device, &supportedFeatures);
 
     return indices.isComplete() && extensionsSupported && swapChainAdequate && 
-      supportedFeatures.samplerAnisotropy;
+      supportedFeatures.samplerAnisotropy && this->isTimelineSemaphoreSupported(device);
+  }
+
+  bool EngineDevice::isTimelineSemaphoreSupported(VkPhysicalDevice device) {
+    VkPhysicalDeviceVulkan12Features vulkan12Features{};
+    vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+    VkPhysicalDeviceFeatures2 features{};
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features.pNext = &vulkan12Features;
+
+    vkGetPhysicalDeviceFeatures2(device, &features);
+    return vulkan12Features.timelineSemaphore == VK_TRUE;
   }
 
   void EngineDevice::populateDebugMessengerCreateInfo(
@@ -368,6 +473,27 @@ namespace nugiEngine {
     return requiredExtensions.empty();
   }
 
+  bool EngineDevice::isDeviceExtensionSupported(VkPhysicalDevice device, const char *extensionName) {
+    uint32_t extensionCount;
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+    std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(
+      device,
+      nullptr,
+      &extensionCount,
+      availableExtensions.data()
+    );
+
+    for (const auto &extension : availableExtensions) {
+      if (strcmp(extension.extensionName, extensionName) == 0) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
   QueueFamilyIndices EngineDevice::findQueueFamilies(VkPhysicalDevice device) {
     QueueFamilyIndices indices;
 
@@ -379,29 +505,35 @@ namespace nugiEngine {
 
     int i = 0;
     for (const auto &queueFamily : queueFamilies) {
-      if (queueFamily.queueCount > 0 && queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+      if (queueFamily.queueCount > 0 && queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT && !indices.graphicsFamilyHasValue) {
         indices.graphicsFamily = i;
         indices.graphicsFamilyHasValue = true;
       }
 
-      if (queueFamily.queueCount > 0 && queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT) {
+      // A family without graphics runs compute work asynchronously to the graphics queue, keep looking for one
+      bool isAsyncCompute = !(queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT);
+      if (queueFamily.queueCount > 0 && queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT && (!indices.computeFamilyHasValue || (isAsyncCompute && !indices.asyncComputeFamilyHasValue))) {
         indices.computeFamily = i;
         indices.computeFamilyHasValue = true;
+        indices.asyncComputeFamilyHasValue = isAsyncCompute;
       }
 
-      if (queueFamily.queueCount > 0 && queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT) {
+      // Same for a transfer only family, its copy engine streams uploads beside rendering
+      bool isDedicatedTransfer = !(queueFamily.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT));
+      if (queueFamily.queueCount > 0 && queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT && (!indices.transferFamilyHasValue || (isDedicatedTransfer && !indices.dedicatedTransferFamilyHasValue))) {
         indices.transferFamily = i;
         indices.transferFamilyHasValue = true;
+        indices.dedicatedTransferFamilyHasValue = isDedicatedTransfer;
       }
 
       VkBool32 presentSupport = false;
       vkGetPhysicalDeviceSurfaceSupportKHR(device, i, this->surface, &presentSupport);
-      if (queueFamily.queueCount > 0 && presentSupport) {
+      if (queueFamily.queueCount > 0 && presentSupport && !indices.presentFamilyHasValue) {
         indices.presentFamily = i;
         indices.presentFamilyHasValue = true;
       }
 
-      if (indices.isComplete()) {
+      if (indices.isComplete() && indices.asyncComputeFamilyHasValue && indices.dedicatedTransferFamilyHasValue) {
         break;
       }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 // std lib headers
+#include <memory>
 #include <string>
 #include <vector>
 #include <vk_mem_alloc.h>
@@ -25,9 +26,24 @@ namespace nugiEngine {
     bool computeFamilyHasValue = false;
     bool transferFamilyHasValue = false;
 
+    // computeFamily has no graphics support, its queue runs beside the graphics one
+    bool asyncComputeFamilyHasValue = false;
+
+    // transferFamily has neither graphics nor compute support, usually a copy engine of its own
+    bool dedicatedTransferFamilyHasValue = false;
+
     bool isComplete() { return graphicsFamilyHasValue && presentFamilyHasValue && computeFamilyHasValue && transferFamilyHasValue; }
   };
 
+  class EngineStagingRing;
+  class EngineBufferPool;
+  class EngineUniformRing;
+  class EngineMemoryTracker;
+  class EngineDefragmenter;
+  class EngineGpuScheduler;
+  class EngineTransferUploader;
+  enum class BufferPoolUsage : uint32_t;
+
   class EngineDevice {
     public:
     #ifdef NDEBUG
@@ -36,9 +52,13 @@ namespace nugiEngine {
       const bool enableValidationLayers = true;
     #endif
 
-      static constexpr int MAX_FRAMES_IN_FLIGHT = 1;
+      // Frames the CPU may record ahead of the GPU, each with its own command buffers, timeline point and per-frame data
+      static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 4;
+      static constexpr uint32_t DEFAULT_FRAMES_IN_FLIGHT = 2;
 
-      EngineDevice(EngineWindow &window);
+      static constexpr VkDeviceSize DEFAULT_STAGING_RING_SIZE = 64 * 1024 * 1024;
+
+      EngineDevice(EngineWindow &window, uint32_t framesInFlight = DEFAULT_FRAMES_IN_FLIGHT, VkDeviceSize stagingRingSize = DEFAULT_STAGING_RING_SIZE);
       ~EngineDevice();
       
       VkDevice getLogicalDevice() const { return this->device; }
@@ -48,16 +68,45 @@ namespace nugiEngine {
       VkCommandPool getCommandPool() const { return this->commandPool; }
       VkSurfaceKHR getSurface() const { return this->surface; }
 
-      VkQueue getGraphicsQueue(uint32_t index) const { return this->graphicsQueue[index]; }
-      VkQueue getPresentQueue(uint32_t index) const { return this->presentQueue[index]; }
-      VkQueue getComputeQueue(uint32_t index) const { return this->computeQueue[index]; }
-      VkQueue getTransferQueue(uint32_t index) const { return this->transferQueue[index]; }
+      uint32_t getFramesInFlight() const { return this->framesInFlight; }
+
+      // One queue per family, shared by every frame in flight
+      VkQueue getGraphicsQueue() const { return this->graphicsQueue; }
+      VkQueue getPresentQueue() const { return this->presentQueue; }
+      VkQueue getComputeQueue() const { return this->computeQueue; }
+      VkQueue getTransferQueue() const { return this->transferQueue; }
 
       QueueFamilyIndices getFamilyIndices() const { return this->familyIndices; }
       
       VkPhysicalDeviceProperties getProperties() const { return this->properties; }
+      VkPhysicalDeviceFeatures getEnabledFeatures() const { return this->enabledFeatures; }
       VkSampleCountFlagBits getMSAASamples() const { return this->msaaSamples; }
 
+      // Shared by the upload batches of the render thread, created on first use. The transfer uploader stages through a ring of its own.
+      EngineStagingRing& getStagingRing();
+
+      // One pool per usage class for long lived device local buffers, created on first use
+      EngineBufferPool& getBufferPool(BufferPoolUsage usage);
+
+      // Per-frame and per-draw constants bound through dynamic offsets, created on first use
+      EngineUniformRing& getUniformRing();
+
+      // Per category bookkeeping and budgets of every buffer and image allocation
+      EngineMemoryTracker& getMemoryTracker() { return *this->memoryTracker; }
+      bool isMemoryBudgetEnabled() const { return this->memoryBudgetEnabled; }
+
+      // Moves device local resources to compact the heaps, driven once per frame by the render loop
+      EngineDefragmenter& getDefragmenter() { return *this->defragmenter; }
+
+      // Timeline semaphore per queue, every frame and upload submission goes through it
+      EngineGpuScheduler& getScheduler() { return *this->scheduler; }
+
+      // Background uploads on the transfer queue, created on first use
+      EngineTransferUploader& getTransferUploader();
+
+      // No transfer upload is queued, in flight or waiting for its destination queue to take it over
+      bool isTransferIdle();
+
       SwapChainSupportDetails getSwapChainSupport() { return this->querySwapChainSupport(this->physicalDevice); }
       QueueFamilyIndices findPhysicalQueueFamilies() { return this->findQueueFamilies(this->physicalDevice); }
       uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
@@ -76,6 +125,8 @@ namespace nugiEngine {
       // helper creation functions
       bool isDeviceSuitable(VkPhysicalDevice device);
       bool checkDeviceExtensionSupport(VkPhysicalDevice device);
+      bool isDeviceExtensionSupported(VkPhysicalDevice device, const char *extensionName);
+      bool isTimelineSemaphoreSupported(VkPhysicalDevice device);
       bool checkValidationLayerSupport();
       void populateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT &createInfo);
       void hasGflwRequiredInstanceExtensions();
@@ -92,6 +143,7 @@ namespace nugiEngine {
       VkDevice device;
       VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
       VkPhysicalDeviceProperties properties;
+      VkPhysicalDeviceFeatures enabledFeatures{};
 
       // window system
       EngineWindow &window;
@@ -99,12 +151,30 @@ namespace nugiEngine {
 
       // memory allocator
       VmaAllocator allocator;
+      std::unique_ptr<EngineMemoryTracker> memoryTracker;
+      std::unique_ptr<EngineDefragmenter> defragmenter;
+      bool memoryBudgetEnabled = false;
 
       // command pool
       VkCommandPool commandPool;
 
+      // staging
+      VkDeviceSize stagingRingSize;
+      std::unique_ptr<EngineStagingRing> stagingRing;
+      std::unique_ptr<EngineTransferUploader> transferUploader;
+
+      // buffer pool, indexed by BufferPoolUsage
+      std::vector<std::unique_ptr<EngineBufferPool>> bufferPools;
+
+      // dynamic uniform ring
+      std::unique_ptr<EngineUniformRing> uniformRing;
+
       // queue
-      std::vector<VkQueue> graphicsQueue, presentQueue, computeQueue, transferQueue;
+      VkQueue graphicsQueue, presentQueue, computeQueue, transferQueue;
+      std::unique_ptr<EngineGpuScheduler> scheduler;
+
+      // frames in flight
+      uint32_t framesInFlight;
 
       // Queue Family Index
       QueueFamilyIndices familyIndices;
@@ -1,10 +1,13 @@
 #include "image.hpp"
 
+#include <algorithm>
+#include <vector>
+
 namespace nugiEngine {
   EngineImage::EngineImage(EngineDevice &appDevice, uint32_t width, uint32_t height, uint32_t mipLevels, VkSampleCountFlagBits numSamples, 
     VkFormat format, VkImageTiling tiling, VkImageUsageFlags imageUsage, VmaMemoryUsage memoryUsage, VmaAllocationCreateFlags memoryPropertyFlags, 
-    VkImageAspectFlags aspectFlags) 
-    : appDevice{appDevice}, height{height}, width{width}, mipLevels{mipLevels}, format{format}, aspectFlags{aspectFlags} 
+    VkImageAspectFlags aspectFlags, MemoryCategory category) 
+    : appDevice{appDevice}, height{height}, width{width}, mipLevels{mipLevels}, format{format}, aspectFlags{aspectFlags}, category{category} 
   {
     this->createImage(numSamples, tiling, imageUsage, memoryUsage, memoryPropertyFlags);
     this->createImageView();
@@ -22,8 +25,16 @@ namespace nugiEngine {
   EngineImage::~EngineImage() {
     vkDestroyImageView(this->appDevice.getLogicalDevice(), this->imageView, nullptr);
 
-    if (this->isImageCreatedByUs) {
+    // While being moved the allocation belongs to the defragmentation pass, only the handles are ours
+    if (this->isDefragmentable && this->appDevice.getDefragmenter().cancel(this)) {
+      vkDestroyImageView(this->appDevice.getLogicalDevice(), this->movedImageView, nullptr);
+      vkDestroyImage(this->appDevice.getLogicalDevice(), this->movedImage, nullptr);
       vkDestroyImage(this->appDevice.getLogicalDevice(), this->image, nullptr);
+
+      this->appDevice.getMemoryTracker().onFree(this->category, this->allocationInfo.size);
+    } else if (this->isImageCreatedByUs) {
+      vmaDestroyImage(this->appDevice.getMemoryAllocator(), this->image, this->allocation);
+      this->appDevice.getMemoryTracker().onFree(this->category, this->allocationInfo.size);
     }
   }
 
@@ -43,12 +54,57 @@ namespace nugiEngine {
     imageInfo.samples = numSamples;
     imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
+    if (vkCreateImage(this->appDevice.getLogicalDevice(), &imageInfo, nullptr, &this->image) != VK_SUCCESS) {
+      throw std::runtime_error("failed to create image!");
+    }
+
+    // The image exists before its memory, so the budget is checked against the real size
+    VkMemoryRequirements memoryRequirements;
+    vkGetImageMemoryRequirements(this->appDevice.getLogicalDevice(), this->image, &memoryRequirements);
+
+    auto &memoryTracker = this->appDevice.getMemoryTracker();
+
     VmaAllocationCreateInfo allocInfo{};
     allocInfo.usage = memoryUsage;
-    allocInfo.flags = memoryPropertyFlags;
+    allocInfo.flags = memoryPropertyFlags | VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT;
 
-    if (vmaCreateImage(this->appDevice.getMemoryAllocator(), &imageInfo, &allocInfo, &this->image, &this->allocation, &this->allocationInfo) != VK_SUCCESS) {
-      throw std::runtime_error("failed to create image!");
+    try {
+      memoryTracker.reserve(this->category, memoryRequirements.size);
+    } catch (...) {
+      vkDestroyImage(this->appDevice.getLogicalDevice(), this->image, nullptr);
+      throw;
+    }
+
+    VkResult result = vmaAllocateMemoryForImage(this->appDevice.getMemoryAllocator(), this->image, &allocInfo, &this->allocation, &this->allocationInfo);
+
+    // Over the heap budget, retry once if something could be evicted
+    if (result == VK_ERROR_OUT_OF_DEVICE_MEMORY && memoryTracker.evict(this->category, memoryRequirements.size)) {
+      result = vmaAllocateMemoryForImage(this->appDevice.getMemoryAllocator(), this->image, &allocInfo, &this->allocation, &this->allocationInfo);
+    }
+
+    if (result != VK_SUCCESS || vmaBindImageMemory(this->appDevice.getMemoryAllocator(), this->allocation, this->image) != VK_SUCCESS) {
+      if (result == VK_SUCCESS) {
+        vmaFreeMemory(this->appDevice.getMemoryAllocator(), this->allocation);
+      }
+
+      memoryTracker.cancel(this->category, memoryRequirements.size);
+      vkDestroyImage(this->appDevice.getLogicalDevice(), this->image, nullptr);
+      throw std::runtime_error("failed to allocate image memory!");
+    }
+
+    memoryTracker.commit(this->category, memoryRequirements.size, this->allocationInfo.size);
+    this->createInfo = imageInfo;
+
+    // Only device local single sampled images that can be copied on the GPU may be moved
+    VkMemoryPropertyFlags memoryProperties;
+    vmaGetAllocationMemoryProperties(this->appDevice.getMemoryAllocator(), this->allocation, &memoryProperties);
+
+    VkImageUsageFlags transferUsage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    this->isDefragmentable = (memoryProperties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) == 0 && (imageUsage & transferUsage) == transferUsage 
+      && numSamples == VK_SAMPLE_COUNT_1_BIT && tiling == VK_IMAGE_TILING_OPTIMAL;
+
+    if (this->isDefragmentable) {
+      vmaSetAllocationUserData(this->appDevice.getMemoryAllocator(), this->allocation, static_cast<EngineDefragmentable*>(this));
     }
   }
 
@@ -118,7 +174,7 @@ namespace nugiEngine {
 
     if (isCommandBufferCreatedHere) {
       commandBuffer->endCommand();
-      commandBuffer->submitCommand(this->appDevice.getTransferQueue(0));
+      commandBuffer->submitCommandAndWait(QueueType::Graphics);
     }
   }
   
@@ -174,7 +230,7 @@ namespace nugiEngine {
 
     if (isCommandBufferCreatedHere) {
       commandBuffer->endCommand();
-      commandBuffer->submitCommand(appDevice->getTransferQueue(0));
+      commandBuffer->submitCommandAndWait(QueueType::Graphics);
     }
   }
 
@@ -200,7 +256,7 @@ namespace nugiEngine {
 
     if (isCommandBufferCreatedHere) {
       commandBuffer->endCommand();
-      commandBuffer->submitCommand(this->appDevice.getTransferQueue(0));
+      commandBuffer->submitCommandAndWait(QueueType::Graphics);
     }
   }
 
@@ -226,7 +282,7 @@ namespace nugiEngine {
 
     if (isCommandBufferCreatedHere) {
       commandBuffer->endCommand();
-      commandBuffer->submitCommand(this->appDevice.getTransferQueue(0));
+      commandBuffer->submitCommandAndWait(QueueType::Graphics);
     }
   }
 
@@ -340,10 +396,94 @@ namespace nugiEngine {
       0, nullptr,
       1, &barrier);
 
+    this->layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
     if (isCommandBufferCreatedHere) {
       commandBuffer->endCommand();
-      commandBuffer->submitCommand(this->appDevice.getTransferQueue(0));
+      commandBuffer->submitCommandAndWait(QueueType::Graphics);
+    }
+  }
+
+  void EngineImage::beginMove(VmaAllocation dstAllocation, std::shared_ptr<EngineCommandBuffer> commandBuffer) {
+    VkImage newImage;
+    if (vkCreateImage(this->appDevice.getLogicalDevice(), &this->createInfo, nullptr, &newImage) != VK_SUCCESS) {
+      throw std::runtime_error("failed to create image!");
+    }
+
+    if (vmaBindImageMemory(this->appDevice.getMemoryAllocator(), dstAllocation, newImage) != VK_SUCCESS) {
+      vkDestroyImage(this->appDevice.getLogicalDevice(), newImage, nullptr);
+      throw std::runtime_error("failed to bind moved image memory!");
+    }
+
+    // Content that was never written does not need to be copied
+    if (this->layout != VK_IMAGE_LAYOUT_UNDEFINED) {
+      VkImageMemoryBarrier barriers[2]{};
+
+      for (auto &&barrier : barriers) {
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.subresourceRange.aspectMask = this->aspectFlags;
+        barrier.subresourceRange.baseMipLevel = 0;
+        barrier.subresourceRange.levelCount = this->mipLevels;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = 1;
+      }
+
+      barriers[0].image = this->image;
+      barriers[0].oldLayout = this->layout;
+      barriers[0].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+      barriers[0].srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+      barriers[0].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+      barriers[1].image = newImage;
+      barriers[1].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+      barriers[1].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+      barriers[1].srcAccessMask = 0;
+      barriers[1].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+      vkCmdPipelineBarrier(commandBuffer->getCommandBuffer(), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 
+        0, 0, nullptr, 0, nullptr, 2, barriers);
+
+      std::vector<VkImageCopy> regions;
+
+      for (uint32_t i = 0; i < this->mipLevels; i++) {
+        VkImageCopy region{};
+        region.srcSubresource.aspectMask = this->aspectFlags;
+        region.srcSubresource.mipLevel = i;
+        region.srcSubresource.baseArrayLayer = 0;
+        region.srcSubresource.layerCount = 1;
+        region.dstSubresource = region.srcSubresource;
+        region.extent = { std::max(this->width >> i, 1u), std::max(this->height >> i, 1u), 1 };
+
+        regions.emplace_back(region);
+      }
+
+      vkCmdCopyImage(commandBuffer->getCommandBuffer(), this->image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, newImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 
+        static_cast<uint32_t>(regions.size()), regions.data());
+
+      barriers[1].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+      barriers[1].newLayout = this->layout;
+      barriers[1].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+      barriers[1].dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+
+      vkCmdPipelineBarrier(commandBuffer->getCommandBuffer(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 
+        0, 0, nullptr, 0, nullptr, 1, &barriers[1]);
     }
+
+    this->movedImage = this->image;
+    this->movedImageView = this->imageView;
+
+    this->image = newImage;
+    this->createImageView();
+  }
+
+  void EngineImage::finishMove() {
+    vkDestroyImageView(this->appDevice.getLogicalDevice(), this->movedImageView, nullptr);
+    vkDestroyImage(this->appDevice.getLogicalDevice(), this->movedImage, nullptr);
+
+    this->movedImageView = VK_NULL_HANDLE;
+    this->movedImage = VK_NULL_HANDLE;
   }
 
   VkDescriptorImageInfo EngineImage::getDescriptorInfo(VkImageLayout desiredImageLayout) {
@@ -6,15 +6,17 @@
 
 #include "../buffer/buffer.hpp"
 #include "../command/command_buffer.hpp"
+#include "../memory/memory_tracker.hpp"
+#include "../memory/defragmenter.hpp"
 
 namespace nugiEngine
 {
-  class EngineImage
+  class EngineImage : public EngineDefragmentable
   {
     public:
       EngineImage(EngineDevice &appDevice, uint32_t width, uint32_t height, uint32_t mipLevels, VkSampleCountFlagBits numSamples, 
         VkFormat format, VkImageTiling tiling, VkImageUsageFlags imageUsage, VmaMemoryUsage memoryUsage, VmaAllocationCreateFlags memoryPropertyFlags, 
-        VkImageAspectFlags aspectFlags);
+        VkImageAspectFlags aspectFlags, MemoryCategory category = MemoryCategory::Other);
       EngineImage(EngineDevice &appDevice, uint32_t width, uint32_t height, VkImage image, uint32_t mipLevels, VkFormat format, VkImageAspectFlags aspectFlags);
       ~EngineImage();
 
@@ -25,6 +27,9 @@ namespace nugiEngine
       VkImageAspectFlags getAspectFlag() { return this->aspectFlags; }
       uint32_t getMipLevels() { return this->mipLevels; }
 
+      // Zero for images that do not own their memory, like the swap chain ones
+      VkDeviceSize getMemorySize() const { return this->isImageCreatedByUs ? this->allocationInfo.size : 0; }
+
       VkDescriptorImageInfo getDescriptorInfo(VkImageLayout desiredImageLayout);
 
       void transitionImageLayout(VkImageLayout oldLayout, VkImageLayout newLayout, VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage, 
@@ -37,6 +42,9 @@ namespace nugiEngine
 
       void generateMipMap(std::shared_ptr<EngineCommandBuffer> commandBuffer = nullptr);
 
+      void beginMove(VmaAllocation dstAllocation, std::shared_ptr<EngineCommandBuffer> commandBuffer) override;
+      void finishMove() override;
+
       static void transitionImageLayout(std::vector<std::shared_ptr<EngineImage>> images, VkImageLayout oldLayout, VkImageLayout newLayout, 
         VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage, VkAccessFlags srcAccess, VkAccessFlags dstAccess,
         uint32_t srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED, uint32_t dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
@@ -48,16 +56,23 @@ namespace nugiEngine
       VkImage image;
       VkImageView imageView;
 
+      VkImage movedImage = VK_NULL_HANDLE;
+      VkImageView movedImageView = VK_NULL_HANDLE;
+
       VmaAllocation allocation;
       VmaAllocationInfo allocationInfo;
 
       VkFormat format;
       VkImageAspectFlags aspectFlags;
       VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+      MemoryCategory category = MemoryCategory::Other;
       
       uint32_t width, height, mipLevels;
       bool isImageCreatedByUs = false;
 
+      VkImageCreateInfo createInfo{};
+      bool isDefragmentable = false;
+
       void createImage(VkSampleCountFlagBits numSamples, VkImageTiling tiling, VkImageUsageFlags imageUsage, VmaMemoryUsage memoryUsage, VmaAllocationCreateFlags memoryPropertyFlags);
       void createImageView();
   };
@@ -0,0 +1,221 @@
+#include "defragmenter.hpp"
+
+#include <stdexcept>
+
+namespace nugiEngine {
+  EngineDefragmenter::EngineDefragmenter(EngineDevice &device, DefragmentationConfig config) : engineDevice{device}, config{config} {
+
+  }
+
+  EngineDefragmenter::~EngineDefragmenter() {
+    if (this->context == VK_NULL_HANDLE) {
+      return;
+    }
+
+    // The device is idle by now, a retiring pass can end right away
+    if (!this->passResources.empty()) {
+      this->endPass();
+    }
+
+    if (this->context != VK_NULL_HANDLE) {
+      this->endDefragmentation();
+    }
+  }
+
+  void EngineDefragmenter::setConfig(DefragmentationConfig config) {
+    std::lock_guard<std::mutex> lock{this->mutex};
+    this->config = config;
+  }
+
+  uint32_t EngineDefragmenter::addMoveListener(MoveListener listener) {
+    std::lock_guard<std::mutex> lock{this->mutex};
+
+    uint32_t listenerId = this->nextListenerId++;
+    this->moveListeners.emplace(listenerId, listener);
+
+    return listenerId;
+  }
+
+  void EngineDefragmenter::removeMoveListener(uint32_t listenerId) {
+    std::lock_guard<std::mutex> lock{this->mutex};
+    this->moveListeners.erase(listenerId);
+  }
+
+  void EngineDefragmenter::request() {
+    std::lock_guard<std::mutex> lock{this->mutex};
+    this->isRequested = true;
+  }
+
+  bool EngineDefragmenter::isRunning() {
+    std::lock_guard<std::mutex> lock{this->mutex};
+    return this->context != VK_NULL_HANDLE;
+  }
+
+  VmaDefragmentationStats EngineDefragmenter::getLastStats() {
+    std::lock_guard<std::mutex> lock{this->mutex};
+    return this->lastStats;
+  }
+
+  void EngineDefragmenter::update(std::shared_ptr<EngineCommandBuffer> commandBuffer, uint32_t frameIndex) {
+    std::lock_guard<std::mutex> lock{this->mutex};
+
+    if (!this->passResources.empty()) {
+      if (--this->framesUntilRetired > 0) {
+        this->notifyListeners(frameIndex);
+        return;
+      }
+
+      // The frame that recorded the copies has finished, the next pass can start in this frame
+      if (!this->endPass()) {
+        return;
+      }
+    }
+
+    if (this->context == VK_NULL_HANDLE) {
+      bool isIntervalPassed = this->config.frameInterval > 0 && ++this->framesSinceLastRun >= this->config.frameInterval;
+
+      if (!this->isRequested && !isIntervalPassed) {
+        return;
+      }
+    }
+
+    // Uploads on the transfer queue write to buffer handles taken before a move, every pass waits until they are all taken over
+    if (!this->engineDevice.isTransferIdle()) {
+      return;
+    }
+
+    if (this->context == VK_NULL_HANDLE) {
+      if (!this->beginDefragmentation()) {
+        return;
+      }
+    }
+
+    this->beginPass(commandBuffer);
+
+    if (!this->passResources.empty()) {
+      this->notifyListeners(frameIndex);
+    }
+  }
+
+  bool EngineDefragmenter::cancel(EngineDefragmentable *resource) {
+    std::lock_guard<std::mutex> lock{this->mutex};
+
+    for (uint32_t i = 0; i < this->passResources.size(); i++) {
+      if (this->passResources[i] == resource) {
+        this->passInfo.pMoves[i].operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_DESTROY;
+        this->passResources[i] = nullptr;
+
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  bool EngineDefragmenter::beginDefragmentation() {
+    this->isRequested = false;
+    this->framesSinceLastRun = 0;
+
+    VmaDefragmentationInfo defragmentationInfo{};
+    defragmentationInfo.maxBytesPerPass = this->config.maxBytesPerFrame;
+    defragmentationInfo.maxAllocationsPerPass = this->config.maxMovesPerFrame;
+
+    if (vmaBeginDefragmentation(this->engineDevice.getMemoryAllocator(), &defragmentationInfo, &this->context) != VK_SUCCESS) {
+      this->context = VK_NULL_HANDLE;
+      return false;
+    }
+
+    return true;
+  }
+
+  void EngineDefragmenter::endDefragmentation() {
+    vmaEndDefragmentation(this->engineDevice.getMemoryAllocator(), this->context, &this->lastStats);
+    this->context = VK_NULL_HANDLE;
+  }
+
+  void EngineDefragmenter::beginPass(std::shared_ptr<EngineCommandBuffer> commandBuffer) {
+    auto startTime = std::chrono::steady_clock::now();
+    this->passInfo = VmaDefragmentationPassMoveInfo{};
+
+    if (vmaBeginDefragmentationPass(this->engineDevice.getMemoryAllocator(), this->context, &this->passInfo) == VK_SUCCESS) {
+      this->endDefragmentation();
+      return;
+    }
+
+    this->passResources.assign(this->passInfo.moveCount, nullptr);
+    bool isBarrierRecorded = false;
+
+    for (uint32_t i = 0; i < this->passInfo.moveCount; i++) {
+      auto &move = this->passInfo.pMoves[i];
+
+      VmaAllocationInfo allocationInfo;
+      vmaGetAllocationInfo(this->engineDevice.getMemoryAllocator(), move.srcAllocation, &allocationInfo);
+
+      // Allocations without an owner that knows how to copy itself, like mapped buffers, stay where they are
+      auto resource = static_cast<EngineDefragmentable*>(allocationInfo.pUserData);
+      if (resource == nullptr || std::chrono::steady_clock::now() - startTime > this->config.timeSlice) {
+        move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+        continue;
+      }
+
+      if (!isBarrierRecorded) {
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+
+        vkCmdPipelineBarrier(commandBuffer->getCommandBuffer(), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+          0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+        isBarrierRecorded = true;
+      }
+
+      resource->beginMove(move.dstTmpAllocation, commandBuffer);
+      this->passResources[i] = resource;
+    }
+
+    if (!isBarrierRecorded) {
+      // Nothing could be moved in this frame, release the reserved places right away
+      this->passResources.clear();
+
+      if (vmaEndDefragmentationPass(this->engineDevice.getMemoryAllocator(), this->context, &this->passInfo) == VK_SUCCESS) {
+        this->endDefragmentation();
+      }
+
+      return;
+    }
+
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer->getCommandBuffer(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+      0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    this->framesUntilRetired = this->engineDevice.getFramesInFlight();
+  }
+
+  bool EngineDefragmenter::endPass() {
+    for (auto &&resource : this->passResources) {
+      if (resource != nullptr) {
+        resource->finishMove();
+      }
+    }
+
+    this->passResources.clear();
+
+    if (vmaEndDefragmentationPass(this->engineDevice.getMemoryAllocator(), this->context, &this->passInfo) == VK_SUCCESS) {
+      this->endDefragmentation();
+      return false;
+    }
+
+    return true;
+  }
+
+  void EngineDefragmenter::notifyListeners(uint32_t frameIndex) {
+    for (auto &&listener : this->moveListeners) {
+      listener.second(frameIndex);
+    }
+  }
+} // namespace nugiEngine
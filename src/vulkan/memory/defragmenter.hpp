@@ -0,0 +1,103 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
+
+#include "../device/device.hpp"
+#include "../command/command_buffer.hpp"
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace nugiEngine {
+  // A resource whose memory may be moved by the defragmenter, its allocation carries a pointer to it as VMA user data.
+  // The allocation keeps its size, only the memory it lives in changes.
+  class EngineDefragmentable {
+    public:
+      virtual ~EngineDefragmentable() = default;
+
+      // Create the replacement handle bound to dstAllocation, record the copy of the content into commandBuffer
+      // and hand out the replacement from now on. The old handle has to stay valid until finishMove.
+      virtual void beginMove(VmaAllocation dstAllocation, std::shared_ptr<EngineCommandBuffer> commandBuffer) = 0;
+
+      // No frame in flight uses the old handle anymore, destroy it
+      virtual void finishMove() = 0;
+  };
+
+  struct DefragmentationConfig {
+    // Allocations bigger than this never move, keep it above the block size of the buffer pools
+    VkDeviceSize maxBytesPerFrame = 16 * 1024 * 1024;
+    uint32_t maxMovesPerFrame = 64;
+
+    // Moves left when the slice runs out are skipped and proposed again by a later pass
+    std::chrono::microseconds timeSlice{500};
+
+    // Frames between the end of one defragmentation and the start of the next, 0 only runs on request
+    uint32_t frameInterval = 3600;
+  };
+
+  // Incremental defragmentation of the device memory on top of the VMA defragmentation API. Each update runs at most
+  // one pass bounded by bytes, moves and time: the copies are recorded into the frame command buffer, so later commands
+  // of the frame already see the moved resources. The old memory is released getFramesInFlight() frames later, once
+  // no frame in flight can use it; until then every update calls the move listeners to patch the descriptor sets of its frame.
+  class EngineDefragmenter {
+    public:
+      using MoveListener = std::function<void(uint32_t frameIndex)>;
+
+      EngineDefragmenter(EngineDevice &device, DefragmentationConfig config = DefragmentationConfig{});
+      ~EngineDefragmenter();
+
+      EngineDefragmenter(const EngineDefragmenter&) = delete;
+      EngineDefragmenter& operator = (const EngineDefragmenter&) = delete;
+
+      void setConfig(DefragmentationConfig config);
+
+      uint32_t addMoveListener(MoveListener listener);
+      void removeMoveListener(uint32_t listenerId);
+
+      // Start a defragmentation on the next update, if none is running yet
+      void request();
+      bool isRunning();
+
+      // Once per frame, after the previous submission of frameIndex has finished and outside of any render pass
+      void update(std::shared_ptr<EngineCommandBuffer> commandBuffer, uint32_t frameIndex);
+
+      // For the destructor of a resource. Returns true if the resource is being moved: the pass then frees its
+      // allocation, only the handles have to be destroyed.
+      bool cancel(EngineDefragmentable *resource);
+
+      VmaDefragmentationStats getLastStats();
+
+    private:
+      EngineDevice &engineDevice;
+      DefragmentationConfig config;
+
+      VmaDefragmentationContext context = VK_NULL_HANDLE;
+      VmaDefragmentationPassMoveInfo passInfo{};
+
+      // Index aligned with passInfo.pMoves, null for the moves that were skipped
+      std::vector<EngineDefragmentable*> passResources;
+      uint32_t framesUntilRetired = 0;
+
+      bool isRequested = false;
+      uint32_t framesSinceLastRun = 0;
+
+      std::map<uint32_t, MoveListener> moveListeners;
+      uint32_t nextListenerId = 0;
+
+      VmaDefragmentationStats lastStats{};
+      std::mutex mutex;
+
+      bool beginDefragmentation();
+      void endDefragmentation();
+
+      void beginPass(std::shared_ptr<EngineCommandBuffer> commandBuffer);
+      bool endPass();
+
+      void notifyListeners(uint32_t frameIndex);
+  };
+} // namespace nugiEngine
@@ -0,0 +1,195 @@
+#include "memory_tracker.hpp"
+
+#include <sstream>
+#include <stdexcept>
+
+namespace nugiEngine {
+  const char* getMemoryCategoryName(MemoryCategory category) {
+    switch (category) {
+      case MemoryCategory::Geometry: return "geometry";
+      case MemoryCategory::Texture: return "texture";
+      case MemoryCategory::Bvh: return "bvh";
+      case MemoryCategory::RenderTarget: return "renderTarget";
+      case MemoryCategory::Staging: return "staging";
+      case MemoryCategory::Uniform: return "uniform";
+      case MemoryCategory::Storage: return "storage";
+      default: return "other";
+    }
+  }
+
+  std::string MemoryReport::toJson() const {
+    std::ostringstream json;
+    json << "{\n  \"heaps\": [";
+
+    for (size_t i = 0; i < this->heaps.size(); i++) {
+      auto &heap = this->heaps[i];
+
+      json << (i == 0 ? "\n" : ",\n") << "    { \"index\": " << i
+        << ", \"deviceLocal\": " << (heap.isDeviceLocal ? "true" : "false")
+        << ", \"usage\": " << heap.usage
+        << ", \"budget\": " << heap.budget
+        << ", \"blockBytes\": " << heap.blockBytes
+        << ", \"allocationBytes\": " << heap.allocationBytes
+        << ", \"blockCount\": " << heap.blockCount
+        << ", \"allocationCount\": " << heap.allocationCount
+        << ", \"fragmentation\": " << heap.fragmentation << " }";
+    }
+
+    json << "\n  ],\n  \"categories\": {";
+
+    for (uint32_t i = 0; i < memoryCategoryCount; i++) {
+      auto &category = this->categories[i];
+
+      json << (i == 0 ? "\n" : ",\n") << "    \"" << getMemoryCategoryName(static_cast<MemoryCategory>(i)) << "\": { "
+        << "\"bytes\": " << category.bytes
+        << ", \"allocationCount\": " << category.allocationCount
+        << ", \"pooledBytes\": " << category.pooledBytes
+        << ", \"pooledUsedBytes\": " << category.pooledUsedBytes
+        << ", \"fragmentation\": " << category.getFragmentation()
+        << ", \"budget\": " << category.budget << " }";
+    }
+
+    json << "\n  }\n}\n";
+    return json.str();
+  }
+
+  EngineMemoryTracker::EngineMemoryTracker(VmaAllocator allocator) : allocator{allocator} {
+
+  }
+
+  void EngineMemoryTracker::setBudget(MemoryCategory category, VkDeviceSize budget) {
+    std::lock_guard<std::mutex> lock{this->mutex};
+    this->categories[static_cast<uint32_t>(category)].budget = budget;
+  }
+
+  void EngineMemoryTracker::addEvictionHandler(EvictionHandler handler) {
+    std::lock_guard<std::mutex> lock{this->mutex};
+    this->evictionHandlers.emplace_back(handler);
+  }
+
+  uint32_t EngineMemoryTracker::addStatisticsSource(StatisticsSource source) {
+    std::lock_guard<std::mutex> lock{this->mutex};
+
+    uint32_t sourceId = this->nextSourceId++;
+    this->statisticsSources.emplace(sourceId, source);
+
+    return sourceId;
+  }
+
+  void EngineMemoryTracker::removeStatisticsSource(uint32_t sourceId) {
+    std::lock_guard<std::mutex> lock{this->mutex};
+    this->statisticsSources.erase(sourceId);
+  }
+
+  void EngineMemoryTracker::reserve(MemoryCategory category, VkDeviceSize size) {
+    if (this->tryReserve(category, size)) {
+      return;
+    }
+
+    this->evict(category, size);
+
+    if (!this->tryReserve(category, size)) {
+      throw std::runtime_error(std::string("memory budget of ") + getMemoryCategoryName(category) + " is exceeded!");
+    }
+  }
+
+  bool EngineMemoryTracker::evict(MemoryCategory category, VkDeviceSize size) {
+    std::vector<EvictionHandler> handlers;
+
+    {
+      std::lock_guard<std::mutex> lock{this->mutex};
+      handlers = this->evictionHandlers;
+    }
+
+    // The handlers free their resources through onFree, so the lock can not be held here
+    VkDeviceSize freedSize = 0;
+
+    for (auto &&handler : handlers) {
+      if (freedSize >= size) {
+        break;
+      }
+
+      freedSize += handler(category, size - freedSize);
+    }
+
+    return freedSize > 0;
+  }
+
+  void EngineMemoryTracker::commit(MemoryCategory category, VkDeviceSize reservedSize, VkDeviceSize size) {
+    std::lock_guard<std::mutex> lock{this->mutex};
+    auto &stats = this->categories[static_cast<uint32_t>(category)];
+
+    stats.bytes = stats.bytes - reservedSize + size;
+    stats.allocationCount++;
+  }
+
+  void EngineMemoryTracker::cancel(MemoryCategory category, VkDeviceSize reservedSize) {
+    std::lock_guard<std::mutex> lock{this->mutex};
+    this->categories[static_cast<uint32_t>(category)].bytes -= reservedSize;
+  }
+
+  void EngineMemoryTracker::onFree(MemoryCategory category, VkDeviceSize size) {
+    std::lock_guard<std::mutex> lock{this->mutex};
+    auto &stats = this->categories[static_cast<uint32_t>(category)];
+
+    stats.bytes -= size;
+    stats.allocationCount--;
+  }
+
+  MemoryReport EngineMemoryTracker::getReport() {
+    MemoryReport report;
+    std::vector<StatisticsSource> sources;
+
+    {
+      std::lock_guard<std::mutex> lock{this->mutex};
+      report.categories = this->categories;
+
+      for (auto &&source : this->statisticsSources) {
+        sources.emplace_back(source.second);
+      }
+    }
+
+    const VkPhysicalDeviceMemoryProperties *memoryProperties;
+    vmaGetMemoryProperties(this->allocator, &memoryProperties);
+
+    VmaBudget budgets[VK_MAX_MEMORY_HEAPS];
+    vmaGetHeapBudgets(this->allocator, budgets);
+
+    for (uint32_t i = 0; i < memoryProperties->memoryHeapCount; i++) {
+      MemoryHeapStats heap;
+      heap.isDeviceLocal = (memoryProperties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+
+      heap.usage = budgets[i].usage;
+      heap.budget = budgets[i].budget;
+
+      heap.blockBytes = budgets[i].statistics.blockBytes;
+      heap.allocationBytes = budgets[i].statistics.allocationBytes;
+      heap.blockCount = budgets[i].statistics.blockCount;
+      heap.allocationCount = budgets[i].statistics.allocationCount;
+
+      if (heap.blockBytes > 0) {
+        heap.fragmentation = 1.0f - static_cast<float>(heap.allocationBytes) / static_cast<float>(heap.blockBytes);
+      }
+
+      report.heaps.emplace_back(heap);
+    }
+
+    for (auto &&source : sources) {
+      source(report);
+    }
+
+    return report;
+  }
+
+  bool EngineMemoryTracker::tryReserve(MemoryCategory category, VkDeviceSize size) {
+    std::lock_guard<std::mutex> lock{this->mutex};
+    auto &stats = this->categories[static_cast<uint32_t>(category)];
+
+    if (stats.budget != 0 && stats.bytes + size > stats.budget) {
+      return false;
+    }
+
+    stats.bytes += size;
+    return true;
+  }
+} // namespace nugiEngine
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
+
+#include <array>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace nugiEngine {
+  enum class MemoryCategory : uint32_t {
+    Geometry,
+    Texture,
+    Bvh,
+    RenderTarget,
+    Staging,
+    Uniform,
+    Storage,
+    Other
+  };
+
+  static constexpr uint32_t memoryCategoryCount = 8;
+
+  const char* getMemoryCategoryName(MemoryCategory category);
+
+  struct MemoryCategoryStats {
+    VkDeviceSize bytes = 0;
+    uint32_t allocationCount = 0;
+
+    // Part of bytes that is suballocated by buffer pools, and how much of it is handed out
+    VkDeviceSize pooledBytes = 0;
+    VkDeviceSize pooledUsedBytes = 0;
+
+    // Zero means no limit
+    VkDeviceSize budget = 0;
+
+    float getFragmentation() const { return this->pooledBytes > 0 ? 1.0f - static_cast<float>(this->pooledUsedBytes) / static_cast<float>(this->pooledBytes) : 0.0f; }
+  };
+
+  struct MemoryHeapStats {
+    bool isDeviceLocal = false;
+
+    // From vmaGetHeapBudgets, usage and budget cover the whole process, the block and allocation numbers only this allocator
+    VkDeviceSize usage = 0;
+    VkDeviceSize budget = 0;
+
+    VkDeviceSize blockBytes = 0;
+    VkDeviceSize allocationBytes = 0;
+    uint32_t blockCount = 0;
+    uint32_t allocationCount = 0;
+
+    // Share of the allocated blocks that no allocation uses
+    float fragmentation = 0.0f;
+  };
+
+  struct MemoryReport {
+    std::vector<MemoryHeapStats> heaps;
+    std::array<MemoryCategoryStats, memoryCategoryCount> categories;
+
+    std::string toJson() const;
+  };
+
+  // Bookkeeping of every EngineBuffer and EngineImage allocation, tagged by category. A category over its budget first asks
+  // the eviction handlers for room; if they can not free enough, the allocation is rejected with an exception.
+  // Heap budgets are enforced by VMA itself, allocations are created with VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT.
+  class EngineMemoryTracker {
+    public:
+      // Return the bytes freed for the given category, called without any lock held
+      using EvictionHandler = std::function<VkDeviceSize(MemoryCategory category, VkDeviceSize requiredSize)>;
+
+      // Adds what the tracker can not see by itself, like the use of suballocated blocks, to a report
+      using StatisticsSource = std::function<void(MemoryReport &report)>;
+
+      EngineMemoryTracker(VmaAllocator allocator);
+
+      EngineMemoryTracker(const EngineMemoryTracker&) = delete;
+      EngineMemoryTracker& operator = (const EngineMemoryTracker&) = delete;
+
+      void setBudget(MemoryCategory category, VkDeviceSize budget);
+      void addEvictionHandler(EvictionHandler handler);
+
+      uint32_t addStatisticsSource(StatisticsSource source);
+      void removeStatisticsSource(uint32_t sourceId);
+
+      // Counts size against the category budget in the same locked step that checks it, so concurrent loaders can not
+      // overshoot it together. Throws when size does not fit, even after eviction. Follow with commit or cancel.
+      void reserve(MemoryCategory category, VkDeviceSize size);
+
+      // Free what the eviction handlers can for an allocation VMA refused, returns false when nothing was freed
+      bool evict(MemoryCategory category, VkDeviceSize size);
+
+      // Turn a reservation into an allocation of its real size, or hand it back when the allocation failed
+      void commit(MemoryCategory category, VkDeviceSize reservedSize, VkDeviceSize size);
+      void cancel(MemoryCategory category, VkDeviceSize reservedSize);
+
+      void onFree(MemoryCategory category, VkDeviceSize size);
+
+      MemoryReport getReport();
+      std::string dumpJson() { return this->getReport().toJson(); }
+
+    private:
+      VmaAllocator allocator;
+
+      std::array<MemoryCategoryStats, memoryCategoryCount> categories;
+      std::vector<EvictionHandler> evictionHandlers;
+
+      std::map<uint32_t, StatisticsSource> statisticsSources;
+      uint32_t nextSourceId = 0;
+
+      std::mutex mutex;
+
+      bool tryReserve(MemoryCategory category, VkDeviceSize size);
+  };
+} // namespace nugiEngine
@@ -0,0 +1,397 @@
+#include "render_graph.hpp"
+
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+
+namespace nugiEngine {
+  namespace {
+    constexpr VkAccessFlags writeAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+      | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+  }
+
+  EngineRenderGraph::PassBuilder::PassBuilder(EngineRenderGraph &graph, uint32_t passIndex) : graph{graph}, passIndex{passIndex} {
+
+  }
+
+  EngineRenderGraph::PassBuilder EngineRenderGraph::PassBuilder::read(RenderGraphResource resource, RenderGraphAccess access) {
+    if (access.stage == 0) {
+      throw std::runtime_error("render graph pass reads a resource without a stage!");
+    }
+
+    this->graph.passes[this->passIndex].uses.emplace_back(ResourceUse{ resource, access, VK_IMAGE_LAYOUT_UNDEFINED, false });
+    this->graph.isCompiled = false;
+
+    return *this;
+  }
+
+  EngineRenderGraph::PassBuilder EngineRenderGraph::PassBuilder::write(RenderGraphResource resource, RenderGraphAccess access, VkImageLayout finalLayout) {
+    if (access.stage == 0) {
+      throw std::runtime_error("render graph pass writes a resource without a stage!");
+    }
+
+    this->graph.passes[this->passIndex].uses.emplace_back(ResourceUse{ resource, access, finalLayout, true });
+    this->graph.isCompiled = false;
+
+    return *this;
+  }
+
+  EngineRenderGraph::PassBuilder EngineRenderGraph::PassBuilder::setSideEffect() {
+    this->graph.passes[this->passIndex].hasSideEffect = true;
+    this->graph.isCompiled = false;
+
+    return *this;
+  }
+
+  EngineRenderGraph::PassBuilder EngineRenderGraph::addPass(std::string name, ExecuteFunction execute) {
+    Pass pass{};
+    pass.name = name;
+    pass.execute = execute;
+
+    this->passes.emplace_back(pass);
+    this->isCompiled = false;
+
+    return PassBuilder{ *this, static_cast<uint32_t>(this->passes.size() - 1) };
+  }
+
+  RenderGraphResource EngineRenderGraph::importImage(std::string name, VkImage image, VkImageAspectFlags aspect, RenderGraphAccess initialAccess) {
+    Resource resource{};
+    resource.name = name;
+    resource.isImported = true;
+    resource.isImage = true;
+    resource.image = image;
+    resource.aspect = aspect;
+    resource.initialAccess = initialAccess;
+
+    this->resources.emplace_back(resource);
+    this->isCompiled = false;
+
+    return static_cast<RenderGraphResource>(this->resources.size() - 1);
+  }
+
+  RenderGraphResource EngineRenderGraph::importBuffer(std::string name, VkBuffer buffer, RenderGraphAccess initialAccess) {
+    Resource resource{};
+    resource.name = name;
+    resource.isImported = true;
+    resource.isImage = false;
+    resource.buffer = buffer;
+    resource.initialAccess = initialAccess;
+
+    this->resources.emplace_back(resource);
+    this->isCompiled = false;
+
+    return static_cast<RenderGraphResource>(this->resources.size() - 1);
+  }
+
+  void EngineRenderGraph::setImportedImage(RenderGraphResource resource, VkImage image) {
+    if (!this->resources[resource].isImported || !this->resources[resource].isImage) {
+      throw std::runtime_error("render graph resource is not an imported image!");
+    }
+
+    this->resources[resource].image = image;
+  }
+
+  void EngineRenderGraph::setImportedBuffer(RenderGraphResource resource, VkBuffer buffer) {
+    if (!this->resources[resource].isImported || this->resources[resource].isImage) {
+      throw std::runtime_error("render graph resource is not an imported buffer!");
+    }
+
+    this->resources[resource].buffer = buffer;
+  }
+
+  RenderGraphResource EngineRenderGraph::createImage(std::string name, RenderGraphImageInfo info) {
+    Resource resource{};
+    resource.name = name;
+    resource.isImported = false;
+    resource.isImage = true;
+    resource.aspect = info.aspect;
+    resource.imageInfo = info;
+
+    this->resources.emplace_back(resource);
+    this->isCompiled = false;
+
+    return static_cast<RenderGraphResource>(this->resources.size() - 1);
+  }
+
+  RenderGraphResource EngineRenderGraph::createBuffer(std::string name, RenderGraphBufferInfo info) {
+    Resource resource{};
+    resource.name = name;
+    resource.isImported = false;
+    resource.isImage = false;
+    resource.bufferInfo = info;
+
+    this->resources.emplace_back(resource);
+    this->isCompiled = false;
+
+    return static_cast<RenderGraphResource>(this->resources.size() - 1);
+  }
+
+  void EngineRenderGraph::bindTransientImage(RenderGraphResource resource, VkImage image) {
+    if (this->resources[resource].isImported || !this->resources[resource].isImage) {
+      throw std::runtime_error("render graph resource is not a transient image!");
+    }
+
+    this->resources[resource].image = image;
+  }
+
+  void EngineRenderGraph::bindTransientBuffer(RenderGraphResource resource, VkBuffer buffer) {
+    if (this->resources[resource].isImported || this->resources[resource].isImage) {
+      throw std::runtime_error("render graph resource is not a transient buffer!");
+    }
+
+    this->resources[resource].buffer = buffer;
+  }
+
+  void EngineRenderGraph::compile() {
+    for (auto &&pass : this->passes) {
+      pass.isCulled = false;
+      pass.barriers.clear();
+    }
+
+    for (auto &&resource : this->resources) {
+      resource.firstPass = UINT32_MAX;
+      resource.lastPass = 0;
+      resource.aliasSlot = noAliasSlot;
+      resource.previousAlias = UINT32_MAX;
+      resource.finalAccess = resource.initialAccess;
+    }
+
+    this->cullPasses();
+
+    for (uint32_t i = 0; i < this->passes.size(); i++) {
+      if (this->passes[i].isCulled) {
+        continue;
+      }
+
+      for (auto &&use : this->passes[i].uses) {
+        auto &resource = this->resources[use.resource];
+
+        resource.firstPass = std::min(resource.firstPass, i);
+        resource.lastPass = std::max(resource.lastPass, i);
+      }
+    }
+
+    this->assignAliasSlots();
+    this->computeBarriers();
+
+    this->isCompiled = true;
+  }
+
+  void EngineRenderGraph::cullPasses() {
+    // Walk backwards from what leaves the graph: imported resources and passes with side effects
+    std::vector<bool> isNeeded(this->resources.size(), false);
+
+    for (uint32_t i = 0; i < this->resources.size(); i++) {
+      isNeeded[i] = this->resources[i].isImported;
+    }
+
+    for (uint32_t i = static_cast<uint32_t>(this->passes.size()); i-- > 0;) {
+      auto &pass = this->passes[i];
+      bool isAlive = pass.hasSideEffect;
+
+      for (auto &&use : pass.uses) {
+        isAlive = isAlive || (use.isWrite && isNeeded[use.resource]);
+      }
+
+      pass.isCulled = !isAlive;
+
+      if (!isAlive) {
+        continue;
+      }
+
+      for (auto &&use : pass.uses) {
+        if (!use.isWrite) {
+          isNeeded[use.resource] = true;
+        }
+      }
+    }
+  }
+
+  void EngineRenderGraph::assignAliasSlots() {
+    struct AliasSlot {
+      bool isImage;
+      uint32_t lastPass;
+      RenderGraphResource firstResource, lastResource;
+    };
+
+    std::vector<RenderGraphResource> transients;
+
+    for (RenderGraphResource i = 0; i < this->resources.size(); i++) {
+      if (!this->resources[i].isImported && this->resources[i].firstPass != UINT32_MAX) {
+        transients.emplace_back(i);
+      }
+    }
+
+    std::stable_sort(transients.begin(), transients.end(), [this](RenderGraphResource a, RenderGraphResource b) {
+      return this->resources[a].firstPass < this->resources[b].firstPass;
+    });
+
+    std::vector<AliasSlot> slots;
+
+    for (auto &&transient : transients) {
+      auto &resource = this->resources[transient];
+
+      // First fit, buffers and images are kept apart to stay clear of the buffer image granularity
+      auto slot = std::find_if(slots.begin(), slots.end(), [&resource](const AliasSlot &slot) {
+        return slot.isImage == resource.isImage && slot.lastPass < resource.firstPass;
+      });
+
+      if (slot == slots.end()) {
+        resource.aliasSlot = static_cast<uint32_t>(slots.size());
+        slots.emplace_back(AliasSlot{ resource.isImage, resource.lastPass, transient, transient });
+
+        continue;
+      }
+
+      resource.aliasSlot = static_cast<uint32_t>(slot - slots.begin());
+      resource.previousAlias = slot->lastResource;
+
+      slot->lastPass = resource.lastPass;
+      slot->lastResource = transient;
+    }
+
+    // The first user of a slot follows its last user of the previous frame
+    for (auto &&slot : slots) {
+      this->resources[slot.firstResource].previousAlias = slot.lastResource;
+    }
+
+    this->aliasSlotCount = static_cast<uint32_t>(slots.size());
+  }
+
+  void EngineRenderGraph::computeBarriers() {
+    std::vector<ResourceState> states(this->resources.size());
+
+    for (uint32_t i = 0; i < this->resources.size(); i++) {
+      if (this->resources[i].firstPass != UINT32_MAX) {
+        states[i] = this->getInitialState(this->resources[i]);
+      }
+    }
+
+    for (uint32_t passIndex = 0; passIndex < this->passes.size(); passIndex++) {
+      auto &pass = this->passes[passIndex];
+
+      if (pass.isCulled) {
+        continue;
+      }
+
+      // Several uses of one resource in a pass are synchronized as one
+      std::map<RenderGraphResource, ResourceUse> mergedUses;
+
+      for (auto &&use : pass.uses) {
+        auto merged = mergedUses.find(use.resource);
+
+        if (merged == mergedUses.end()) {
+          mergedUses.emplace(use.resource, use);
+          continue;
+        }
+
+        auto &mergedUse = merged->second;
+
+        if (use.access.layout != VK_IMAGE_LAYOUT_UNDEFINED && mergedUse.access.layout != VK_IMAGE_LAYOUT_UNDEFINED
+          && use.access.layout != mergedUse.access.layout)
+        {
+          throw std::runtime_error("render graph pass uses an image in two layouts!");
+        }
+
+        mergedUse.access.stage |= use.access.stage;
+        mergedUse.access.access |= use.access.access;
+        mergedUse.access.layout = use.access.layout != VK_IMAGE_LAYOUT_UNDEFINED ? use.access.layout : mergedUse.access.layout;
+        mergedUse.finalLayout = use.finalLayout != VK_IMAGE_LAYOUT_UNDEFINED ? use.finalLayout : mergedUse.finalLayout;
+        mergedUse.isWrite = mergedUse.isWrite || use.isWrite;
+      }
+
+      for (auto &&merged : mergedUses) {
+        auto &use = merged.second;
+        auto &state = states[use.resource];
+
+        bool isTransition = this->resources[use.resource].isImage && use.access.layout != VK_IMAGE_LAYOUT_UNDEFINED
+          && use.access.layout != state.layout;
+        bool isWrite = use.isWrite || (use.access.access & writeAccessMask) != 0;
+
+        if (isTransition || isWrite) {
+          // Write after read only needs the execution dependency, write after write the memory one as well
+          VkPipelineStageFlags srcStage = state.writeStage | state.readStages;
+
+          if (srcStage != 0 || isTransition) {
+            pass.barriers.emplace_back(RenderGraphBarrier{ use.resource, srcStage, use.access.stage, state.writeAccess, use.access.access,
+              state.layout, isTransition ? use.access.layout : state.layout });
+          }
+
+          // A layout transition is a write as well, made visible to this use by its barrier. A write of the pass itself
+          // is visible to nobody yet, not even to later reads at the same stage.
+          state.writeStage = use.access.stage;
+          state.writeAccess = isWrite ? use.access.access & writeAccessMask : 0;
+          state.readStages = isWrite ? 0 : use.access.stage;
+          state.visibleTo.clear();
+
+          if (!isWrite) {
+            state.visibleTo.emplace_back(use.access.stage, use.access.access);
+          }
+
+          if (isTransition) {
+            state.layout = use.access.layout;
+          }
+        } else {
+          bool isVisible = std::any_of(state.visibleTo.begin(), state.visibleTo.end(),
+            [&use](const std::pair<VkPipelineStageFlags, VkAccessFlags> &visible) {
+              return (use.access.stage & ~visible.first) == 0 && (use.access.access & ~visible.second) == 0;
+            });
+
+          if (state.writeStage != 0 && !isVisible) {
+            pass.barriers.emplace_back(RenderGraphBarrier{ use.resource, state.writeStage, use.access.stage, state.writeAccess, use.access.access,
+              state.layout, state.layout });
+
+            state.visibleTo.emplace_back(use.access.stage, use.access.access);
+          }
+
+          state.readStages |= use.access.stage;
+        }
+
+        if (use.finalLayout != VK_IMAGE_LAYOUT_UNDEFINED) {
+          state.layout = use.finalLayout;
+        }
+
+        this->resources[use.resource].finalAccess = RenderGraphAccess{ use.access.stage, use.access.access, state.layout };
+      }
+    }
+  }
+
+  EngineRenderGraph::ResourceState EngineRenderGraph::getInitialState(const Resource &resource) const {
+    ResourceState state{};
+    RenderGraphAccess lastAccess = resource.initialAccess;
+
+    if (!resource.isImported) {
+      // The content of a transient resource is never kept, only the last use of its memory has to be waited for
+      lastAccess = this->getLastUse(resource.previousAlias);
+      lastAccess.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    }
+
+    state.layout = lastAccess.layout;
+
+    if ((lastAccess.access & writeAccessMask) != 0) {
+      state.writeStage = lastAccess.stage;
+      state.writeAccess = lastAccess.access & writeAccessMask;
+    } else {
+      state.readStages = lastAccess.stage;
+    }
+
+    return state;
+  }
+
+  RenderGraphAccess EngineRenderGraph::getLastUse(RenderGraphResource resource) const {
+    RenderGraphAccess lastUse{};
+
+    if (resource == UINT32_MAX) {
+      return lastUse;
+    }
+
+    for (auto &&use : this->passes[this->resources[resource].lastPass].uses) {
+      if (use.resource == resource) {
+        lastUse.stage |= use.access.stage;
+        lastUse.access |= use.access.access;
+      }
+    }
+
+    return lastUse;
+  }
+} // namespace nugiEngine
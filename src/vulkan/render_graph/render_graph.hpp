@@ -0,0 +1,193 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace nugiEngine {
+  class EngineCommandBuffer;
+
+  using RenderGraphResource = uint32_t;
+
+  // How a pass uses a resource. The layout is the one the pass needs the image in; UNDEFINED for buffers and for
+  // attachments a render pass transitions by itself.
+  struct RenderGraphAccess {
+    VkPipelineStageFlags stage = 0;
+    VkAccessFlags access = 0;
+    VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+  };
+
+  struct RenderGraphImageInfo {
+    uint32_t width = 0, height = 0;
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+    VkImageUsageFlags usage = 0;
+    VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+  };
+
+  struct RenderGraphBufferInfo {
+    VkDeviceSize size = 0;
+    VkBufferUsageFlags usage = 0;
+  };
+
+  // One entry of the compiled barrier list. oldLayout equals newLayout when nothing is transitioned.
+  struct RenderGraphBarrier {
+    RenderGraphResource resource;
+
+    VkPipelineStageFlags srcStage, dstStage;
+    VkAccessFlags srcAccess, dstAccess;
+    VkImageLayout oldLayout, newLayout;
+  };
+
+  // A frame described as passes that declare the resources they read and write. compile culls the passes nothing
+  // depends on, derives the barriers and layout transitions in front of each pass, batched into one vkCmdPipelineBarrier,
+  // and places transient resources with disjoint lifetimes into shared alias slots. Compiling needs no device, so the
+  // result can be checked on the CPU through getBarriers; EngineRenderGraphMemory creates the transient resources.
+  // Only execute needs the device, it lives in render_graph_execute.cpp so the rest builds without it.
+  class EngineRenderGraph {
+    public:
+      using ExecuteFunction = std::function<void(std::shared_ptr<EngineCommandBuffer> commandBuffer)>;
+
+      class PassBuilder {
+        public:
+          PassBuilder(EngineRenderGraph &graph, uint32_t passIndex);
+
+          PassBuilder read(RenderGraphResource resource, RenderGraphAccess access);
+
+          // finalLayout is the layout a render pass leaves the image in, when it transitions it by itself
+          PassBuilder write(RenderGraphResource resource, RenderGraphAccess access, VkImageLayout finalLayout = VK_IMAGE_LAYOUT_UNDEFINED);
+
+          // Never culled, for passes whose effect is outside of the graph
+          PassBuilder setSideEffect();
+
+          uint32_t getPassIndex() const { return this->passIndex; }
+
+        private:
+          EngineRenderGraph &graph;
+          uint32_t passIndex;
+      };
+
+      EngineRenderGraph() = default;
+
+      EngineRenderGraph(const EngineRenderGraph&) = delete;
+      EngineRenderGraph& operator = (const EngineRenderGraph&) = delete;
+
+      // Passes run in the order they are added
+      PassBuilder addPass(std::string name, ExecuteFunction execute);
+
+      // initialAccess is the last use before the graph runs, a zero stage means it is synchronized outside of the graph.
+      // Imported resources are never aliased, and passes writing them are never culled.
+      RenderGraphResource importImage(std::string name, VkImage image, VkImageAspectFlags aspect, RenderGraphAccess initialAccess = {});
+      RenderGraphResource importBuffer(std::string name, VkBuffer buffer, RenderGraphAccess initialAccess = {});
+
+      // Swap the handle of an imported resource, like the swap chain image of the frame, without compiling again
+      void setImportedImage(RenderGraphResource resource, VkImage image);
+      void setImportedBuffer(RenderGraphResource resource, VkBuffer buffer);
+
+      // Only alive from their first to their last use in the frame
+      RenderGraphResource createImage(std::string name, RenderGraphImageInfo info);
+      RenderGraphResource createBuffer(std::string name, RenderGraphBufferInfo info);
+
+      void compile();
+      bool hasCompiled() const { return this->isCompiled; }
+
+      // Records the barriers and the passes that survived culling
+      void execute(std::shared_ptr<EngineCommandBuffer> commandBuffer) const;
+
+      uint32_t getPassCount() const { return static_cast<uint32_t>(this->passes.size()); }
+      const std::string& getPassName(uint32_t passIndex) const { return this->passes[passIndex].name; }
+      bool isCulled(uint32_t passIndex) const { return this->passes[passIndex].isCulled; }
+
+      // Recorded in front of the pass, empty for culled passes
+      const std::vector<RenderGraphBarrier>& getBarriers(uint32_t passIndex) const { return this->passes[passIndex].barriers; }
+
+      uint32_t getResourceCount() const { return static_cast<uint32_t>(this->resources.size()); }
+      const std::string& getResourceName(RenderGraphResource resource) const { return this->resources[resource].name; }
+      bool isTransient(RenderGraphResource resource) const { return !this->resources[resource].isImported; }
+      bool isImage(RenderGraphResource resource) const { return this->resources[resource].isImage; }
+
+      const RenderGraphImageInfo& getImageInfo(RenderGraphResource resource) const { return this->resources[resource].imageInfo; }
+      const RenderGraphBufferInfo& getBufferInfo(RenderGraphResource resource) const { return this->resources[resource].bufferInfo; }
+
+      // Transient resources sharing a slot share their memory. Unused transient resources get no slot.
+      static constexpr uint32_t noAliasSlot = UINT32_MAX;
+      uint32_t getAliasSlot(RenderGraphResource resource) const { return this->resources[resource].aliasSlot; }
+      uint32_t getAliasSlotCount() const { return this->aliasSlotCount; }
+
+      // The state an imported resource is left in after the graph ran
+      RenderGraphAccess getFinalAccess(RenderGraphResource resource) const { return this->resources[resource].finalAccess; }
+
+      // Called by EngineRenderGraphMemory once the transient resource exists
+      void bindTransientImage(RenderGraphResource resource, VkImage image);
+      void bindTransientBuffer(RenderGraphResource resource, VkBuffer buffer);
+
+    private:
+      struct ResourceUse {
+        RenderGraphResource resource;
+        RenderGraphAccess access;
+        VkImageLayout finalLayout;
+        bool isWrite;
+      };
+
+      struct Pass {
+        std::string name;
+        ExecuteFunction execute;
+        std::vector<ResourceUse> uses;
+        bool hasSideEffect = false;
+
+        bool isCulled = false;
+        std::vector<RenderGraphBarrier> barriers;
+      };
+
+      struct Resource {
+        std::string name;
+        bool isImported;
+        bool isImage;
+
+        VkImage image = VK_NULL_HANDLE;
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkImageAspectFlags aspect = 0;
+
+        RenderGraphImageInfo imageInfo{};
+        RenderGraphBufferInfo bufferInfo{};
+
+        RenderGraphAccess initialAccess{};
+        RenderGraphAccess finalAccess{};
+
+        uint32_t firstPass = UINT32_MAX, lastPass = 0;
+        uint32_t aliasSlot = noAliasSlot;
+
+        // The resource that used the alias slot before this one, in this frame or at the end of the previous frame
+        RenderGraphResource previousAlias = UINT32_MAX;
+      };
+
+      // Synchronization state of a resource while walking the passes
+      struct ResourceState {
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        // Last write, and every stage that read since then
+        VkPipelineStageFlags writeStage = 0;
+        VkAccessFlags writeAccess = 0;
+        VkPipelineStageFlags readStages = 0;
+
+        // Stage and access pairs the last write is already visible to
+        std::vector<std::pair<VkPipelineStageFlags, VkAccessFlags>> visibleTo;
+      };
+
+      std::vector<Pass> passes;
+      std::vector<Resource> resources;
+      uint32_t aliasSlotCount = 0;
+      bool isCompiled = false;
+
+      void cullPasses();
+      void assignAliasSlots();
+      void computeBarriers();
+
+      // The state a transient resource starts in: the last use of the slot it takes over
+      ResourceState getInitialState(const Resource &resource) const;
+      RenderGraphAccess getLastUse(RenderGraphResource resource) const;
+  };
+} // namespace nugiEngine
@@ -0,0 +1,71 @@
+#include "render_graph.hpp"
+#include "../command/command_buffer.hpp"
+
+#include <stdexcept>
+#include <vector>
+
+namespace nugiEngine {
+  void EngineRenderGraph::execute(std::shared_ptr<EngineCommandBuffer> commandBuffer) const {
+    if (!this->isCompiled) {
+      throw std::runtime_error("render graph has to be compiled before it is executed!");
+    }
+
+    for (auto &&pass : this->passes) {
+      if (pass.isCulled) {
+        continue;
+      }
+
+      if (!pass.barriers.empty()) {
+        VkPipelineStageFlags srcStage = 0, dstStage = 0;
+
+        // Barriers without a layout transition only order memory, one global barrier covers them all
+        VkMemoryBarrier memoryBarrier{};
+        memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+
+        std::vector<VkImageMemoryBarrier> imageBarriers;
+
+        for (auto &&barrier : pass.barriers) {
+          srcStage |= barrier.srcStage;
+          dstStage |= barrier.dstStage;
+
+          if (barrier.oldLayout == barrier.newLayout) {
+            memoryBarrier.srcAccessMask |= barrier.srcAccess;
+            memoryBarrier.dstAccessMask |= barrier.dstAccess;
+
+            continue;
+          }
+
+          auto &resource = this->resources[barrier.resource];
+
+          if (resource.image == VK_NULL_HANDLE) {
+            throw std::runtime_error("render graph image " + resource.name + " has no image bound!");
+          }
+
+          VkImageMemoryBarrier imageBarrier{};
+          imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+          imageBarrier.srcAccessMask = barrier.srcAccess;
+          imageBarrier.dstAccessMask = barrier.dstAccess;
+          imageBarrier.oldLayout = barrier.oldLayout;
+          imageBarrier.newLayout = barrier.newLayout;
+          imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+          imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+          imageBarrier.image = resource.image;
+          imageBarrier.subresourceRange = VkImageSubresourceRange{ resource.aspect, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS };
+
+          imageBarriers.emplace_back(imageBarrier);
+        }
+
+        bool hasMemoryBarrier = memoryBarrier.srcAccessMask != 0 || memoryBarrier.dstAccessMask != 0;
+
+        // A transition out of a state nothing waited for starts right away
+        vkCmdPipelineBarrier(commandBuffer->getCommandBuffer(), srcStage != 0 ? srcStage : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, dstStage, 0,
+          hasMemoryBarrier ? 1 : 0, hasMemoryBarrier ? &memoryBarrier : nullptr, 0, nullptr,
+          static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+      }
+
+      if (pass.execute) {
+        pass.execute(commandBuffer);
+      }
+    }
+  }
+} // namespace nugiEngine
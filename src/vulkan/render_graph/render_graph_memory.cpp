@@ -0,0 +1,202 @@
+#include "render_graph_memory.hpp"
+#include "../memory/memory_tracker.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace nugiEngine {
+  EngineRenderGraphMemory::EngineRenderGraphMemory(EngineDevice &device, EngineRenderGraph &graph) : engineDevice{device} {
+    if (!graph.hasCompiled()) {
+      throw std::runtime_error("render graph has to be compiled before its memory is created!");
+    }
+
+    try {
+      this->createResources(graph);
+
+      for (auto &&allocationGroup : this->allocationGroups) {
+        this->allocateGroup(allocationGroup);
+      }
+
+      this->bindResources(graph);
+    } catch (...) {
+      this->destroy();
+      throw;
+    }
+  }
+
+  EngineRenderGraphMemory::~EngineRenderGraphMemory() {
+    this->destroy();
+  }
+
+  void EngineRenderGraphMemory::createResources(EngineRenderGraph &graph) {
+    uint32_t resourceCount = graph.getResourceCount();
+
+    this->images.assign(resourceCount, VK_NULL_HANDLE);
+    this->imageViews.assign(resourceCount, VK_NULL_HANDLE);
+    this->buffers.assign(resourceCount, VK_NULL_HANDLE);
+
+    for (RenderGraphResource resource = 0; resource < resourceCount; resource++) {
+      uint32_t aliasSlot = graph.getAliasSlot(resource);
+
+      if (!graph.isTransient(resource) || aliasSlot == EngineRenderGraph::noAliasSlot) {
+        continue;
+      }
+
+      VkMemoryRequirements requirements;
+      bool isTransientAttachment = graph.isImage(resource) && (graph.getImageInfo(resource).usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT) != 0;
+
+      if (graph.isImage(resource)) {
+        auto info = graph.getImageInfo(resource);
+
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.extent = { info.width, info.height, 1 };
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.format = info.format;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        imageInfo.usage = info.usage;
+        imageInfo.samples = info.samples;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        if (vkCreateImage(this->engineDevice.getLogicalDevice(), &imageInfo, nullptr, &this->images[resource]) != VK_SUCCESS) {
+          throw std::runtime_error("failed to create render graph image!");
+        }
+
+        vkGetImageMemoryRequirements(this->engineDevice.getLogicalDevice(), this->images[resource], &requirements);
+      } else {
+        auto info = graph.getBufferInfo(resource);
+
+        VkBufferCreateInfo bufferInfo{};
+        bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bufferInfo.size = info.size;
+        bufferInfo.usage = info.usage;
+        bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        if (vkCreateBuffer(this->engineDevice.getLogicalDevice(), &bufferInfo, nullptr, &this->buffers[resource]) != VK_SUCCESS) {
+          throw std::runtime_error("failed to create render graph buffer!");
+        }
+
+        vkGetBufferMemoryRequirements(this->engineDevice.getLogicalDevice(), this->buffers[resource], &requirements);
+      }
+
+      // Join a group of the same slot the memory types allow, the group grows to the largest member
+      auto allocationGroup = std::find_if(this->allocationGroups.begin(), this->allocationGroups.end(), 
+        [aliasSlot, &requirements](const AllocationGroup &allocationGroup) {
+          return allocationGroup.aliasSlot == aliasSlot && (allocationGroup.requirements.memoryTypeBits & requirements.memoryTypeBits) != 0;
+        });
+
+      if (allocationGroup == this->allocationGroups.end()) {
+        this->allocationGroups.emplace_back(AllocationGroup{ aliasSlot, requirements, { resource }, isTransientAttachment });
+        continue;
+      }
+
+      allocationGroup->isTransientAttachment = allocationGroup->isTransientAttachment && isTransientAttachment;
+      allocationGroup->requirements.size = std::max(allocationGroup->requirements.size, requirements.size);
+      allocationGroup->requirements.alignment = std::max(allocationGroup->requirements.alignment, requirements.alignment);
+      allocationGroup->requirements.memoryTypeBits &= requirements.memoryTypeBits;
+      allocationGroup->resources.emplace_back(resource);
+    }
+  }
+
+  void EngineRenderGraphMemory::allocateGroup(AllocationGroup &allocationGroup) {
+    auto &memoryTracker = this->engineDevice.getMemoryTracker();
+    memoryTracker.reserve(MemoryCategory::RenderTarget, allocationGroup.requirements.size);
+
+    VmaAllocationCreateInfo allocInfo{};
+    allocInfo.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+    allocInfo.preferredFlags = allocationGroup.isTransientAttachment ? VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT : 0;
+    allocInfo.flags = VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT;
+
+    VkResult result = vmaAllocateMemory(this->engineDevice.getMemoryAllocator(), &allocationGroup.requirements, &allocInfo, 
+      &allocationGroup.allocation, nullptr);
+
+    // Over the heap budget, retry once if something could be evicted
+    if (result == VK_ERROR_OUT_OF_DEVICE_MEMORY && memoryTracker.evict(MemoryCategory::RenderTarget, allocationGroup.requirements.size)) {
+      result = vmaAllocateMemory(this->engineDevice.getMemoryAllocator(), &allocationGroup.requirements, &allocInfo, 
+        &allocationGroup.allocation, nullptr);
+    }
+
+    if (result != VK_SUCCESS) {
+      memoryTracker.cancel(MemoryCategory::RenderTarget, allocationGroup.requirements.size);
+      allocationGroup.allocation = VK_NULL_HANDLE;
+      throw std::runtime_error("failed to allocate render graph memory!");
+    }
+
+    memoryTracker.commit(MemoryCategory::RenderTarget, allocationGroup.requirements.size, allocationGroup.requirements.size);
+    this->allocatedSize += allocationGroup.requirements.size;
+  }
+
+  void EngineRenderGraphMemory::bindResources(EngineRenderGraph &graph) {
+    for (auto &&allocationGroup : this->allocationGroups) {
+      for (auto &&resource : allocationGroup.resources) {
+        if (this->buffers[resource] != VK_NULL_HANDLE) {
+          if (vmaBindBufferMemory(this->engineDevice.getMemoryAllocator(), allocationGroup.allocation, this->buffers[resource]) != VK_SUCCESS) {
+            throw std::runtime_error("failed to bind render graph buffer memory!");
+          }
+
+          graph.bindTransientBuffer(resource, this->buffers[resource]);
+          continue;
+        }
+
+        if (vmaBindImageMemory(this->engineDevice.getMemoryAllocator(), allocationGroup.allocation, this->images[resource]) != VK_SUCCESS) {
+          throw std::runtime_error("failed to bind render graph image memory!");
+        }
+
+        auto info = graph.getImageInfo(resource);
+
+        VkImageViewCreateInfo viewInfo{};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = this->images[resource];
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = info.format;
+        viewInfo.subresourceRange.aspectMask = info.aspect;
+        viewInfo.subresourceRange.baseMipLevel = 0;
+        viewInfo.subresourceRange.levelCount = 1;
+        viewInfo.subresourceRange.baseArrayLayer = 0;
+        viewInfo.subresourceRange.layerCount = 1;
+
+        if (vkCreateImageView(this->engineDevice.getLogicalDevice(), &viewInfo, nullptr, &this->imageViews[resource]) != VK_SUCCESS) {
+          throw std::runtime_error("failed to create render graph image view!");
+        }
+
+        graph.bindTransientImage(resource, this->images[resource]);
+      }
+    }
+  }
+
+  void EngineRenderGraphMemory::destroy() {
+    for (auto &&imageView : this->imageViews) {
+      if (imageView != VK_NULL_HANDLE) {
+        vkDestroyImageView(this->engineDevice.getLogicalDevice(), imageView, nullptr);
+      }
+    }
+
+    for (auto &&image : this->images) {
+      if (image != VK_NULL_HANDLE) {
+        vkDestroyImage(this->engineDevice.getLogicalDevice(), image, nullptr);
+      }
+    }
+
+    for (auto &&buffer : this->buffers) {
+      if (buffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(this->engineDevice.getLogicalDevice(), buffer, nullptr);
+      }
+    }
+
+    for (auto &&allocationGroup : this->allocationGroups) {
+      if (allocationGroup.allocation != VK_NULL_HANDLE) {
+        vmaFreeMemory(this->engineDevice.getMemoryAllocator(), allocationGroup.allocation);
+        this->engineDevice.getMemoryTracker().onFree(MemoryCategory::RenderTarget, allocationGroup.requirements.size);
+      }
+    }
+
+    this->imageViews.clear();
+    this->images.clear();
+    this->buffers.clear();
+    this->allocationGroups.clear();
+    this->allocatedSize = 0;
+  }
+} // namespace nugiEngine
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
+
+#include "render_graph.hpp"
+#include "../device/device.hpp"
+
+#include <vector>
+
+namespace nugiEngine {
+  // Creates the transient resources of a compiled render graph and binds them into it. Resources sharing an alias slot
+  // are bound to the same allocation, unless their memory types have nothing in common. Slots holding only transient
+  // attachments prefer lazily allocated memory, which tile based GPUs never back with real memory. The graph keeps
+  // the handles, so the memory has to outlive every execution of it.
+  class EngineRenderGraphMemory {
+    public:
+      EngineRenderGraphMemory(EngineDevice &device, EngineRenderGraph &graph);
+      ~EngineRenderGraphMemory();
+
+      EngineRenderGraphMemory(const EngineRenderGraphMemory&) = delete;
+      EngineRenderGraphMemory& operator = (const EngineRenderGraphMemory&) = delete;
+
+      VkImage getImage(RenderGraphResource resource) const { return this->images[resource]; }
+      VkImageView getImageView(RenderGraphResource resource) const { return this->imageViews[resource]; }
+      VkBuffer getBuffer(RenderGraphResource resource) const { return this->buffers[resource]; }
+
+      // Sum of the allocations, what the transient resources would take without aliasing is larger
+      VkDeviceSize getAllocatedSize() const { return this->allocatedSize; }
+
+    private:
+      struct AllocationGroup {
+        uint32_t aliasSlot;
+        VkMemoryRequirements requirements;
+        std::vector<RenderGraphResource> resources;
+        bool isTransientAttachment;
+        VmaAllocation allocation = VK_NULL_HANDLE;
+      };
+
+      EngineDevice &engineDevice;
+
+      // Indexed by resource, null for the imported and unused ones
+      std::vector<VkImage> images;
+      std::vector<VkImageView> imageViews;
+      std::vector<VkBuffer> buffers;
+
+      std::vector<AllocationGroup> allocationGroups;
+      VkDeviceSize allocatedSize = 0;
+
+      void createResources(EngineRenderGraph &graph);
+      void allocateGroup(AllocationGroup &allocationGroup);
+      void bindResources(EngineRenderGraph &graph);
+      void destroy();
+  };
+} // namespace nugiEngine
@@ -0,0 +1,185 @@
+#include "gpu_scheduler.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace nugiEngine {
+  EngineGpuScheduler::EngineGpuScheduler(EngineDevice &device) : engineDevice{device} {
+    VkSemaphoreTypeCreateInfo typeInfo{};
+    typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    typeInfo.initialValue = 0;
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreInfo.pNext = &typeInfo;
+
+    for (auto &&timeline : this->timelines) {
+      if (vkCreateSemaphore(this->engineDevice.getLogicalDevice(), &semaphoreInfo, nullptr, &timeline.semaphore) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create timeline semaphore!");
+      }
+    }
+  }
+
+  EngineGpuScheduler::~EngineGpuScheduler() {
+    this->waitIdle();
+
+    for (auto &&timeline : this->timelines) {
+      vkDestroySemaphore(this->engineDevice.getLogicalDevice(), timeline.semaphore, nullptr);
+    }
+  }
+
+  VkQueue EngineGpuScheduler::getQueue(QueueType queueType) const {
+    switch (queueType) {
+      case QueueType::Compute:
+        return this->engineDevice.getComputeQueue();
+
+      case QueueType::Transfer:
+        return this->engineDevice.getTransferQueue();
+
+      default:
+        return this->engineDevice.getGraphicsQueue();
+    }
+  }
+
+  TimelinePoint EngineGpuScheduler::submit(QueueType queueType, std::vector<std::shared_ptr<EngineCommandBuffer>> commandBuffers,
+    std::vector<TimelineWait> waits, std::vector<VkSemaphore> binaryWaitSemaphores,
+    std::vector<VkPipelineStageFlags> binaryWaitStages, std::vector<VkSemaphore> binarySignalSemaphores)
+  {
+    if (binaryWaitSemaphores.size() != binaryWaitStages.size()) {
+      throw std::runtime_error("every binary wait semaphore needs a wait stage!");
+    }
+
+    std::vector<VkCommandBuffer> buffers;
+    for (auto &&commandBuffer : commandBuffers) {
+      buffers.emplace_back(commandBuffer->getCommandBuffer());
+    }
+
+    // Binary semaphores first, their values are ignored by the device
+    std::vector<VkSemaphore> waitSemaphores = binaryWaitSemaphores;
+    std::vector<VkPipelineStageFlags> waitStages = binaryWaitStages;
+    std::vector<uint64_t> waitValues(binaryWaitSemaphores.size(), 0);
+
+    // One wait per timeline is enough, the latest point covers every earlier one
+    std::array<uint64_t, queueTypeCount> timelineWaitValues{};
+    std::array<VkPipelineStageFlags, queueTypeCount> timelineWaitStages{};
+
+    for (auto &&wait : waits) {
+      auto timelineIndex = static_cast<uint32_t>(wait.point.queue);
+
+      // Waits on the own timeline stay, later submissions to a queue may otherwise overlap the earlier ones
+      if (wait.point.value <= this->timelines[timelineIndex].completedValue) {
+        continue;
+      }
+
+      timelineWaitValues[timelineIndex] = std::max(timelineWaitValues[timelineIndex], wait.point.value);
+      timelineWaitStages[timelineIndex] |= wait.stage;
+    }
+
+    for (uint32_t i = 0; i < queueTypeCount; i++) {
+      if (timelineWaitValues[i] > 0) {
+        waitSemaphores.emplace_back(this->timelines[i].semaphore);
+        waitStages.emplace_back(timelineWaitStages[i]);
+        waitValues.emplace_back(timelineWaitValues[i]);
+      }
+    }
+
+    std::lock_guard<std::mutex> lock{this->submitMutex};
+    auto &timeline = this->timelines[static_cast<uint32_t>(queueType)];
+
+    TimelinePoint signalPoint{ queueType, timeline.lastSubmittedValue + 1 };
+
+    std::vector<VkSemaphore> signalSemaphores = binarySignalSemaphores;
+    std::vector<uint64_t> signalValues(binarySignalSemaphores.size(), 0);
+
+    signalSemaphores.emplace_back(timeline.semaphore);
+    signalValues.emplace_back(signalPoint.value);
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo{};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.waitSemaphoreValueCount = static_cast<uint32_t>(waitValues.size());
+    timelineInfo.pWaitSemaphoreValues = waitValues.data();
+    timelineInfo.signalSemaphoreValueCount = static_cast<uint32_t>(signalValues.size());
+    timelineInfo.pSignalSemaphoreValues = signalValues.data();
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext = &timelineInfo;
+    submitInfo.commandBufferCount = static_cast<uint32_t>(buffers.size());
+    submitInfo.pCommandBuffers = buffers.data();
+    submitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
+    submitInfo.pWaitSemaphores = waitSemaphores.data();
+    submitInfo.pWaitDstStageMask = waitStages.data();
+    submitInfo.signalSemaphoreCount = static_cast<uint32_t>(signalSemaphores.size());
+    submitInfo.pSignalSemaphores = signalSemaphores.data();
+
+    if (vkQueueSubmit(this->getQueue(queueType), 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+      throw std::runtime_error("failed to submit command buffers!");
+    }
+
+    timeline.lastSubmittedValue = signalPoint.value;
+
+    for (auto &&commandBuffer : commandBuffers) {
+      commandBuffer->setLastUse(signalPoint);
+    }
+
+    return signalPoint;
+  }
+
+  uint64_t EngineGpuScheduler::getCompletedValue(QueueType queueType) {
+    auto &timeline = this->timelines[static_cast<uint32_t>(queueType)];
+
+    uint64_t value = 0;
+    vkGetSemaphoreCounterValue(this->engineDevice.getLogicalDevice(), timeline.semaphore, &value);
+
+    // Several threads may query at once, keep whichever read is the newest
+    uint64_t completedValue = timeline.completedValue;
+    while (completedValue < value && !timeline.completedValue.compare_exchange_weak(completedValue, value)) {}
+
+    return std::max(completedValue, value);
+  }
+
+  bool EngineGpuScheduler::isComplete(TimelinePoint point) {
+    if (point.value <= this->timelines[static_cast<uint32_t>(point.queue)].completedValue) {
+      return true;
+    }
+
+    return point.value <= this->getCompletedValue(point.queue);
+  }
+
+  void EngineGpuScheduler::wait(TimelinePoint point) {
+    if (this->isComplete(point)) {
+      return;
+    }
+
+    auto &timeline = this->timelines[static_cast<uint32_t>(point.queue)];
+
+    VkSemaphoreWaitInfo waitInfo{};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &timeline.semaphore;
+    waitInfo.pValues = &point.value;
+
+    if (vkWaitSemaphores(this->engineDevice.getLogicalDevice(), &waitInfo, UINT64_MAX) != VK_SUCCESS) {
+      throw std::runtime_error("failed to wait for timeline semaphore!");
+    }
+
+    this->getCompletedValue(point.queue);
+  }
+
+  void EngineGpuScheduler::waitIdle() {
+    std::array<TimelinePoint, queueTypeCount> lastPoints;
+
+    {
+      std::lock_guard<std::mutex> lock{this->submitMutex};
+
+      for (uint32_t i = 0; i < queueTypeCount; i++) {
+        lastPoints[i] = TimelinePoint{ static_cast<QueueType>(i), this->timelines[i].lastSubmittedValue };
+      }
+    }
+
+    for (auto &&point : lastPoints) {
+      this->wait(point);
+    }
+  }
+} // namespace nugiEngine
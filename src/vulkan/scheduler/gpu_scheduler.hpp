@@ -0,0 +1,64 @@
+#pragma once
+
+#include "timeline_point.hpp"
+#include "../device/device.hpp"
+#include "../command/command_buffer.hpp"
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace nugiEngine {
+  struct TimelineWait {
+    TimelinePoint point;
+    VkPipelineStageFlags stage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+  };
+
+  // Every queue owns a timeline semaphore whose value only grows: each submission signals the next value of its queue
+  // and may wait for points on any timeline. Submitted command buffers record the point they signal as their last use,
+  // so whoever recycles a resource compares that point with the completed value instead of keeping a fence per submission.
+  // Binary semaphores are still accepted for the swap chain, which can not use timelines.
+  class EngineGpuScheduler {
+    public:
+      EngineGpuScheduler(EngineDevice &device);
+      ~EngineGpuScheduler();
+
+      EngineGpuScheduler(const EngineGpuScheduler&) = delete;
+      EngineGpuScheduler& operator = (const EngineGpuScheduler&) = delete;
+
+      // Returns the point the submission signals once all of its command buffers have finished
+      TimelinePoint submit(QueueType queueType, std::vector<std::shared_ptr<EngineCommandBuffer>> commandBuffers,
+        std::vector<TimelineWait> waits = {}, std::vector<VkSemaphore> binaryWaitSemaphores = {},
+        std::vector<VkPipelineStageFlags> binaryWaitStages = {}, std::vector<VkSemaphore> binarySignalSemaphores = {});
+
+      bool isComplete(TimelinePoint point);
+      void wait(TimelinePoint point);
+      void waitIdle();
+
+      uint64_t getCompletedValue(QueueType queueType);
+      uint64_t getLastSubmittedValue(QueueType queueType) const { return this->timelines[static_cast<uint32_t>(queueType)].lastSubmittedValue; }
+      VkSemaphore getSemaphore(QueueType queueType) const { return this->timelines[static_cast<uint32_t>(queueType)].semaphore; }
+
+      VkQueue getQueue(QueueType queueType) const;
+
+      // Held around work on a queue outside of submit, like presenting: the transfer uploader submits from its own thread
+      std::mutex& getQueueMutex() { return this->submitMutex; }
+
+    private:
+      struct Timeline {
+        VkSemaphore semaphore = VK_NULL_HANDLE;
+        std::atomic<uint64_t> lastSubmittedValue{0};
+
+        // Last value read back from the device, saves the query for points known to be reached
+        std::atomic<uint64_t> completedValue{0};
+      };
+
+      EngineDevice &engineDevice;
+      std::array<Timeline, queueTypeCount> timelines;
+
+      // Queue types may share one VkQueue, and vkQueueSubmit needs the queue externally synchronized
+      std::mutex submitMutex;
+  };
+} // namespace nugiEngine
@@ -0,0 +1,103 @@
+#include "queue_transfer.hpp"
+
+#include <algorithm>
+
+namespace nugiEngine {
+  EngineQueueTransfer::EngineQueueTransfer(uint32_t srcQueueFamily, uint32_t dstQueueFamily) 
+    : srcQueueFamily{srcQueueFamily}, dstQueueFamily{dstQueueFamily}
+  {
+
+  }
+
+  void EngineQueueTransfer::addBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size, VkAccessFlags srcAccess, VkAccessFlags dstAccess) {
+    VkBufferMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcAccessMask = srcAccess;
+    barrier.dstAccessMask = dstAccess;
+    barrier.srcQueueFamilyIndex = this->srcQueueFamily;
+    barrier.dstQueueFamilyIndex = this->dstQueueFamily;
+    barrier.buffer = buffer;
+    barrier.offset = offset;
+    barrier.size = size;
+
+    this->bufferBarriers.emplace_back(barrier);
+  }
+
+  void EngineQueueTransfer::addImage(VkImage image, VkImageSubresourceRange subresourceRange, VkImageLayout oldLayout, VkImageLayout newLayout, 
+    VkAccessFlags srcAccess, VkAccessFlags dstAccess) 
+  {
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = srcAccess;
+    barrier.dstAccessMask = dstAccess;
+    barrier.oldLayout = oldLayout;
+    barrier.newLayout = newLayout;
+    barrier.srcQueueFamilyIndex = this->srcQueueFamily;
+    barrier.dstQueueFamilyIndex = this->dstQueueFamily;
+    barrier.image = image;
+    barrier.subresourceRange = subresourceRange;
+
+    this->imageBarriers.emplace_back(barrier);
+  }
+
+  void EngineQueueTransfer::release(VkCommandBuffer commandBuffer, VkPipelineStageFlags srcStage) const {
+    if (!this->isOwnershipTransfer() || this->isEmpty()) {
+      return;
+    }
+
+    // The destination access is meaningless on the releasing queue, the acquire barrier makes the memory visible there
+    auto bufferBarriers = this->bufferBarriers;
+    auto imageBarriers = this->imageBarriers;
+
+    for (auto &&barrier : bufferBarriers) {
+      barrier.dstAccessMask = 0;
+    }
+
+    for (auto &&barrier : imageBarriers) {
+      barrier.dstAccessMask = 0;
+    }
+
+    vkCmdPipelineBarrier(commandBuffer, srcStage, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 
+      static_cast<uint32_t>(bufferBarriers.size()), bufferBarriers.data(), static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+  }
+
+  void EngineQueueTransfer::acquire(VkCommandBuffer commandBuffer, VkPipelineStageFlags dstStage) const {
+    if (this->isEmpty()) {
+      return;
+    }
+
+    auto imageBarriers = this->imageBarriers;
+
+    for (auto &&barrier : imageBarriers) {
+      barrier.srcAccessMask = 0;
+
+      if (!this->isOwnershipTransfer()) {
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+      }
+    }
+
+    if (!this->isOwnershipTransfer()) {
+      // Buffers have no layout, the semaphore wait is all they need
+      imageBarriers.erase(std::remove_if(imageBarriers.begin(), imageBarriers.end(), 
+        [](const VkImageMemoryBarrier &barrier) { return barrier.oldLayout == barrier.newLayout; }), imageBarriers.end());
+
+      if (!imageBarriers.empty()) {
+        vkCmdPipelineBarrier(commandBuffer, dstStage, dstStage, 0, 0, nullptr, 0, nullptr, 
+          static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+      }
+
+      return;
+    }
+
+    auto bufferBarriers = this->bufferBarriers;
+
+    for (auto &&barrier : bufferBarriers) {
+      barrier.srcAccessMask = 0;
+    }
+
+    // Chained to the semaphore wait through dstStage, which is why it is the source stage as well
+    vkCmdPipelineBarrier(commandBuffer, dstStage, dstStage, 0, 0, nullptr, 
+      static_cast<uint32_t>(bufferBarriers.size()), bufferBarriers.data(), static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+  }
+} // namespace nugiEngine
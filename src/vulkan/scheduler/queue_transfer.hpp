@@ -0,0 +1,35 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+namespace nugiEngine {
+  // Hands buffers and images with exclusive sharing from one queue family to another. The release half is recorded on
+  // the source queue, the acquire half on the destination queue after it waited for the source submission, both with the
+  // same barriers. Between equal families there is nothing to transfer: release records nothing and acquire only the
+  // layout transitions, the semaphore wait already orders the memory accesses.
+  class EngineQueueTransfer {
+    public:
+      EngineQueueTransfer(uint32_t srcQueueFamily, uint32_t dstQueueFamily);
+
+      // srcAccess are the writes of the source queue to make available, dstAccess how the destination queue uses the resource
+      void addBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size, VkAccessFlags srcAccess, VkAccessFlags dstAccess);
+      void addImage(VkImage image, VkImageSubresourceRange subresourceRange, VkImageLayout oldLayout, VkImageLayout newLayout, 
+        VkAccessFlags srcAccess, VkAccessFlags dstAccess);
+
+      void release(VkCommandBuffer commandBuffer, VkPipelineStageFlags srcStage) const;
+
+      // dstStage has to be covered by the stage the destination submission waits for the source one at
+      void acquire(VkCommandBuffer commandBuffer, VkPipelineStageFlags dstStage) const;
+
+      bool isOwnershipTransfer() const { return this->srcQueueFamily != this->dstQueueFamily; }
+      bool isEmpty() const { return this->bufferBarriers.empty() && this->imageBarriers.empty(); }
+
+    private:
+      uint32_t srcQueueFamily, dstQueueFamily;
+
+      std::vector<VkBufferMemoryBarrier> bufferBarriers;
+      std::vector<VkImageMemoryBarrier> imageBarriers;
+  };
+} // namespace nugiEngine
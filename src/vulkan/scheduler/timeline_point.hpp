@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+
+namespace nugiEngine {
+  enum class QueueType : uint32_t {
+    Graphics,
+    Compute,
+    Transfer
+  };
+
+  static constexpr uint32_t queueTypeCount = 3;
+
+  // A value on the timeline of one queue. The default point, value 0, is reached before anything is submitted,
+  // so a resource that was never used is always free.
+  struct TimelinePoint {
+    QueueType queue = QueueType::Graphics;
+    uint64_t value = 0;
+  };
+} // namespace nugiEngine
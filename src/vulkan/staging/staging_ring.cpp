@@ -0,0 +1,181 @@
+#include "staging_ring.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace nugiEngine {
+  EngineStagingRing::EngineStagingRing(EngineDevice &device, VkDeviceSize size) : engineDevice{device}, size{size} {
+    this->buffer = std::make_unique<EngineBuffer>(
+      this->engineDevice,
+      size,
+      1,
+      VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+      VMA_MEMORY_USAGE_AUTO_PREFER_HOST,
+      VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
+      1,
+      MemoryCategory::Staging
+    );
+
+    this->buffer->map();
+    this->mapped = static_cast<uint8_t*>(this->buffer->getMappedMemory());
+  }
+
+  EngineStagingRing::~EngineStagingRing() {
+    for (auto &&submission : this->submissions) {
+      this->engineDevice.getScheduler().wait(submission.second->getLastUse());
+    }
+  }
+
+  uint64_t EngineStagingRing::beginBatch() {
+    std::lock_guard<std::mutex> lock{this->mutex};
+
+    uint64_t batchIndex = this->nextBatchIndex++;
+    this->openBatches.insert(batchIndex);
+
+    return batchIndex;
+  }
+
+  VkDeviceSize EngineStagingRing::write(uint64_t batchIndex, const void *data, VkDeviceSize size, VkDeviceSize alignment) {
+    std::lock_guard<std::mutex> lock{this->mutex};
+
+    VkDeviceSize offset = this->allocate(batchIndex, size, alignment);
+
+    std::memcpy(this->mapped + offset, data, static_cast<size_t>(size));
+    this->buffer->flush(size, offset);
+
+    return offset;
+  }
+
+  void EngineStagingRing::endBatch(uint64_t batchIndex, std::shared_ptr<EngineCommandBuffer> commandBuffer) {
+    std::lock_guard<std::mutex> lock{this->mutex};
+
+    this->openBatches.erase(batchIndex);
+    this->submissions.emplace(batchIndex, commandBuffer);
+  }
+
+  void EngineStagingRing::cancelBatch(uint64_t batchIndex) {
+    std::lock_guard<std::mutex> lock{this->mutex};
+
+    this->openBatches.erase(batchIndex);
+    this->reclaim(false);
+  }
+
+  bool EngineStagingRing::isComplete(uint64_t batchIndex) {
+    std::lock_guard<std::mutex> lock{this->mutex};
+    this->reclaim(false);
+
+    return !this->isPending(batchIndex);
+  }
+
+  void EngineStagingRing::wait(uint64_t batchIndex) {
+    std::lock_guard<std::mutex> lock{this->mutex};
+
+    if (this->openBatches.count(batchIndex) > 0) {
+      throw std::runtime_error("cannot wait for an upload batch that is not submitted!");
+    }
+
+    auto submission = this->submissions.find(batchIndex);
+    if (submission == this->submissions.end()) {
+      return;
+    }
+
+    this->engineDevice.getScheduler().wait(submission->second->getLastUse());
+    this->submissions.erase(submission);
+    this->reclaim(false);
+  }
+
+  VkDeviceSize EngineStagingRing::allocate(uint64_t batchIndex, VkDeviceSize allocationSize, VkDeviceSize alignment) {
+    VkDeviceSize offset = 0;
+
+    while (!this->tryAllocate(allocationSize, alignment, offset)) {
+      if (this->reclaim(false)) {
+        continue;
+      }
+
+      // The oldest region belongs to a batch still being recorded, waiting here would never end
+      if (this->regions.empty() || this->openBatches.count(this->regions.front().batchIndex) > 0) {
+        throw std::runtime_error("staging ring is full of unsubmitted uploads!");
+      }
+
+      this->reclaim(true);
+    }
+
+    this->regions.emplace_back(Region{ offset, batchIndex });
+    this->head = offset + allocationSize;
+
+    return offset;
+  }
+
+  bool EngineStagingRing::tryAllocate(VkDeviceSize allocationSize, VkDeviceSize alignment, VkDeviceSize &offset) {
+    if (allocationSize > this->size) {
+      return false;
+    }
+
+    if (this->regions.empty()) {
+      this->head = 0;
+      offset = 0;
+
+      return true;
+    }
+
+    VkDeviceSize tail = this->regions.front().begin;
+    VkDeviceSize alignedHead = (this->head + alignment - 1) / alignment * alignment;
+
+    // Used space is [tail, head), free space is after head and before tail
+    if (this->head > tail) {
+      if (alignedHead + allocationSize <= this->size) {
+        offset = alignedHead;
+        return true;
+      }
+
+      if (allocationSize <= tail) {
+        offset = 0;
+        return true;
+      }
+
+      return false;
+    }
+
+    // Wrapped around, used space is [tail, end) and [0, head). Equal head and tail means full.
+    if (this->head < tail && alignedHead + allocationSize <= tail) {
+      offset = alignedHead;
+      return true;
+    }
+
+    return false;
+  }
+
+  bool EngineStagingRing::reclaim(bool isWaiting) {
+    for (auto submission = this->submissions.begin(); submission != this->submissions.end();) {
+      auto current = submission++;
+
+      if (this->engineDevice.getScheduler().isComplete(current->second->getLastUse())) {
+        this->submissions.erase(current);
+      }
+    }
+
+    // Wait for the batch holding the oldest region only, the ones after it are polled again next time
+    if (isWaiting && !this->regions.empty()) {
+      auto submission = this->submissions.find(this->regions.front().batchIndex);
+
+      if (submission != this->submissions.end()) {
+        this->engineDevice.getScheduler().wait(submission->second->getLastUse());
+        this->submissions.erase(submission);
+      }
+    }
+
+    bool isReclaimed = false;
+
+    while (!this->regions.empty() && !this->isPending(this->regions.front().batchIndex)) {
+      this->regions.pop_front();
+      isReclaimed = true;
+    }
+
+    return isReclaimed;
+  }
+
+  bool EngineStagingRing::isPending(uint64_t batchIndex) const {
+    return this->openBatches.count(batchIndex) > 0 || this->submissions.count(batchIndex) > 0;
+  }
+} // namespace nugiEngine
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "../device/device.hpp"
+#include "../buffer/buffer.hpp"
+#include "../command/command_buffer.hpp"
+#include "../scheduler/gpu_scheduler.hpp"
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+
+namespace nugiEngine {
+  // One persistently mapped staging buffer shared by the host to device uploads of one thread. Space is handed out front to back
+  // and wraps around; each region remembers the upload batch that reads it and is reclaimed once the timeline point
+  // that batch's command buffer was last used at is reached. Recording and submitting the copies is left to EngineUploadBatch.
+  class EngineStagingRing {
+    public:
+      EngineStagingRing(EngineDevice &device, VkDeviceSize size);
+      ~EngineStagingRing();
+
+      EngineStagingRing(const EngineStagingRing&) = delete;
+      EngineStagingRing& operator = (const EngineStagingRing&) = delete;
+
+      // A batch is open from beginBatch until endBatch, its regions can not be reclaimed before it is submitted
+      uint64_t beginBatch();
+
+      // Copy data into the ring on behalf of an open batch and return its offset in getBuffer()
+      VkDeviceSize write(uint64_t batchIndex, const void *data, VkDeviceSize size, VkDeviceSize alignment);
+
+      // Close the batch once its command buffer went through the scheduler. The ring keeps the command buffer
+      // alive until its last use is reached.
+      void endBatch(uint64_t batchIndex, std::shared_ptr<EngineCommandBuffer> commandBuffer);
+
+      // Close a batch that will never be submitted, its regions are free again right away
+      void cancelBatch(uint64_t batchIndex);
+
+      bool isComplete(uint64_t batchIndex);
+      void wait(uint64_t batchIndex);
+
+      VkBuffer getBuffer() const { return this->buffer->getBuffer(); }
+      VkDeviceSize getSize() const { return this->size; }
+      VkDeviceSize getChunkSize() const { return this->size / 4; }
+
+    private:
+      struct Region {
+        VkDeviceSize begin;
+        uint64_t batchIndex;
+      };
+
+      EngineDevice &engineDevice;
+      std::unique_ptr<EngineBuffer> buffer;
+      uint8_t *mapped = nullptr;
+
+      VkDeviceSize size;
+      VkDeviceSize head = 0;
+
+      std::deque<Region> regions;
+      std::set<uint64_t> openBatches;
+      std::map<uint64_t, std::shared_ptr<EngineCommandBuffer>> submissions;
+
+      uint64_t nextBatchIndex = 0;
+      std::mutex mutex;
+
+      VkDeviceSize allocate(uint64_t batchIndex, VkDeviceSize allocationSize, VkDeviceSize alignment);
+      bool tryAllocate(VkDeviceSize allocationSize, VkDeviceSize alignment, VkDeviceSize &offset);
+
+      bool reclaim(bool isWaiting);
+      bool isPending(uint64_t batchIndex) const;
+  };
+} // namespace nugiEngine
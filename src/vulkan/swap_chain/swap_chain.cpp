@@ -31,13 +31,16 @@ namespace nugiEngine {
   }
 
   VkResult EngineSwapChain::acquireNextImage(uint32_t *imageIndex, std::vector<VkFence> inFlightFences, VkSemaphore imageAvailableSemaphore) {
-    vkWaitForFences(
-      this->device.getLogicalDevice(),
-      static_cast<uint32_t>(inFlightFences.size()),
-      inFlightFences.data(),
-      VK_TRUE,
-      std::numeric_limits<uint64_t>::max()
-    );
+    // Callers that track frame completion on a timeline pass no fences
+    if (!inFlightFences.empty()) {
+      vkWaitForFences(
+        this->device.getLogicalDevice(),
+        static_cast<uint32_t>(inFlightFences.size()),
+        inFlightFences.data(),
+        VK_TRUE,
+        std::numeric_limits<uint64_t>::max()
+      );
+    }
 
     VkResult result = vkAcquireNextImageKHR(
       this->device.getLogicalDevice(),
@@ -12,9 +12,18 @@
 
 namespace nugiEngine {
   EngineTexture::EngineTexture(EngineDevice &appDevice, const char* textureFileName, VkFilter filterMode, VkSamplerAddressMode addressMode, 
-    VkBool32 anistropyEnable, VkBorderColor borderColor, VkCompareOp compareOp, VkSamplerMipmapMode mipmapMode) : appDevice{appDevice} 
+    VkBool32 anistropyEnable, VkBorderColor borderColor, VkCompareOp compareOp, VkSamplerMipmapMode mipmapMode, 
+    std::shared_ptr<EngineUploadBatch> uploadBatch) : appDevice{appDevice} 
   {
-    this->createTextureImage(textureFileName);
+    this->createTextureImage(textureFileName, uploadBatch);
+    this->createTextureSampler(filterMode, addressMode, anistropyEnable, borderColor, compareOp, mipmapMode);
+  }
+
+  EngineTexture::EngineTexture(EngineDevice &appDevice, const stbi_uc* pixels, uint32_t width, uint32_t height, VkFilter filterMode, VkSamplerAddressMode addressMode, 
+    VkBool32 anistropyEnable, VkBorderColor borderColor, VkCompareOp compareOp, VkSamplerMipmapMode mipmapMode, 
+    std::shared_ptr<EngineUploadBatch> uploadBatch) : appDevice{appDevice} 
+  {
+    this->createTextureImage(pixels, width, height, uploadBatch);
     this->createTextureSampler(filterMode, addressMode, anistropyEnable, borderColor, compareOp, mipmapMode);
   }
 
@@ -28,7 +37,7 @@ namespace nugiEngine {
     vkDestroySampler(this->appDevice.getLogicalDevice(), this->sampler, nullptr);
   }
 
-  void EngineTexture::createTextureImage(const char* textureFileName) {
+  void EngineTexture::createTextureImage(const char* textureFileName, std::shared_ptr<EngineUploadBatch> uploadBatch) {
     int texWidth, texHeight, texChannels;
     stbi_uc* pixels = stbi_load(textureFileName, &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
 
@@ -36,37 +45,39 @@ namespace nugiEngine {
       throw std::runtime_error("failed to load texture image!");
     }
 
-    this->mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(texWidth, texHeight)))) + 1;
+    this->createTextureImage(pixels, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight), uploadBatch);
+    stbi_image_free(pixels);
+  }
 
-    unsigned long pixelSize = 4;
-    uint32_t pixelCount = texWidth * texHeight;
+  void EngineTexture::createTextureImage(const stbi_uc* pixels, uint32_t texWidth, uint32_t texHeight, std::shared_ptr<EngineUploadBatch> uploadBatch) {
+    bool isUploadBatchCreatedHere = false;
 
-    EngineBuffer stagingBuffer {
-			this->appDevice,
-			pixelSize,
-			pixelCount,
-			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VMA_MEMORY_USAGE_AUTO,
-			VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT
-		};
+    if (uploadBatch == nullptr) {
+      uploadBatch = std::make_shared<EngineUploadBatch>(this->appDevice);
+      isUploadBatchCreatedHere = true;
+    }
 
-    stagingBuffer.map();
-    stagingBuffer.writeToBuffer(pixels);
-    stagingBuffer.unmap();
+    this->mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(texWidth, texHeight)))) + 1;
 
-    stbi_image_free(pixels);
+    uint32_t pixelSize = 4;
 
     this->image = std::make_shared<EngineImage>(this->appDevice, texWidth, texHeight, this->mipLevels, VK_SAMPLE_COUNT_1_BIT, VK_FORMAT_R8G8B8A8_SRGB, 
       VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, 
-      VMA_MEMORY_USAGE_AUTO, VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT, 
-      VK_IMAGE_ASPECT_COLOR_BIT);
+      VMA_MEMORY_USAGE_AUTO, 0, VK_IMAGE_ASPECT_COLOR_BIT, MemoryCategory::Texture);
+
+    // A big image is submitted in parts, the image has to outlive them even when creating the sampler throws afterwards
+    uploadBatch->keepAlive(this->image);
 
     this->image->transitionImageLayout(VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 
       VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 
-      0, VK_ACCESS_TRANSFER_WRITE_BIT);
+      0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, uploadBatch->getCommandBuffer());
       
-    stagingBuffer.copyBufferToImage(this->image->getImage(), static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight), 1);
-    this->image->generateMipMap();
+    uploadBatch->uploadImage(this->image->getImage(), pixels, texWidth, texHeight, pixelSize);
+    this->image->generateMipMap(uploadBatch->getCommandBuffer());
+
+    if (isUploadBatchCreatedHere) {
+      uploadBatch->wait();
+    }
     // this->image->transitionImageLayout(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
   }
 
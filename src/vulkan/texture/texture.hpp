@@ -8,6 +8,7 @@
 #include "../buffer/buffer.hpp"
 #include "../command/command_buffer.hpp"
 #include "../image/image.hpp"
+#include "../upload/upload_batch.hpp"
 
 #include <memory>
 
@@ -17,7 +18,11 @@ namespace nugiEngine
   {
     public:
       EngineTexture(EngineDevice &appDevice, const char* textureFileName, VkFilter filterMode, VkSamplerAddressMode addressMode, 
-        VkBool32 anistropyEnable, VkBorderColor borderColor, VkCompareOp compareOp, VkSamplerMipmapMode mipmapMode);
+        VkBool32 anistropyEnable, VkBorderColor borderColor, VkCompareOp compareOp, VkSamplerMipmapMode mipmapMode, 
+        std::shared_ptr<EngineUploadBatch> uploadBatch = nullptr);
+      EngineTexture(EngineDevice &appDevice, const stbi_uc* pixels, uint32_t width, uint32_t height, VkFilter filterMode, VkSamplerAddressMode addressMode, 
+        VkBool32 anistropyEnable, VkBorderColor borderColor, VkCompareOp compareOp, VkSamplerMipmapMode mipmapMode, 
+        std::shared_ptr<EngineUploadBatch> uploadBatch = nullptr);
       EngineTexture(EngineDevice &appDevice, std::shared_ptr<EngineImage> image, VkFilter filterMode, VkSamplerAddressMode addressMode, 
         VkBool32 anistropyEnable, VkBorderColor borderColor, VkCompareOp compareOp, VkSamplerMipmapMode mipmapMode);
 
@@ -33,7 +38,8 @@ namespace nugiEngine
       VkSampler sampler;
       uint32_t mipLevels;
 
-      void createTextureImage(const char* textureFileName);
+      void createTextureImage(const char* textureFileName, std::shared_ptr<EngineUploadBatch> uploadBatch);
+      void createTextureImage(const stbi_uc* pixels, uint32_t width, uint32_t height, std::shared_ptr<EngineUploadBatch> uploadBatch);
       void createTextureSampler(VkFilter filterMode, VkSamplerAddressMode addressMode, VkBool32 anistropyEnable, 
         VkBorderColor borderColor, VkCompareOp compareOp, VkSamplerMipmapMode mipmapMode);
   };
@@ -0,0 +1,394 @@
+#include "transfer_uploader.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace nugiEngine {
+  EngineTransferUploader::EngineTransferUploader(EngineDevice &device, VkDeviceSize stagingRingSize) : engineDevice{device} {
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.queueFamilyIndex = this->engineDevice.getFamilyIndices().transferFamily;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+    if (vkCreateCommandPool(this->engineDevice.getLogicalDevice(), &poolInfo, nullptr, &this->commandPool) != VK_SUCCESS) {
+      throw std::runtime_error("failed to create transfer command pool!");
+    }
+
+    // Not shared with the upload batches of the render thread: a batch left open there would block the worker from reclaiming the ring
+    this->stagingRing = std::make_unique<EngineStagingRing>(this->engineDevice, stagingRingSize);
+    this->worker = std::thread{&EngineTransferUploader::run, this};
+  }
+
+  EngineTransferUploader::~EngineTransferUploader() {
+    {
+      std::lock_guard<std::mutex> lock{this->mutex};
+      this->isStopping = true;
+    }
+
+    this->queueCondition.notify_all();
+    this->worker.join();
+
+    // The staging ring holds on to the submitted command buffers as well, they have to be released before the pool goes
+    this->stagingRing.reset();
+
+    for (auto &&commandBuffer : this->commandBuffers) {
+      this->engineDevice.getScheduler().wait(commandBuffer->getLastUse());
+    }
+
+    this->commandBuffers.clear();
+    vkDestroyCommandPool(this->engineDevice.getLogicalDevice(), this->commandPool, nullptr);
+  }
+
+  std::shared_ptr<EngineUploadTicket> EngineTransferUploader::uploadBuffer(VkBuffer dstBuffer, const void *data, VkDeviceSize size, 
+    VkDeviceSize dstOffset, QueueType dstQueue, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess) 
+  {
+    Upload upload{};
+    upload.data.assign(static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + size);
+    upload.dstBuffer = dstBuffer;
+    upload.dstOffset = dstOffset;
+    upload.dstQueue = dstQueue;
+    upload.dstStage = dstStage;
+    upload.dstAccess = dstAccess;
+
+    return this->enqueue(std::move(upload));
+  }
+
+  std::shared_ptr<EngineUploadTicket> EngineTransferUploader::uploadImage(VkImage dstImage, const void *data, uint32_t width, uint32_t height, 
+    uint32_t pixelSize, VkImageLayout finalLayout, QueueType dstQueue, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess) 
+  {
+    VkDeviceSize size = static_cast<VkDeviceSize>(width) * height * pixelSize;
+
+    Upload upload{};
+    upload.data.assign(static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + size);
+    upload.dstImage = dstImage;
+    upload.width = width;
+    upload.height = height;
+    upload.pixelSize = pixelSize;
+    upload.finalLayout = finalLayout;
+    upload.dstQueue = dstQueue;
+    upload.dstStage = dstStage;
+    upload.dstAccess = dstAccess;
+
+    return this->enqueue(std::move(upload));
+  }
+
+  std::shared_ptr<EngineUploadTicket> EngineTransferUploader::enqueue(Upload upload) {
+    upload.ticket = std::make_shared<EngineUploadTicket>();
+    auto ticket = upload.ticket;
+
+    // Nothing to copy, and a barrier over zero bytes is not valid
+    if (upload.data.empty()) {
+      ticket->submitted = true;
+      ticket->acquired = true;
+
+      return ticket;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock{this->mutex};
+      this->queuedUploads.emplace_back(std::move(upload));
+    }
+
+    this->queueCondition.notify_one();
+    return ticket;
+  }
+
+  std::vector<TimelineWait> EngineTransferUploader::acquire(QueueType dstQueue, std::shared_ptr<EngineCommandBuffer> commandBuffer) {
+    std::lock_guard<std::mutex> lock{this->mutex};
+
+    EngineQueueTransfer transfer{ this->getQueueFamily(QueueType::Transfer), this->getQueueFamily(dstQueue) };
+    VkPipelineStageFlags dstStage = 0;
+    TimelinePoint transferPoint{};
+
+    for (auto upload = this->pendingAcquires.begin(); upload != this->pendingAcquires.end();) {
+      // Only finished copies, so the submission of commandBuffer never stalls on the transfer queue
+      if (upload->dstQueue != dstQueue || !this->engineDevice.getScheduler().isComplete(upload->ticket->getTransferPoint())) {
+        upload++;
+        continue;
+      }
+
+      this->addOwnershipBarrier(transfer, *upload);
+      dstStage |= upload->dstStage;
+
+      // Points of one timeline are reached in order, waiting for the latest covers the others
+      transferPoint = std::max(transferPoint, upload->ticket->getTransferPoint(), 
+        [](const TimelinePoint &a, const TimelinePoint &b) { return a.value < b.value; });
+
+      upload->ticket->acquired.store(true, std::memory_order_release);
+      upload = this->pendingAcquires.erase(upload);
+    }
+
+    if (transfer.isEmpty()) {
+      return {};
+    }
+
+    transfer.acquire(commandBuffer->getCommandBuffer(), dstStage);
+
+    return { TimelineWait{ transferPoint, dstStage } };
+  }
+
+  void EngineTransferUploader::wait(std::shared_ptr<EngineUploadTicket> ticket) {
+    {
+      std::unique_lock<std::mutex> lock{this->mutex};
+      this->submitCondition.wait(lock, [&ticket]() { return ticket->isSubmitted() || ticket->hasFailed(); });
+    }
+
+    if (ticket->hasFailed()) {
+      throw std::runtime_error(ticket->getError());
+    }
+
+    this->engineDevice.getScheduler().wait(ticket->getTransferPoint());
+  }
+
+  bool EngineTransferUploader::isIdle() {
+    std::lock_guard<std::mutex> lock{this->mutex};
+    return this->queuedUploads.empty() && this->recordingCount == 0 && this->pendingAcquires.empty();
+  }
+
+  void EngineTransferUploader::run() {
+    while (true) {
+      std::vector<Upload> uploads;
+
+      {
+        std::unique_lock<std::mutex> lock{this->mutex};
+        this->queueCondition.wait(lock, [this]() { return this->isStopping || !this->queuedUploads.empty(); });
+
+        if (this->queuedUploads.empty()) {
+          return;
+        }
+
+        // Everything queued so far goes into one batch, record splits it again when it stages too much
+        while (!this->queuedUploads.empty()) {
+          uploads.emplace_back(std::move(this->queuedUploads.front()));
+          this->queuedUploads.pop_front();
+        }
+
+        this->recordingCount = static_cast<uint32_t>(uploads.size());
+      }
+
+      // An exception leaving the thread would terminate the process, the tickets carry it to whoever waits instead
+      try {
+        this->record(uploads);
+      } catch (const std::exception &exception) {
+        this->fail(uploads, exception.what());
+      }
+    }
+  }
+
+  void EngineTransferUploader::fail(std::vector<Upload> &uploads, const std::string &error) {
+    {
+      std::lock_guard<std::mutex> lock{this->mutex};
+
+      // Submitted uploads were moved to pendingAcquires, only their empty husks are left here
+      for (auto &&upload : uploads) {
+        if (upload.ticket == nullptr) {
+          continue;
+        }
+
+        upload.ticket->error = error;
+        upload.ticket->failed.store(true, std::memory_order_release);
+        this->recordingCount--;
+      }
+    }
+
+    this->submitCondition.notify_all();
+  }
+
+  void EngineTransferUploader::record(std::vector<Upload> &uploads) {
+    auto &stagingRing = *this->stagingRing;
+
+    for (uint32_t i = 0; i < uploads.size();) {
+      auto commandBuffer = this->acquireCommandBuffer();
+      commandBuffer->beginSingleTimeCommand();
+
+      uint64_t batchIndex = stagingRing.beginBatch();
+      VkDeviceSize stagedSize = 0;
+
+      // An upload larger than half of the ring is split over several submissions, only its last one releases it
+      uint32_t firstUpload = i;
+      bool isUploadSplit = false;
+      TimelinePoint transferPoint{};
+
+      // A failed submission must neither keep its ring regions nor leave the command buffer recording for the next one
+      try {
+        while (i < uploads.size()) {
+          isUploadSplit = this->stage(uploads[i], commandBuffer, batchIndex, stagedSize);
+
+          if (isUploadSplit) {
+            break;
+          }
+
+          i++;
+        }
+
+        std::array<EngineQueueTransfer, queueTypeCount> transfers{
+          EngineQueueTransfer{ this->getQueueFamily(QueueType::Transfer), this->getQueueFamily(QueueType::Graphics) },
+          EngineQueueTransfer{ this->getQueueFamily(QueueType::Transfer), this->getQueueFamily(QueueType::Compute) },
+          EngineQueueTransfer{ this->getQueueFamily(QueueType::Transfer), this->getQueueFamily(QueueType::Transfer) }
+        };
+
+        for (uint32_t j = firstUpload; j < i; j++) {
+          this->addOwnershipBarrier(transfers[static_cast<uint32_t>(uploads[j].dstQueue)], uploads[j]);
+        }
+
+        for (auto &&transfer : transfers) {
+          transfer.release(commandBuffer->getCommandBuffer(), VK_PIPELINE_STAGE_TRANSFER_BIT);
+        }
+
+        commandBuffer->endCommand();
+        transferPoint = this->engineDevice.getScheduler().submit(QueueType::Transfer, { commandBuffer });
+      } catch (...) {
+        stagingRing.cancelBatch(batchIndex);
+        vkResetCommandBuffer(commandBuffer->getCommandBuffer(), 0);
+
+        throw;
+      }
+
+      stagingRing.endBatch(batchIndex, commandBuffer);
+      uint32_t releasedCount = i - firstUpload;
+
+      if (releasedCount == 0) {
+        continue;
+      }
+
+      {
+        std::lock_guard<std::mutex> lock{this->mutex};
+
+        for (uint32_t j = firstUpload; j < firstUpload + releasedCount; j++) {
+          auto &upload = uploads[j];
+
+          upload.ticket->transferPoint = transferPoint;
+          upload.ticket->submitted.store(true, std::memory_order_release);
+
+          upload.data.clear();
+          upload.data.shrink_to_fit();
+
+          this->pendingAcquires.emplace_back(std::move(upload));
+        }
+
+        this->recordingCount -= releasedCount;
+      }
+
+      this->submitCondition.notify_all();
+    }
+  }
+
+  bool EngineTransferUploader::stage(Upload &upload, std::shared_ptr<EngineCommandBuffer> commandBuffer, uint64_t batchIndex, VkDeviceSize &stagedSize) {
+    auto &stagingRing = *this->stagingRing;
+    VkDeviceSize maxStagedSize = stagingRing.getSize() / 2;
+
+    if (upload.dstImage == VK_NULL_HANDLE) {
+      VkDeviceSize size = static_cast<VkDeviceSize>(upload.data.size());
+
+      while (upload.stagedSize < size) {
+        VkDeviceSize copySize = std::min(size - upload.stagedSize, stagingRing.getChunkSize());
+
+        // Bounded by half of the ring, so the next submission can be staged while the copies of this one still read the other half
+        if (stagedSize > 0 && stagedSize + copySize > maxStagedSize) {
+          return true;
+        }
+
+        VkBufferCopy copyRegion{};
+        copyRegion.srcOffset = stagingRing.write(batchIndex, upload.data.data() + upload.stagedSize, copySize, 16);
+        copyRegion.dstOffset = upload.dstOffset + upload.stagedSize;
+        copyRegion.size = copySize;
+
+        vkCmdCopyBuffer(commandBuffer->getCommandBuffer(), stagingRing.getBuffer(), upload.dstBuffer, 1, &copyRegion);
+
+        upload.stagedSize += copySize;
+        stagedSize += copySize;
+      }
+
+      return false;
+    }
+
+    VkImageSubresourceRange subresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+    if (upload.stagedSize == 0) {
+      VkImageMemoryBarrier barrier{};
+      barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+      barrier.srcAccessMask = 0;
+      barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+      barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+      barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+      barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+      barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+      barrier.image = upload.dstImage;
+      barrier.subresourceRange = subresourceRange;
+
+      vkCmdPipelineBarrier(commandBuffer->getCommandBuffer(), VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0, 0, nullptr, 0, nullptr, 1, &barrier);
+    }
+
+    VkDeviceSize rowSize = static_cast<VkDeviceSize>(upload.width) * upload.pixelSize;
+    VkDeviceSize alignment = std::max<VkDeviceSize>(16, this->engineDevice.getProperties().limits.optimalBufferCopyOffsetAlignment);
+
+    // Whole rows per chunk, so every chunk is a plain sub rectangle of the image
+    uint32_t rowsPerChunk = static_cast<uint32_t>(std::max<VkDeviceSize>(1, stagingRing.getChunkSize() / rowSize));
+
+    for (uint32_t row = static_cast<uint32_t>(upload.stagedSize / rowSize); row < upload.height;) {
+      uint32_t rowCount = std::min(rowsPerChunk, upload.height - row);
+      VkDeviceSize copySize = rowSize * rowCount;
+
+      if (stagedSize > 0 && stagedSize + copySize > maxStagedSize) {
+        return true;
+      }
+
+      VkBufferImageCopy region{};
+      region.bufferOffset = stagingRing.write(batchIndex, upload.data.data() + rowSize * row, copySize, alignment);
+      region.bufferRowLength = 0;
+      region.bufferImageHeight = 0;
+
+      region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+      region.imageSubresource.mipLevel = 0;
+      region.imageSubresource.baseArrayLayer = 0;
+      region.imageSubresource.layerCount = 1;
+
+      region.imageOffset = { 0, static_cast<int32_t>(row), 0 };
+      region.imageExtent = { upload.width, rowCount, 1 };
+
+      vkCmdCopyBufferToImage(commandBuffer->getCommandBuffer(), stagingRing.getBuffer(), upload.dstImage, 
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+      row += rowCount;
+      upload.stagedSize += copySize;
+      stagedSize += copySize;
+    }
+
+    return false;
+  }
+
+  std::shared_ptr<EngineCommandBuffer> EngineTransferUploader::acquireCommandBuffer() {
+    for (auto &&commandBuffer : this->commandBuffers) {
+      if (this->engineDevice.getScheduler().isComplete(commandBuffer->getLastUse())) {
+        return commandBuffer;
+      }
+    }
+
+    auto commandBuffer = std::make_shared<EngineCommandBuffer>(this->engineDevice, this->commandPool, VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+    this->commandBuffers.emplace_back(commandBuffer);
+
+    return commandBuffer;
+  }
+
+  uint32_t EngineTransferUploader::getQueueFamily(QueueType queueType) const {
+    auto familyIndices = this->engineDevice.getFamilyIndices();
+
+    switch (queueType) {
+      case QueueType::Graphics: return familyIndices.graphicsFamily;
+      case QueueType::Compute: return familyIndices.computeFamily;
+      default: return familyIndices.transferFamily;
+    }
+  }
+
+  void EngineTransferUploader::addOwnershipBarrier(EngineQueueTransfer &transfer, const Upload &upload) const {
+    if (upload.dstImage == VK_NULL_HANDLE) {
+      transfer.addBuffer(upload.dstBuffer, upload.dstOffset, upload.stagedSize, VK_ACCESS_TRANSFER_WRITE_BIT, upload.dstAccess);
+      return;
+    }
+
+    transfer.addImage(upload.dstImage, VkImageSubresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 }, 
+      VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, upload.finalLayout, VK_ACCESS_TRANSFER_WRITE_BIT, upload.dstAccess);
+  }
+} // namespace nugiEngine
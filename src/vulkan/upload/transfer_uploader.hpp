@@ -0,0 +1,124 @@
+#pragma once
+
+#include "../device/device.hpp"
+#include "../command/command_buffer.hpp"
+#include "../scheduler/gpu_scheduler.hpp"
+#include "../scheduler/queue_transfer.hpp"
+#include "../staging/staging_ring.hpp"
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace nugiEngine {
+  // Completion handle of one upload queued on EngineTransferUploader
+  class EngineUploadTicket {
+    public:
+      // The copy went out on the transfer queue, getTransferPoint is valid from now on
+      bool isSubmitted() const { return this->submitted.load(std::memory_order_acquire); }
+
+      // The destination queue took ownership in a command buffer, work recorded after it on that queue may use the resource
+      bool isAcquired() const { return this->acquired.load(std::memory_order_acquire); }
+
+      TimelinePoint getTransferPoint() const { return this->transferPoint; }
+
+      // Staging or submitting the copy threw on the worker, the upload will never be submitted
+      bool hasFailed() const { return this->failed.load(std::memory_order_acquire); }
+      const std::string& getError() const { return this->error; }
+
+    private:
+      std::atomic<bool> submitted{false}, acquired{false}, failed{false};
+      TimelinePoint transferPoint{};
+      std::string error;
+
+      friend class EngineTransferUploader;
+  };
+
+  // Background uploads on the transfer queue family. Uploads are queued from any thread with a copy of their data,
+  // a worker thread stages them through a staging ring of its own, records the copies in batches and submits them on the transfer
+  // timeline, releasing every resource to its destination family. The destination queue calls acquire once per submission
+  // to take ownership of the finished ones, so the copies overlap rendering instead of stalling it.
+  class EngineTransferUploader {
+    public:
+      EngineTransferUploader(EngineDevice &device, VkDeviceSize stagingRingSize);
+      ~EngineTransferUploader();
+
+      EngineTransferUploader(const EngineTransferUploader&) = delete;
+      EngineTransferUploader& operator = (const EngineTransferUploader&) = delete;
+
+      std::shared_ptr<EngineUploadTicket> uploadBuffer(VkBuffer dstBuffer, const void *data, VkDeviceSize size, VkDeviceSize dstOffset = 0,
+        QueueType dstQueue = QueueType::Graphics, VkPipelineStageFlags dstStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 
+        VkAccessFlags dstAccess = VK_ACCESS_MEMORY_READ_BIT);
+
+      // Tightly packed rows into mip level 0, the image ends up in finalLayout once acquired. Its previous content is discarded.
+      std::shared_ptr<EngineUploadTicket> uploadImage(VkImage dstImage, const void *data, uint32_t width, uint32_t height, uint32_t pixelSize,
+        VkImageLayout finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, QueueType dstQueue = QueueType::Graphics, 
+        VkPipelineStageFlags dstStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VkAccessFlags dstAccess = VK_ACCESS_SHADER_READ_BIT);
+
+      // Record the acquire barriers of every upload for dstQueue that finished on the transfer queue at the start of commandBuffer.
+      // Uploads still in flight are left for a later call. The submission of commandBuffer has to wait for the returned points.
+      std::vector<TimelineWait> acquire(QueueType dstQueue, std::shared_ptr<EngineCommandBuffer> commandBuffer);
+
+      // Blocks until the upload finished on the transfer queue, it still has to be acquired before use. Throws when it failed.
+      void wait(std::shared_ptr<EngineUploadTicket> ticket);
+
+      // Nothing queued, in flight or waiting to be acquired
+      bool isIdle();
+
+    private:
+      struct Upload {
+        std::shared_ptr<EngineUploadTicket> ticket;
+        std::vector<uint8_t> data;
+
+        VkBuffer dstBuffer = VK_NULL_HANDLE;
+        VkDeviceSize dstOffset = 0;
+
+        VkImage dstImage = VK_NULL_HANDLE;
+        uint32_t width = 0, height = 0, pixelSize = 0;
+        VkImageLayout finalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        QueueType dstQueue;
+        VkPipelineStageFlags dstStage;
+        VkAccessFlags dstAccess;
+
+        // Bytes already copied by earlier submissions, when the upload did not fit into one
+        VkDeviceSize stagedSize = 0;
+      };
+
+      EngineDevice &engineDevice;
+      std::unique_ptr<EngineStagingRing> stagingRing;
+
+      VkCommandPool commandPool;
+      std::vector<std::shared_ptr<EngineCommandBuffer>> commandBuffers;
+
+      std::deque<Upload> queuedUploads;
+      std::vector<Upload> pendingAcquires;
+      uint32_t recordingCount = 0;
+
+      std::thread worker;
+      std::mutex mutex;
+      std::condition_variable queueCondition, submitCondition;
+      bool isStopping = false;
+
+      std::shared_ptr<EngineUploadTicket> enqueue(Upload upload);
+      void run();
+
+      // Hand the error to every upload of the list that was not submitted yet
+      void fail(std::vector<Upload> &uploads, const std::string &error);
+
+      // Records and submits the uploads, split into several submissions when they stage more than half of the ring
+      void record(std::vector<Upload> &uploads);
+      // Returns true when the submission is full before the whole upload is staged
+      bool stage(Upload &upload, std::shared_ptr<EngineCommandBuffer> commandBuffer, uint64_t batchIndex, VkDeviceSize &stagedSize);
+
+      std::shared_ptr<EngineCommandBuffer> acquireCommandBuffer();
+      uint32_t getQueueFamily(QueueType queueType) const;
+      void addOwnershipBarrier(EngineQueueTransfer &transfer, const Upload &upload) const;
+  };
+} // namespace nugiEngine
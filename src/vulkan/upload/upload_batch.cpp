@@ -0,0 +1,184 @@
+#include "upload_batch.hpp"
+#include "../staging/staging_ring.hpp"
+#include "../scheduler/gpu_scheduler.hpp"
+
+#include <algorithm>
+#include <exception>
+
+namespace nugiEngine {
+  EngineUploadBatch::EngineUploadBatch(EngineDevice &device, bool isTransferQueued) : engineDevice{device}, isTransferQueued{isTransferQueued} {
+
+  }
+
+  EngineUploadBatch::~EngineUploadBatch() {
+    // Recorded work still goes out, the staging ring keeps the command buffer alive until it finishes
+    this->submit();
+  }
+
+  std::shared_ptr<EngineCommandBuffer> EngineUploadBatch::getCommandBuffer() {
+    if (this->commandBuffer == nullptr) {
+      this->openBatchIndex = this->engineDevice.getStagingRing().beginBatch();
+
+      this->commandBuffer = std::make_shared<EngineCommandBuffer>(this->engineDevice);
+      this->commandBuffer->beginSingleTimeCommand();
+    }
+
+    return this->commandBuffer;
+  }
+
+  void EngineUploadBatch::uploadBuffer(VkBuffer dstBuffer, const void *data, VkDeviceSize size, VkDeviceSize dstOffset) {
+    // Held back until submit, so discard can still drop it
+    if (this->isTransferQueued) {
+      this->queuedTransfers.emplace_back(TransferUpload{ dstBuffer, 
+        std::vector<uint8_t>(static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + size), dstOffset });
+
+      return;
+    }
+
+    VkDeviceSize chunkSize = this->engineDevice.getStagingRing().getChunkSize();
+
+    for (VkDeviceSize uploaded = 0; uploaded < size;) {
+      VkDeviceSize copySize = std::min(size - uploaded, chunkSize);
+      VkDeviceSize offset = this->stage(static_cast<const uint8_t*>(data) + uploaded, copySize, 16);
+
+      VkBufferCopy copyRegion{};
+      copyRegion.srcOffset = offset;
+      copyRegion.dstOffset = dstOffset + uploaded;
+      copyRegion.size = copySize;
+
+      vkCmdCopyBuffer(this->getCommandBuffer()->getCommandBuffer(), this->engineDevice.getStagingRing().getBuffer(), dstBuffer, 1, &copyRegion);
+      uploaded += copySize;
+    }
+  }
+
+  void EngineUploadBatch::uploadImage(VkImage dstImage, const void *data, uint32_t width, uint32_t height, uint32_t pixelSize) {
+    VkDeviceSize rowSize = static_cast<VkDeviceSize>(width) * pixelSize;
+    VkDeviceSize alignment = std::max<VkDeviceSize>(16, this->engineDevice.getProperties().limits.optimalBufferCopyOffsetAlignment);
+
+    // Whole rows per chunk, so every chunk is a plain sub rectangle of the image
+    uint32_t rowsPerChunk = static_cast<uint32_t>(std::max<VkDeviceSize>(1, this->engineDevice.getStagingRing().getChunkSize() / rowSize));
+
+    for (uint32_t row = 0; row < height;) {
+      uint32_t rowCount = std::min(rowsPerChunk, height - row);
+      VkDeviceSize offset = this->stage(static_cast<const uint8_t*>(data) + rowSize * row, rowSize * rowCount, alignment);
+
+      VkBufferImageCopy region{};
+      region.bufferOffset = offset;
+      region.bufferRowLength = 0;
+      region.bufferImageHeight = 0;
+
+      region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+      region.imageSubresource.mipLevel = 0;
+      region.imageSubresource.baseArrayLayer = 0;
+      region.imageSubresource.layerCount = 1;
+
+      region.imageOffset = {0, static_cast<int32_t>(row), 0};
+      region.imageExtent = {width, rowCount, 1};
+
+      vkCmdCopyBufferToImage(this->getCommandBuffer()->getCommandBuffer(), this->engineDevice.getStagingRing().getBuffer(), dstImage,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+      row += rowCount;
+    }
+  }
+
+  void EngineUploadBatch::keepAlive(std::shared_ptr<void> resource) {
+    this->keptAliveResources.emplace_back(resource);
+  }
+
+  void EngineUploadBatch::submit() {
+    for (auto &&upload : this->queuedTransfers) {
+      this->transferTickets.emplace_back(this->engineDevice.getTransferUploader().uploadBuffer(upload.dstBuffer, upload.data.data(), 
+        upload.data.size(), upload.dstOffset));
+    }
+
+    this->queuedTransfers.clear();
+
+    if (this->commandBuffer == nullptr) {
+      return;
+    }
+
+    // Graphics queue, the command pool belongs to its family and mip generation needs blits
+    this->commandBuffer->endCommand();
+    this->engineDevice.getScheduler().submit(QueueType::Graphics, { this->commandBuffer });
+
+    this->engineDevice.getStagingRing().endBatch(this->openBatchIndex, this->commandBuffer);
+
+    this->submittedBatchIndices.emplace_back(this->openBatchIndex);
+    this->commandBuffer = nullptr;
+    this->stagedSize = 0;
+  }
+
+  void EngineUploadBatch::discard() {
+    this->queuedTransfers.clear();
+
+    if (this->commandBuffer != nullptr) {
+      this->engineDevice.getStagingRing().cancelBatch(this->openBatchIndex);
+
+      this->commandBuffer = nullptr;
+      this->stagedSize = 0;
+    }
+
+    for (auto &&batchIndex : this->submittedBatchIndices) {
+      this->engineDevice.getStagingRing().wait(batchIndex);
+    }
+
+    this->submittedBatchIndices.clear();
+
+    for (auto &&ticket : this->transferTickets) {
+      try {
+        this->engineDevice.getTransferUploader().wait(ticket);
+      } catch (const std::exception&) {
+        // A failed upload never wrote anything
+      }
+    }
+
+    this->transferTickets.clear();
+    this->keptAliveResources.clear();
+  }
+
+  bool EngineUploadBatch::isComplete() {
+    auto &stagingRing = this->engineDevice.getStagingRing();
+
+    this->submittedBatchIndices.erase(std::remove_if(this->submittedBatchIndices.begin(), this->submittedBatchIndices.end(),
+      [&stagingRing](uint64_t batchIndex) { return stagingRing.isComplete(batchIndex); }), this->submittedBatchIndices.end());
+
+    // A failed ticket is never acquired, keeping it would leave the batch unfinished forever
+    for (auto &&ticket : this->transferTickets) {
+      if (ticket->hasFailed() && this->error.empty()) {
+        this->error = ticket->getError();
+      }
+    }
+
+    this->transferTickets.erase(std::remove_if(this->transferTickets.begin(), this->transferTickets.end(),
+      [](const std::shared_ptr<EngineUploadTicket> &ticket) { return ticket->isAcquired() || ticket->hasFailed(); }), this->transferTickets.end());
+
+    return this->commandBuffer == nullptr && this->queuedTransfers.empty() && this->submittedBatchIndices.empty() && this->transferTickets.empty();
+  }
+
+  void EngineUploadBatch::wait() {
+    this->submit();
+
+    for (auto &&batchIndex : this->submittedBatchIndices) {
+      this->engineDevice.getStagingRing().wait(batchIndex);
+    }
+
+    this->submittedBatchIndices.clear();
+
+    for (auto &&ticket : this->transferTickets) {
+      this->engineDevice.getTransferUploader().wait(ticket);
+    }
+  }
+
+  VkDeviceSize EngineUploadBatch::stage(const void *data, VkDeviceSize size, VkDeviceSize alignment) {
+    // Bounded by half of the ring, another batch or the previous part of this one can hold the other half
+    if (this->commandBuffer != nullptr && this->stagedSize + size > this->engineDevice.getStagingRing().getSize() / 2) {
+      this->submit();
+    }
+
+    this->getCommandBuffer();
+    this->stagedSize += size;
+
+    return this->engineDevice.getStagingRing().write(this->openBatchIndex, data, size, alignment);
+  }
+} // namespace nugiEngine
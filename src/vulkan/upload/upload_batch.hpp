@@ -0,0 +1,80 @@
+#pragma once
+
+#include "../device/device.hpp"
+#include "../command/command_buffer.hpp"
+#include "transfer_uploader.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace nugiEngine {
+  // Collects copies, layout transitions and mip generation of any number of assets into one command buffer,
+  // so loading a scene is one queue submission instead of one round trip per resource.
+  // Staging data goes through the device staging ring; once a batch has staged half of the ring
+  // the recorded work is submitted and recording continues in a new command buffer.
+  // A transfer queued batch hands its buffer uploads to the device transfer uploader on submit instead, they are complete once
+  // the graphics queue took them over. Images stay on the graphics queue, their mip chain is generated with blits.
+  class EngineUploadBatch {
+    public:
+      EngineUploadBatch(EngineDevice &device, bool isTransferQueued = false);
+      ~EngineUploadBatch();
+
+      EngineUploadBatch(const EngineUploadBatch&) = delete;
+      EngineUploadBatch& operator = (const EngineUploadBatch&) = delete;
+
+      // Command buffer currently being recorded, for transitions and mip generation. Do not keep it
+      // across an upload call, a size bounded submit may start a new one.
+      std::shared_ptr<EngineCommandBuffer> getCommandBuffer();
+
+      void uploadBuffer(VkBuffer dstBuffer, const void *data, VkDeviceSize size, VkDeviceSize dstOffset = 0);
+
+      // Tightly packed rows, the image has to be in TRANSFER_DST_OPTIMAL already
+      void uploadImage(VkImage dstImage, const void *data, uint32_t width, uint32_t height, uint32_t pixelSize);
+
+      // Keeps a resource the recorded work writes to alive until discard returned, for owners destroyed by an exception
+      // after some of that work was already submitted
+      void keepAlive(std::shared_ptr<void> resource);
+
+      // Submit everything recorded so far. The batch can keep recording afterwards.
+      void submit();
+
+      // Drop everything recorded since the last submit, for an asset whose upload threw partway. Work already submitted
+      // is waited for, so nothing writes into the resources the failed upload freed once this returns.
+      void discard();
+
+      // Whether every submitted part has finished on the GPU, work still being recorded counts as unfinished.
+      // A transfer queued upload that failed counts as finished, hasFailed tells them apart.
+      bool isComplete();
+
+      // Some transfer queued upload seen by isComplete failed and never reached its buffer
+      bool hasFailed() const { return !this->error.empty(); }
+      const std::string& getError() const { return this->error; }
+
+      // Submit what is still recorded, then block until all of it has finished. Transfer queued uploads may
+      // still wait to be acquired by the graphics queue afterwards.
+      void wait();
+
+    private:
+      struct TransferUpload {
+        VkBuffer dstBuffer;
+        std::vector<uint8_t> data;
+        VkDeviceSize dstOffset;
+      };
+
+      EngineDevice &engineDevice;
+      bool isTransferQueued;
+
+      std::shared_ptr<EngineCommandBuffer> commandBuffer;
+      uint64_t openBatchIndex = 0;
+      VkDeviceSize stagedSize = 0;
+
+      std::vector<uint64_t> submittedBatchIndices;
+      std::vector<TransferUpload> queuedTransfers;
+      std::vector<std::shared_ptr<EngineUploadTicket>> transferTickets;
+      std::vector<std::shared_ptr<void>> keptAliveResources;
+      std::string error;
+
+      VkDeviceSize stage(const void *data, VkDeviceSize size, VkDeviceSize alignment);
+  };
+} // namespace nugiEngine
@@ -0,0 +1,123 @@
+#include "../src/vulkan/render_graph/render_graph.hpp"
+
+#include <cassert>
+#include <iostream>
+
+using namespace nugiEngine;
+
+// Compile a small deferred style frame and check what the graph derived from it, without a device.
+// Usage: render_graph_test.out
+namespace {
+  const RenderGraphAccess colorWrite{ VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+  const RenderGraphAccess shaderRead{ VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+
+  const RenderGraphBarrier* findBarrier(const EngineRenderGraph &graph, uint32_t passIndex, RenderGraphResource resource) {
+    for (auto &&barrier : graph.getBarriers(passIndex)) {
+      if (barrier.resource == resource) {
+        return &barrier;
+      }
+    }
+
+    return nullptr;
+  }
+
+  void checkBarrier(const EngineRenderGraph &graph, uint32_t passIndex, RenderGraphResource resource, VkPipelineStageFlags srcStage, 
+    VkPipelineStageFlags dstStage, VkAccessFlags srcAccess, VkAccessFlags dstAccess, VkImageLayout oldLayout, VkImageLayout newLayout) 
+  {
+    auto barrier = findBarrier(graph, passIndex, resource);
+
+    assert(barrier != nullptr && "barrier is missing");
+    assert(barrier->srcStage == srcStage && barrier->dstStage == dstStage && "barrier stages differ");
+    assert(barrier->srcAccess == srcAccess && barrier->dstAccess == dstAccess && "barrier access masks differ");
+    assert(barrier->oldLayout == oldLayout && barrier->newLayout == newLayout && "barrier layouts differ");
+  }
+}
+
+int main() {
+  EngineRenderGraph graph;
+
+  RenderGraphImageInfo imageInfo{ 800, 800, VK_FORMAT_R8G8B8A8_UNORM, VK_SAMPLE_COUNT_1_BIT, 
+    VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT };
+
+  // Synchronized outside of the graph, like the swap chain image
+  auto backBuffer = graph.importImage("backBuffer", VK_NULL_HANDLE, VK_IMAGE_ASPECT_COLOR_BIT);
+  auto gBuffer = graph.createImage("gBuffer", imageInfo);
+  auto lighting = graph.createImage("lighting", imageInfo);
+  auto bloom = graph.createImage("bloom", imageInfo);
+  auto debug = graph.createImage("debug", imageInfo);
+
+  auto upload = graph.addPass("upload", nullptr).setSideEffect().getPassIndex();
+  auto geometry = graph.addPass("geometry", nullptr).write(gBuffer, colorWrite).getPassIndex();
+  auto shading = graph.addPass("shading", nullptr).read(gBuffer, shaderRead).write(lighting, colorWrite).getPassIndex();
+  auto debugView = graph.addPass("debugView", nullptr).read(gBuffer, shaderRead).write(debug, colorWrite).getPassIndex();
+  auto blur = graph.addPass("blur", nullptr).read(lighting, shaderRead).write(bloom, colorWrite).getPassIndex();
+  auto composite = graph.addPass("composite", nullptr).read(bloom, shaderRead)
+    .write(backBuffer, colorWrite, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR).getPassIndex();
+
+  graph.compile();
+
+  // Nothing reads the debug view, the side effect pass stays without any use
+  assert(!graph.isCulled(upload) && !graph.isCulled(geometry) && !graph.isCulled(shading) && "a needed pass is culled");
+  assert(!graph.isCulled(blur) && !graph.isCulled(composite) && "a needed pass is culled");
+  assert(graph.isCulled(debugView) && "the unread pass is not culled");
+  assert(graph.getBarriers(upload).empty() && graph.getBarriers(debugView).empty() && "passes without synchronization got barriers");
+
+  // gBuffer is dead once shading read it, bloom takes its memory. lighting overlaps both.
+  assert(graph.getAliasSlotCount() == 2 && "wrong alias slot count");
+  assert(graph.getAliasSlot(gBuffer) == graph.getAliasSlot(bloom) && "bloom does not alias gBuffer");
+  assert(graph.getAliasSlot(lighting) != graph.getAliasSlot(gBuffer) && "lighting aliases a live image");
+  assert(graph.getAliasSlot(debug) == EngineRenderGraph::noAliasSlot && "the culled image got memory");
+  assert(graph.getAliasSlot(backBuffer) == EngineRenderGraph::noAliasSlot && "the imported image got an alias slot");
+
+  // gBuffer follows the last read of bloom in the previous frame, its old content is discarded
+  assert(graph.getBarriers(geometry).size() == 1 && "wrong geometry barrier count");
+  checkBarrier(graph, geometry, gBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 
+    0, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+
+  assert(graph.getBarriers(shading).size() == 2 && "wrong shading barrier count");
+  checkBarrier(graph, shading, gBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 
+    VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+  checkBarrier(graph, shading, lighting, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 
+    0, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+
+  // bloom waits for the read of gBuffer, the previous user of its memory
+  assert(graph.getBarriers(blur).size() == 2 && "wrong blur barrier count");
+  checkBarrier(graph, blur, lighting, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 
+    VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+  checkBarrier(graph, blur, bloom, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 
+    0, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+
+  // Nothing to wait for on the imported image, only its transition
+  assert(graph.getBarriers(composite).size() == 2 && "wrong composite barrier count");
+  checkBarrier(graph, composite, bloom, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 
+    VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+  checkBarrier(graph, composite, backBuffer, 0, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 
+    0, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+
+  assert(graph.getFinalAccess(backBuffer).layout == VK_IMAGE_LAYOUT_PRESENT_SRC_KHR && "the back buffer is not left ready to present");
+
+  // A read-modify-write at one stage followed by a read at the same stage, the read still waits for the write
+  EngineRenderGraph computeGraph;
+
+  const RenderGraphAccess computeReadWrite{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT };
+  const RenderGraphAccess computeRead{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT };
+
+  auto particles = computeGraph.createBuffer("particles", RenderGraphBufferInfo{ 1024, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT });
+
+  auto simulate = computeGraph.addPass("simulate", nullptr).write(particles, computeReadWrite).getPassIndex();
+  auto draw = computeGraph.addPass("draw", nullptr).read(particles, computeRead).setSideEffect().getPassIndex();
+
+  computeGraph.compile();
+
+  // The previous frame's read only needs the execution dependency
+  assert(computeGraph.getBarriers(simulate).size() == 1 && "wrong simulate barrier count");
+  checkBarrier(computeGraph, simulate, particles, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 
+    0, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_UNDEFINED);
+
+  assert(computeGraph.getBarriers(draw).size() == 1 && "the read after write at one stage got no barrier");
+  checkBarrier(computeGraph, draw, particles, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 
+    VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_UNDEFINED);
+
+  std::cout << "render graph: " << graph.getPassCount() << " passes, " << graph.getAliasSlotCount() << " alias slots, all checks passed" << std::endl;
+  return 0;
+}